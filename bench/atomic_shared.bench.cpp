@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "util/atomic_shared.hpp"
+
+namespace {
+
+struct config {
+    int verbosity = 1;
+};
+
+// the baseline, a mutex around a util::shared instance
+class locked_shared {
+public:
+    explicit locked_shared(util::shared<config, util::atomic_count> initial)
+        : current(std::move(initial)) {}
+
+    auto load() const -> util::shared<config, util::atomic_count> {
+        const std::lock_guard<std::mutex> lock(mutex);
+        return current;
+    }
+
+private:
+    mutable std::mutex mutex;
+    util::shared<config, util::atomic_count> current;
+};
+
+// every thread loads the current config and reads from it, as request handlers would
+template <class Published>
+void load_config(benchmark::State& state, const Published& published) {
+    for (auto _ : state) {
+        const auto loaded = published.load();
+        benchmark::DoNotOptimize(loaded->verbosity);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void atomic_shared_load(benchmark::State& state) {
+    static const util::atomic_shared<config> published(
+        util::make_shared<config, util::atomic_count>());
+    load_config(state, published);
+}
+
+void mutex_shared_load(benchmark::State& state) {
+    static const locked_shared published(util::make_shared<config, util::atomic_count>());
+    load_config(state, published);
+}
+
+// std::atomic_load of a std::shared_ptr, which libstdc++ implements with a pool of mutexes
+void std_atomic_load(benchmark::State& state) {
+    static const auto published = std::make_shared<config>();
+    for (auto _ : state) {
+        const auto loaded = std::atomic_load(&published);
+        benchmark::DoNotOptimize(loaded->verbosity);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto hardware_threads() -> int {
+    return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+}  // namespace
+
+BENCHMARK(atomic_shared_load)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(mutex_shared_load)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(std_atomic_load)->ThreadRange(1, hardware_threads())->UseRealTime();
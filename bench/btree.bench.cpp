@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/btree.hpp"
+#include "util/sorted.hpp"
+
+namespace {
+
+constexpr std::size_t query_count = 1U << 12U;
+
+auto make_keys(std::size_t count, std::uint32_t seed = 42) -> std::vector<std::uint32_t> {
+    std::mt19937 gen(seed);
+    std::vector<std::uint32_t> keys(count);
+    std::generate(keys.begin(), keys.end(), gen);
+    return keys;
+}
+
+template <class Sorted>
+auto make_sorted(std::size_t count) -> Sorted {
+    auto keys = make_keys(count);
+    std::sort(keys.begin(), keys.end());
+    return Sorted(util::presorted, keys.begin(), keys.end());
+}
+
+// inserts random keys into an empty container, the vector moves half of its elements per insert
+template <class Sorted>
+void insert(benchmark::State& state) {
+    const auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        Sorted sorted;
+        for (const auto key : keys) {
+            sorted.insert(key);
+        }
+        benchmark::DoNotOptimize(sorted.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <class Sorted>
+void contains(benchmark::State& state) {
+    const auto sorted = make_sorted<Sorted>(static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys(query_count, 7);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted.contains(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class Sorted>
+void iterate(benchmark::State& state) {
+    const auto sorted = make_sorted<Sorted>(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (const auto key : sorted) {
+            sum += key;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <class Sorted>
+void bulk_load(benchmark::State& state) {
+    auto keys = make_keys(static_cast<std::size_t>(state.range(0)));
+    std::sort(keys.begin(), keys.end());
+
+    for (auto _ : state) {
+        const Sorted sorted(util::presorted, keys.begin(), keys.end());
+        benchmark::DoNotOptimize(sorted.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using sorted_btree = util::sorted_btree<std::uint32_t>;
+using sorted_list = util::sorted_list<std::uint32_t>;
+using sorted_vector = util::sorted_vector<std::uint32_t>;
+
+}  // namespace
+
+// inserting into the vector is quadratic and only measured up to 256K elements for comparison
+BENCHMARK_TEMPLATE(insert, sorted_btree)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+BENCHMARK_TEMPLATE(insert, sorted_list)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
+BENCHMARK_TEMPLATE(insert, sorted_vector)->RangeMultiplier(8)->Range(1 << 12, 1 << 18);
+BENCHMARK_TEMPLATE(contains, sorted_btree)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(contains, sorted_list)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(contains, sorted_vector)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(iterate, sorted_btree)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(iterate, sorted_list)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(iterate, sorted_vector)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(bulk_load, sorted_btree)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(bulk_load, sorted_list)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
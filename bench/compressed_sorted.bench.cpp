@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/compressed_sorted.hpp"
+
+namespace {
+
+constexpr std::size_t query_count = 1U << 16U;
+
+// dense ids: about one of four consecutive integers is contained
+auto make_ids(std::size_t count) -> std::vector<std::uint64_t> {
+    std::mt19937_64 gen(42);  // NOLINT
+    std::vector<std::uint64_t> ids(count);
+    std::generate(ids.begin(), ids.end(), [&] { return gen() % (count * 4); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+auto make_queries(std::size_t count) -> std::vector<std::uint64_t> {
+    std::mt19937_64 gen(7);  // NOLINT
+    std::vector<std::uint64_t> queries(query_count);
+    std::generate(queries.begin(), queries.end(), [&] { return gen() % (count * 4); });
+    return queries;
+}
+
+void compressed_sorted_contains(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const auto ids = make_ids(count);
+    const util::compressed_sorted<std::uint64_t> compressed(util::presorted, ids.begin(),
+                                                            ids.end());
+    const auto queries = make_queries(count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compressed.contains(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes_per_id"] =
+        static_cast<double>(compressed.memory_usage()) / static_cast<double>(count);
+}
+
+void sorted_vector_contains(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const util::sorted_vector<std::uint64_t> sorted(util::presorted, make_ids(count));
+    const auto queries = make_queries(count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted.contains(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes_per_id"] = static_cast<double>(sizeof(std::uint64_t));
+}
+
+void compressed_sorted_iterate(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const auto ids = make_ids(count);
+    const util::compressed_sorted<std::uint64_t> compressed(util::presorted, ids.begin(),
+                                                            ids.end());
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (const auto id : compressed) {
+            sum += id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+void compressed_sorted_decode(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const auto ids = make_ids(count);
+    const util::compressed_sorted<std::uint64_t> compressed(util::presorted, ids.begin(),
+                                                            ids.end());
+    std::vector<std::uint64_t> decoded(count);
+    for (auto _ : state) {
+        compressed.decode(decoded.data());
+        benchmark::DoNotOptimize(decoded.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+void sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->RangeMultiplier(16)->Range(1 << 12, 1 << 24);
+}
+
+}  // namespace
+
+BENCHMARK(compressed_sorted_contains)->Apply(sizes);
+BENCHMARK(sorted_vector_contains)->Apply(sizes);
+BENCHMARK(compressed_sorted_iterate)->Apply(sizes);
+BENCHMARK(compressed_sorted_decode)->Apply(sizes);
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/concurrent_sorted.hpp"
+
+namespace {
+
+constexpr std::size_t key_count = 1U << 16U;
+constexpr std::size_t lookups_per_reader = 1U << 18U;
+constexpr auto write_interval = std::chrono::milliseconds(1);
+
+auto make_keys(std::size_t count, std::uint32_t seed) -> std::vector<std::uint32_t> {
+    std::mt19937 gen(seed);
+    std::vector<std::uint32_t> keys(count);
+    std::generate(keys.begin(), keys.end(), gen);
+    return keys;
+}
+
+auto make_sorted() -> util::sorted_vector<std::uint32_t> {
+    auto keys = make_keys(key_count, 42);  // NOLINT
+    std::sort(keys.begin(), keys.end());
+    return util::sorted_vector<std::uint32_t>(util::presorted, std::move(keys));
+}
+
+// a rwlock-protected sorted vector as the baseline
+class locked_sorted {
+public:
+    explicit locked_sorted(util::sorted_vector<std::uint32_t> initial)
+        : elements(std::move(initial)) {}
+
+    auto contains(std::uint32_t value) const -> bool {
+        const std::shared_lock<std::shared_mutex> lock(mutex);
+        return elements.contains(value);
+    }
+
+    void insert(std::uint32_t value) {
+        const std::unique_lock<std::shared_mutex> lock(mutex);
+        elements.insert(value);
+    }
+
+private:
+    mutable std::shared_mutex mutex;
+    util::sorted_vector<std::uint32_t> elements;
+};
+
+/**
+ * Runs the given number of reader threads doing lookups while one writer thread inserts a value
+ * every write_interval.
+ */
+template <class Index>
+void readers_with_writer(benchmark::State& state, Index& index) {
+    const auto reader_count = static_cast<std::size_t>(state.range(0));
+    const auto queries = make_keys(lookups_per_reader, 7);  // NOLINT
+
+    for (auto _ : state) {
+        std::atomic<bool> done{false};
+        std::thread writer([&] {
+            std::mt19937 gen(3);  // NOLINT
+            while (!done) {
+                index.insert(static_cast<std::uint32_t>(gen()));
+                std::this_thread::sleep_for(write_interval);
+            }
+        });
+
+        std::vector<std::thread> readers;
+        for (std::size_t r = 0; r < reader_count; ++r) {
+            readers.emplace_back([&] {
+                std::size_t found = 0;
+                for (const auto query : queries) {
+                    found += index.contains(query) ? 1 : 0;
+                }
+                benchmark::DoNotOptimize(found);
+            });
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        done = true;
+        writer.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(reader_count * lookups_per_reader));
+}
+
+void concurrent_sorted(benchmark::State& state) {
+    util::concurrent_sorted_vector<std::uint32_t> index(make_sorted());
+    readers_with_writer(state, index);
+}
+
+void shared_mutex_sorted(benchmark::State& state) {
+    locked_sorted index(make_sorted());
+    readers_with_writer(state, index);
+}
+
+void reader_counts(benchmark::internal::Benchmark* benchmark) {
+    const auto hardware = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+    for (int readers = 1; readers < hardware; readers *= 2) {
+        benchmark->Arg(readers);
+    }
+    benchmark->Arg(hardware);
+    benchmark->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK(concurrent_sorted)->Apply(reader_counts);
+BENCHMARK(shared_mutex_sorted)->Apply(reader_counts);
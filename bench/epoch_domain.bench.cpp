@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "util/epoch_domain.hpp"
+#include "util/hazard_pointer.hpp"
+
+namespace {
+
+struct config {
+    std::uint64_t value = 42;  // NOLINT
+};
+
+auto current() -> std::atomic<config*>& {
+    static std::atomic<config*> loaded{new config()};
+    return loaded;
+}
+
+// the cost of the read alone, without any protection from concurrent writers
+void unprotected_read(benchmark::State& state) {
+    auto& source = current();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(source.load()->value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void epoch_read_lock(benchmark::State& state) {
+    auto& source = current();
+    for (auto _ : state) {
+        const util::epoch_domain::read_lock lock;
+        benchmark::DoNotOptimize(source.load()->value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void hazard_pointer_protect(benchmark::State& state) {
+    auto& source = current();
+    for (auto _ : state) {
+        util::hazard_pointer hazard;
+        benchmark::DoNotOptimize(hazard.protect(source)->value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void shared_mutex_lock(benchmark::State& state) {
+    static std::shared_mutex mutex;
+    auto& source = current();
+    for (auto _ : state) {
+        const std::shared_lock<std::shared_mutex> lock(mutex);
+        benchmark::DoNotOptimize(source.load()->value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// one read lock for a batch of reads, as in a traversal of a larger structure
+void epoch_read_lock_batch(benchmark::State& state) {
+    auto& source = current();
+    for (auto _ : state) {
+        const util::epoch_domain::read_lock lock;
+        for (int i = 0; i < 64; ++i) {  // NOLINT
+            benchmark::DoNotOptimize(source.load()->value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 64);  // NOLINT
+}
+
+auto hardware_threads() -> int {
+    return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+}  // namespace
+
+BENCHMARK(unprotected_read)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(epoch_read_lock)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(hazard_pointer_protect)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(shared_mutex_lock)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(epoch_read_lock_batch)->ThreadRange(1, hardware_threads())->UseRealTime();
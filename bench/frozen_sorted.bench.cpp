@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/frozen_sorted.hpp"
+
+namespace {
+
+constexpr std::size_t query_count = 1U << 16U;
+
+auto make_keys(std::size_t count) -> std::vector<std::uint32_t> {
+    std::mt19937 gen(42);  // NOLINT
+    std::vector<std::uint32_t> keys(count);
+    std::generate(keys.begin(), keys.end(), gen);
+    return keys;
+}
+
+auto make_sorted(std::size_t count) -> util::sorted_vector<std::uint32_t> {
+    auto keys = make_keys(count);
+    std::sort(keys.begin(), keys.end());
+    return util::sorted_vector<std::uint32_t>(util::presorted, std::move(keys));
+}
+
+void frozen_sorted_lower_bound(benchmark::State& state) {
+    const auto sorted = make_sorted(static_cast<std::size_t>(state.range(0)));
+    const auto frozen = util::freeze(sorted);
+    const auto queries = make_keys(query_count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(frozen.lower_bound(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void sorted_vector_std_lower_bound(benchmark::State& state) {
+    const auto sorted = make_sorted(static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys(query_count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            std::lower_bound(sorted.begin(), sorted.end(), queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+// 1K up to 64M keys (256 MiB), i.e. well beyond the size of common last level caches
+BENCHMARK(frozen_sorted_lower_bound)->RangeMultiplier(8)->Range(1 << 10, 1 << 26);
+BENCHMARK(sorted_vector_std_lower_bound)->RangeMultiplier(8)->Range(1 << 10, 1 << 26);
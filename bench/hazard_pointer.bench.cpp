@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "util/hazard_pointer.hpp"
+#include "util/shared.hpp"
+
+namespace {
+
+constexpr int list_length = 1000;
+
+struct hazard_node {
+    std::uint64_t value = 0;
+    std::atomic<hazard_node*> next{nullptr};
+};
+
+struct shared_node {
+    std::uint64_t value = 0;
+    util::shared<shared_node, util::atomic_count> next;
+};
+
+auto make_hazard_list() -> std::atomic<hazard_node*>& {
+    static std::atomic<hazard_node*> head{nullptr};
+    for (int i = 0; i < list_length; ++i) {
+        auto* node = new hazard_node();
+        node->value = static_cast<std::uint64_t>(i);
+        node->next = head.load();
+        head = node;
+    }
+    return head;
+}
+
+auto make_shared_list() -> util::shared<shared_node, util::atomic_count> {
+    util::shared<shared_node, util::atomic_count> head;
+    for (int i = 0; i < list_length; ++i) {
+        auto node = util::make_shared<shared_node, util::atomic_count>();
+        node->value = static_cast<std::uint64_t>(i);
+        node->next = std::move(head);
+        head = std::move(node);
+    }
+    return head;
+}
+
+// traverses the list hand-over-hand, protecting every node with one hazard pointer of two
+void hazard_pointer_traverse(benchmark::State& state) {
+    static auto& head = make_hazard_list();
+    for (auto _ : state) {
+        util::hazard_pointer current;
+        util::hazard_pointer next;
+        std::uint64_t sum = 0;
+        for (auto* node = current.protect(head); node;) {
+            sum += node->value;
+            auto* following = next.protect(node->next);
+            current.swap(next);
+            node = following;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * list_length);
+}
+
+// traverses the list holding a reference to every node, i.e. two atomic operations per node
+void atomic_refcount_traverse(benchmark::State& state) {
+    static const auto head = make_shared_list();
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (auto node = head; node; node = node->next) {
+            sum += node->value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * list_length);
+}
+
+auto hardware_threads() -> int {
+    return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+}  // namespace
+
+BENCHMARK(hazard_pointer_traverse)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(atomic_refcount_traverse)->ThreadRange(1, hardware_threads())->UseRealTime();
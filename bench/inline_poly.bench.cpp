@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/inline_poly.hpp"
+#include "util/scoped.hpp"
+
+namespace {
+
+struct handler {
+    handler() = default;
+    handler(const handler&) = default;
+    handler(handler&&) = default;
+    auto operator=(const handler&) -> handler& = default;
+    auto operator=(handler&&) -> handler& = default;
+    virtual ~handler() = default;
+
+    virtual auto handle(int event) -> int = 0;
+};
+
+struct add : handler {
+    explicit add(int amount) : amount(amount) {}
+
+    auto handle(int event) -> int override { return event + amount; }
+
+    int amount;
+};
+
+struct multiply : handler {
+    explicit multiply(int factor) : factor(factor) {}
+
+    auto handle(int event) -> int override { return event * factor; }
+
+    int factor;
+};
+
+using inline_handler = util::inline_poly<handler, 16>;
+
+template <class Holder, class Derived>
+auto make(int value) -> Holder {
+    if constexpr (std::is_same<Holder, inline_handler>::value) {
+        return Holder(std::in_place_type<Derived>, value);
+    } else {
+        return Holder(new Derived(value));
+    }
+}
+
+// creates and destroys a handler, one allocation with scoped and none inline
+template <class Holder>
+void construct_destroy(benchmark::State& state) {
+    for (auto _ : state) {
+        auto object = make<Holder, add>(1);
+        benchmark::DoNotOptimize(object);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// calls a vector of handlers of alternating types, the objects of scoped are scattered on the heap
+template <class Holder>
+void virtual_call(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    std::vector<Holder> handlers;
+    handlers.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        // interleaved allocations keep the handlers of scoped apart like in a long running program
+        std::vector<char> gap(64);
+        benchmark::DoNotOptimize(gap.data());
+        handlers.push_back(i % 2 == 0 ? make<Holder, add>(1) : make<Holder, multiply>(3));
+    }
+
+    int event = 0;
+    for (auto _ : state) {
+        for (auto& h : handlers) {
+            event = h->handle(event) & 0xffff;
+        }
+        benchmark::DoNotOptimize(event);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void scoped_construct_destroy(benchmark::State& state) {
+    construct_destroy<util::scoped<handler>>(state);
+}
+
+void inline_poly_construct_destroy(benchmark::State& state) {
+    construct_destroy<inline_handler>(state);
+}
+
+void scoped_virtual_call(benchmark::State& state) {
+    virtual_call<util::scoped<handler>>(state);
+}
+
+void inline_poly_virtual_call(benchmark::State& state) {
+    virtual_call<inline_handler>(state);
+}
+
+}  // namespace
+
+BENCHMARK(scoped_construct_destroy);
+BENCHMARK(inline_poly_construct_destroy);
+BENCHMARK(scoped_virtual_call)->Range(64, 1 << 18);
+BENCHMARK(inline_poly_virtual_call)->Range(64, 1 << 18);
@@ -0,0 +1,85 @@
+#include <cstdint>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "util/intrusive.hpp"
+#include "util/shared.hpp"
+
+namespace {
+
+template <class Count>
+struct intrusive_node : util::intrusive_base<intrusive_node<Count>, Count> {
+    std::uint64_t value = 0;
+    util::intrusive<intrusive_node> left;
+    util::intrusive<intrusive_node> right;
+};
+
+template <class Count>
+struct shared_node {
+    std::uint64_t value = 0;
+    util::shared<shared_node, Count> left;
+    util::shared<shared_node, Count> right;
+};
+
+struct std_node {
+    std::uint64_t value = 0;
+    std::shared_ptr<std_node> left;
+    std::shared_ptr<std_node> right;
+};
+
+template <class Handle>
+auto make_tree(int depth, std::uint64_t& next, Handle (*make)()) -> Handle {
+    auto node = make();
+    node->value = next++;
+    if (depth > 1) {
+        node->left = make_tree(depth - 1, next, make);
+        node->right = make_tree(depth - 1, next, make);
+    }
+    return node;
+}
+
+// the traversal takes handles by value like code holding on to nodes while visiting them would
+template <class Handle>
+auto sum(Handle node) -> std::uint64_t {
+    if (!node) {
+        return 0;
+    }
+    return node->value + sum(node->left) + sum(node->right);
+}
+
+template <class Handle>
+void traverse(benchmark::State& state, Handle (*make)()) {
+    std::uint64_t next = 0;
+    const auto root = make_tree(static_cast<int>(state.range(0)), next, make);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sum(root));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(next));
+}
+
+template <class Count>
+void intrusive_traverse(benchmark::State& state) {
+    traverse(state, +[] { return util::make_intrusive<intrusive_node<Count>>(); });
+}
+
+template <class Count>
+void shared_traverse(benchmark::State& state) {
+    traverse(state, +[] { return util::make_shared<shared_node<Count>, Count>(); });
+}
+
+void std_shared_ptr_traverse(benchmark::State& state) {
+    traverse(state, +[] { return std::make_shared<std_node>(); });
+}
+
+using util::atomic_count;
+using util::local_count;
+
+}  // namespace
+
+// trees of 1K up to 1M nodes, the large ones do not fit into caches
+BENCHMARK_TEMPLATE(intrusive_traverse, local_count)->DenseRange(10, 20, 5);
+BENCHMARK_TEMPLATE(intrusive_traverse, atomic_count)->DenseRange(10, 20, 5);
+BENCHMARK_TEMPLATE(shared_traverse, local_count)->DenseRange(10, 20, 5);
+BENCHMARK_TEMPLATE(shared_traverse, atomic_count)->DenseRange(10, 20, 5);
+BENCHMARK(std_shared_ptr_traverse)->DenseRange(10, 20, 5);
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/frozen_sorted.hpp"
+#include "util/learned_sorted.hpp"
+
+namespace {
+
+constexpr std::size_t query_count = 1U << 16U;
+
+enum class distribution { uniform, skewed };
+
+// skewed keys are lognormal, dense at the low end with a long sparse tail
+auto make_keys(distribution shape, std::size_t count, std::uint32_t seed)
+    -> std::vector<std::uint64_t> {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<std::uint64_t> uniform(0, std::uint64_t{1} << 40U);
+    std::lognormal_distribution<double> lognormal(0.0, 2.0);
+    std::vector<std::uint64_t> keys(count);
+    for (auto& key : keys) {
+        key = shape == distribution::uniform ? uniform(gen)
+                                             : static_cast<std::uint64_t>(lognormal(gen) * 1e9);
+    }
+    return keys;
+}
+
+auto make_sorted(distribution shape, std::size_t count) -> util::sorted_vector<std::uint64_t> {
+    auto keys = make_keys(shape, count, 42);
+    std::sort(keys.begin(), keys.end());
+    return util::sorted_vector<std::uint64_t>(util::presorted, std::move(keys));
+}
+
+template <distribution Shape>
+void learned_sorted_lower_bound(benchmark::State& state) {
+    const auto learned = util::learn(make_sorted(Shape, static_cast<std::size_t>(state.range(0))));
+    const auto queries = make_keys(Shape, query_count, 7);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(learned.lower_bound(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["segments"] = static_cast<double>(learned.segment_count());
+}
+
+template <distribution Shape>
+void interpolation_lower_bound(benchmark::State& state) {
+    const auto sorted = make_sorted(Shape, static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys(Shape, query_count, 7);
+    const auto* const first = &*sorted.begin();
+    const auto* const last = first + sorted.size();
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            util::interpolation_lower_bound(first, last, queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <distribution Shape>
+void frozen_sorted_lower_bound(benchmark::State& state) {
+    const auto frozen = util::freeze(make_sorted(Shape, static_cast<std::size_t>(state.range(0))));
+    const auto queries = make_keys(Shape, query_count, 7);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(frozen.lower_bound(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <distribution Shape>
+void sorted_vector_lower_bound(benchmark::State& state) {
+    const auto sorted = make_sorted(Shape, static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys(Shape, query_count, 7);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted.lower_bound(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+constexpr auto uniform = distribution::uniform;
+constexpr auto skewed = distribution::skewed;
+
+}  // namespace
+
+// 4K up to 16M keys (128 MiB), i.e. well beyond the size of common last level caches
+BENCHMARK_TEMPLATE(learned_sorted_lower_bound, uniform)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(learned_sorted_lower_bound, skewed)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(interpolation_lower_bound, uniform)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(interpolation_lower_bound, skewed)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(frozen_sorted_lower_bound, uniform)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(frozen_sorted_lower_bound, skewed)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(sorted_vector_lower_bound, uniform)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(sorted_vector_lower_bound, skewed)->RangeMultiplier(8)->Range(1 << 12, 1 << 24);
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/merge.hpp"
+
+namespace {
+
+constexpr std::size_t total_count = 1U << 20U;
+
+auto make_runs(std::size_t run_count) -> std::vector<util::sorted_vector<std::uint64_t>> {
+    std::mt19937_64 gen(42);  // NOLINT
+    std::vector<util::sorted_vector<std::uint64_t>> runs;
+    for (std::size_t i = 0; i < run_count; ++i) {
+        std::vector<std::uint64_t> run(total_count / run_count);
+        std::generate(run.begin(), run.end(), gen);
+        std::sort(run.begin(), run.end());
+        runs.emplace_back(util::presorted, std::move(run));
+    }
+    return runs;
+}
+
+void merge(benchmark::State& state) {
+    const auto runs = make_runs(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(util::merge(runs));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(total_count));
+}
+
+void pairwise_merge(benchmark::State& state) {
+    const auto runs = make_runs(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::vector<std::uint64_t> merged;
+        std::vector<std::uint64_t> next;
+        for (const auto& run : runs) {
+            next.clear();
+            std::merge(merged.begin(), merged.end(), run.begin(), run.end(),
+                       std::back_inserter(next));
+            merged.swap(next);
+        }
+        benchmark::DoNotOptimize(merged);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(total_count));
+}
+
+void concatenate_and_sort(benchmark::State& state) {
+    const auto runs = make_runs(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::vector<std::uint64_t> merged;
+        for (const auto& run : runs) {
+            merged.insert(merged.end(), run.begin(), run.end());
+        }
+        std::sort(merged.begin(), merged.end());
+        benchmark::DoNotOptimize(merged);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(total_count));
+}
+
+void run_counts(benchmark::internal::Benchmark* benchmark) {
+    benchmark->RangeMultiplier(4)->Range(2, 128);
+}
+
+}  // namespace
+
+BENCHMARK(merge)->Apply(run_counts);
+BENCHMARK(pairwise_merge)->Apply(run_counts);
+BENCHMARK(concatenate_and_sort)->Apply(run_counts);
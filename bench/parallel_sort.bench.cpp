@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/parallel_sort.hpp"
+#include "util/sorted.hpp"
+
+namespace {
+
+constexpr std::size_t count = 1U << 24U;
+
+auto random_keys() -> const std::vector<std::uint64_t>& {
+    static const std::vector<std::uint64_t> keys = [] {
+        std::mt19937_64 gen(42);  // NOLINT
+        std::vector<std::uint64_t> keys(count);
+        std::generate(keys.begin(), keys.end(), gen);
+        return keys;
+    }();
+    return keys;
+}
+
+void std_sort(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto keys = random_keys();
+        state.ResumeTiming();
+        std::sort(keys.begin(), keys.end());
+        benchmark::DoNotOptimize(keys.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+void parallel_sort(benchmark::State& state) {
+    util::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto keys = random_keys();
+        state.ResumeTiming();
+        util::parallel_sort(util::parallel_t(pool), keys.begin(), keys.end());
+        benchmark::DoNotOptimize(keys.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+void make_sorted(benchmark::State& state) {
+    const auto& keys = random_keys();
+    const util::parallel_t policy(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        const auto sorted = util::make_sorted<util::sorted_vector<std::uint64_t>>(policy, keys);
+        benchmark::DoNotOptimize(sorted.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+void thread_counts(benchmark::internal::Benchmark* benchmark) {
+    const auto hardware = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+    for (int threads = 1; threads < hardware; threads *= 2) {
+        benchmark->Arg(threads);
+    }
+    benchmark->Arg(hardware);
+    benchmark->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK(std_sort)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(parallel_sort)->Apply(thread_counts);
+BENCHMARK(make_sorted)->Apply(thread_counts);
@@ -0,0 +1,74 @@
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/pool_allocator.hpp"
+
+namespace {
+
+struct message {
+    std::uint64_t id = 0;
+    std::array<char, 48> payload{};
+};
+
+constexpr std::size_t batch_size = 1024;
+
+// keeps a batch of messages alive before releasing it, like a queue of in-flight messages would
+template <class Make>
+void churn(benchmark::State& state, Make make) {
+    std::vector<decltype(make())> batch;
+    batch.reserve(batch_size);
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            batch.push_back(make());
+        }
+        batch.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch_size));
+}
+
+void make_pooled_shared(benchmark::State& state) {
+    churn(state, [] { return util::make_pooled_shared<message>(); });
+}
+
+void make_shared(benchmark::State& state) {
+    churn(state, [] { return util::make_shared<message>(); });
+}
+
+void std_make_shared(benchmark::State& state) {
+    churn(state, [] { return std::make_shared<message>(); });
+}
+
+// one thread creates the messages and another one releases them
+template <class Make>
+void handoff(benchmark::State& state, Make make) {
+    for (auto _ : state) {
+        std::vector<decltype(make())> batch;
+        batch.reserve(batch_size);
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            batch.push_back(make());
+        }
+        std::thread([released = std::move(batch)]() mutable { released.clear(); }).join();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch_size));
+}
+
+void make_pooled_shared_handoff(benchmark::State& state) {
+    handoff(state, [] { return util::make_pooled_shared<message, util::atomic_count>(); });
+}
+
+void make_shared_handoff(benchmark::State& state) {
+    handoff(state, [] { return util::make_shared<message, util::atomic_count>(); });
+}
+
+}  // namespace
+
+BENCHMARK(make_pooled_shared);
+BENCHMARK(make_shared);
+BENCHMARK(std_make_shared);
+BENCHMARK(make_pooled_shared_handoff)->UseRealTime();
+BENCHMARK(make_shared_handoff)->UseRealTime();
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/set_operations.hpp"
+
+namespace {
+
+constexpr std::size_t large_count = 1U << 20U;
+
+auto make_ids(std::size_t count, std::uint32_t seed) -> util::sorted_vector<std::uint32_t> {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<std::uint32_t> dist(0, 4 * large_count);
+    std::vector<std::uint32_t> ids(count);
+    std::generate(ids.begin(), ids.end(), [&] { return dist(gen); });
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return util::sorted_vector<std::uint32_t>(util::presorted, std::move(ids));
+}
+
+// the smaller input has large_count / range(0) elements, range(0) == 1 is a balanced input
+
+void set_intersection(benchmark::State& state) {
+    const auto lhs = make_ids(large_count / static_cast<std::size_t>(state.range(0)), 1);
+    const auto rhs = make_ids(large_count, 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(util::set_intersection(lhs, rhs));
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(lhs.size() + rhs.size()));
+}
+
+void std_set_intersection(benchmark::State& state) {
+    const auto lhs = make_ids(large_count / static_cast<std::size_t>(state.range(0)), 1);
+    const auto rhs = make_ids(large_count, 2);
+    for (auto _ : state) {
+        std::vector<std::uint32_t> result;
+        std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                              std::back_inserter(result));
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(lhs.size() + rhs.size()));
+}
+
+void set_union(benchmark::State& state) {
+    const auto lhs = make_ids(large_count / static_cast<std::size_t>(state.range(0)), 1);
+    const auto rhs = make_ids(large_count, 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(util::set_union(lhs, rhs));
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(lhs.size() + rhs.size()));
+}
+
+void std_set_union(benchmark::State& state) {
+    const auto lhs = make_ids(large_count / static_cast<std::size_t>(state.range(0)), 1);
+    const auto rhs = make_ids(large_count, 2);
+    for (auto _ : state) {
+        std::vector<std::uint32_t> result;
+        std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(lhs.size() + rhs.size()));
+}
+
+void set_difference(benchmark::State& state) {
+    const auto lhs = make_ids(large_count, 1);
+    const auto rhs = make_ids(large_count / static_cast<std::size_t>(state.range(0)), 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(util::set_difference(lhs, rhs));
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(lhs.size() + rhs.size()));
+}
+
+void std_set_difference(benchmark::State& state) {
+    const auto lhs = make_ids(large_count, 1);
+    const auto rhs = make_ids(large_count / static_cast<std::size_t>(state.range(0)), 2);
+    for (auto _ : state) {
+        std::vector<std::uint32_t> result;
+        std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                            std::back_inserter(result));
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(lhs.size() + rhs.size()));
+}
+
+void skews(benchmark::internal::Benchmark* benchmark) {
+    benchmark->Arg(1)->Arg(4)->Arg(64)->Arg(1024);
+}
+
+}  // namespace
+
+BENCHMARK(set_intersection)->Apply(skews);
+BENCHMARK(std_set_intersection)->Apply(skews);
+BENCHMARK(set_union)->Apply(skews);
+BENCHMARK(std_set_union)->Apply(skews);
+BENCHMARK(set_difference)->Apply(skews);
+BENCHMARK(std_set_difference)->Apply(skews);
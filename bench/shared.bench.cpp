@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "util/shared.hpp"
+
+namespace {
+
+struct message {
+    int payload = 0;
+};
+
+// all threads copy and destroy handles to the same object, i.e. they contend for its counter
+template <class Pointer>
+void copy_destroy(benchmark::State& state, const Pointer& object) {
+    for (auto _ : state) {
+        Pointer copy = object;
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void shared_local_count(benchmark::State& state) {
+    static const auto object = util::make_shared<message>();
+    copy_destroy(state, object);
+}
+
+void shared_atomic_count(benchmark::State& state) {
+    static const auto object = util::make_shared<message, util::atomic_count>();
+    copy_destroy(state, object);
+}
+
+// the thread of the first run owns the object, threads of later runs count atomically
+void shared_biased_count(benchmark::State& state) {
+    static const auto object = util::make_shared<message, util::biased_count>();
+    copy_destroy(state, object);
+}
+
+void std_shared_ptr(benchmark::State& state) {
+    static const auto object = std::make_shared<message>();
+    copy_destroy(state, object);
+}
+
+// creates and destroys an object with its counter, one allocation with make_shared and two without
+void make_shared_destroy(benchmark::State& state) {
+    for (auto _ : state) {
+        auto object = util::make_shared<message>();
+        benchmark::DoNotOptimize(object);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void biased_make_shared_destroy(benchmark::State& state) {
+    for (auto _ : state) {
+        auto object = util::make_shared<message, util::biased_count>();
+        benchmark::DoNotOptimize(object);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void shared_new_destroy(benchmark::State& state) {
+    for (auto _ : state) {
+        util::shared<message> object(new message());
+        benchmark::DoNotOptimize(object);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void std_make_shared_destroy(benchmark::State& state) {
+    for (auto _ : state) {
+        auto object = std::make_shared<message>();
+        benchmark::DoNotOptimize(object);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+auto hardware_threads() -> int {
+    return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+}  // namespace
+
+// the local count is not thread-safe and only measured on one thread as the lower bound
+BENCHMARK(shared_local_count);
+BENCHMARK(shared_atomic_count)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(shared_biased_count)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(std_shared_ptr)->ThreadRange(1, hardware_threads())->UseRealTime();
+BENCHMARK(make_shared_destroy);
+BENCHMARK(biased_make_shared_destroy);
+BENCHMARK(shared_new_destroy);
+BENCHMARK(std_make_shared_destroy);
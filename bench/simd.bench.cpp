@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/sorted.hpp"
+
+namespace {
+
+constexpr std::size_t query_count = 1U << 16U;
+
+template <class T>
+auto make_keys(std::size_t count) -> std::vector<T> {
+    std::mt19937_64 gen(42);  // NOLINT
+    std::uniform_int_distribution<std::uint32_t> dist;
+    std::vector<T> keys(count);
+    std::generate(keys.begin(), keys.end(), [&] { return static_cast<T>(dist(gen)); });
+    return keys;
+}
+
+template <class T>
+auto make_sorted(std::size_t count) -> util::sorted_vector<T> {
+    auto keys = make_keys<T>(count);
+    std::sort(keys.begin(), keys.end());  // appending in order keeps the construction linear
+    return util::sorted_vector<T>(keys);
+}
+
+template <class T>
+void sorted_vector_lower_bound(benchmark::State& state) {
+    const auto sorted = make_sorted<T>(static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys<T>(query_count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted.lower_bound(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class T>
+void sorted_vector_std_lower_bound(benchmark::State& state) {
+    const auto sorted = make_sorted<T>(static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys<T>(query_count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            std::lower_bound(sorted.begin(), sorted.end(), queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->RangeMultiplier(16)->Range(64, 1 << 24);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(sorted_vector_lower_bound, std::uint32_t)->Apply(sizes);
+BENCHMARK_TEMPLATE(sorted_vector_std_lower_bound, std::uint32_t)->Apply(sizes);
+BENCHMARK_TEMPLATE(sorted_vector_lower_bound, std::uint64_t)->Apply(sizes);
+BENCHMARK_TEMPLATE(sorted_vector_std_lower_bound, std::uint64_t)->Apply(sizes);
+BENCHMARK_TEMPLATE(sorted_vector_lower_bound, float)->Apply(sizes);
+BENCHMARK_TEMPLATE(sorted_vector_std_lower_bound, float)->Apply(sizes);
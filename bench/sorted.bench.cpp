@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/btree.hpp"
+#include "util/sorted.hpp"
+
+namespace {
+
+constexpr std::size_t query_count = 1U << 12U;
+
+auto make_keys(std::size_t count) -> std::vector<std::uint32_t> {
+    std::mt19937 gen(42);  // NOLINT
+    std::vector<std::uint32_t> keys(count);
+    std::generate(keys.begin(), keys.end(), gen);
+    return keys;
+}
+
+template <class Sorted>
+auto make_sorted(std::size_t count) -> Sorted {
+    auto keys = make_keys(count);
+    std::sort(keys.begin(), keys.end());
+    return Sorted(util::presorted, keys.begin(), keys.end());
+}
+
+template <class Sorted>
+void rank(benchmark::State& state) {
+    const auto sorted = make_sorted<Sorted>(static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys(query_count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted.rank(queries[i++ % query_count]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class Sorted>
+void select(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto sorted = make_sorted<Sorted>(size);
+    const auto queries = make_keys(query_count);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sorted.select(queries[i++ % query_count] % size));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class Sorted>
+void count_range(benchmark::State& state) {
+    const auto sorted = make_sorted<Sorted>(static_cast<std::size_t>(state.range(0)));
+    const auto queries = make_keys(query_count + 1);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const auto low = std::min(queries[i % query_count], queries[i % query_count + 1]);
+        const auto high = std::max(queries[i % query_count], queries[i % query_count + 1]);
+        benchmark::DoNotOptimize(sorted.count_range(low, high));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+using sorted_vector = util::sorted_vector<std::uint32_t>;
+using sorted_btree = util::sorted_btree<std::uint32_t>;
+using sorted_list = util::sorted_list<std::uint32_t>;
+using sorted_std_list = util::sorted<std::list<std::uint32_t>>;
+
+}  // namespace
+
+// the std::list backed container is linear and only measured up to 64K elements for comparison
+BENCHMARK_TEMPLATE(rank, sorted_vector)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(rank, sorted_btree)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(rank, sorted_list)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(rank, sorted_std_list)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(select, sorted_vector)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(select, sorted_btree)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(select, sorted_list)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(select, sorted_std_list)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(count_range, sorted_vector)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(count_range, sorted_btree)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(count_range, sorted_list)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
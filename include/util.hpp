@@ -29,20 +29,42 @@
 #define THAT_THIS_UTIL_HEADER_FILE_IS_ALREADY_INCLUDED
 
 #include "util/assert.hpp"
+#include "util/atomic_shared.hpp"
+#include "util/btree.hpp"
 #include "util/buffer.hpp"
 #include "util/color.hpp"
+#include "util/compressed_sorted.hpp"
+#include "util/concurrent_sorted.hpp"
 #include "util/enumerate.hpp"
+#include "util/epoch_domain.hpp"
 #include "util/exception.hpp"
 #include "util/flags.hpp"
+#include "util/frozen_sorted.hpp"
+#include "util/hazard_pointer.hpp"
 #include "util/ignore_unused.hpp"
+#include "util/inline_poly.hpp"
+#include "util/intrusive.hpp"
+#include "util/learned_sorted.hpp"
+#if __has_include(<sys/mman.h>)
+#include "util/mapped_file.hpp"
+#include "util/mapped_sorted.hpp"
+#include "util/scoped_fd.hpp"
+#endif
+#include "util/merge.hpp"
 #include "util/multirator.hpp"
 #include "util/non_copyable.hpp"
 #include "util/non_moveable.hpp"
+#include "util/parallel_sort.hpp"
+#include "util/pool_allocator.hpp"
 #include "util/range.hpp"
 #include "util/ring_buffer.hpp"
 #include "util/scoped.hpp"
+#include "util/set_operations.hpp"
 #include "util/shared.hpp"
+#include "util/simd.hpp"
+#include "util/skip_list.hpp"
 #include "util/sorted.hpp"
+#include "util/thread_pool.hpp"
 #include "util/var.hpp"
 
 #endif  // THAT_THIS_UTIL_HEADER_FILE_IS_ALREADY_INCLUDED
\ No newline at end of file
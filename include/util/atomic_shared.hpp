@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_ATOMIC_SHARED_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_ATOMIC_SHARED_HEADER_IS_ALREADY_INCLUDED
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+#include "hazard_pointer.hpp"
+#include "shared.hpp"
+
+namespace util {
+
+/**
+ * A util::shared instance which can be loaded and replaced by several threads at the same time,
+ * e.g. for publishing configuration snapshots to all threads.
+ *
+ * The current instance lives in a separately allocated holder. Readers protect the holder they
+ * are about to copy with a util::hazard_pointer instead of taking a lock, so loads do not write to
+ * memory shared with other readers except for the reference counter of the loaded object. Writers
+ * swap the holder atomically and retire the old one to the global util::hazard_domain, which frees
+ * it once no reader copies from it anymore. Neither readers nor writers ever wait for each other.
+ * Thus the reference of a replaced instance is only released with the next batch of reclaimed
+ * objects, call util::hazard_domain::global().reclaim() to release it right away.
+ *
+ * @code{.cpp}
+ * util::atomic_shared<std::string> config;
+ * config.store(util::make_shared<std::string, util::atomic_count>("verbose"));
+ * const auto current = config.load();
+ * @endcode
+ *
+ * @tparam T the type of the managed object
+ * @tparam Count the reference counter of the managed util::shared instances, thread-safe like
+ * util::atomic_count or util::biased_count, never util::local_count
+ */
+template <class T, class Count = atomic_count>
+class atomic_shared {
+public:
+    using value_type = shared<T, Count>;
+
+    constexpr atomic_shared() noexcept = default;
+    atomic_shared(value_type desired);
+    atomic_shared(const atomic_shared&) = delete;
+    auto operator=(const atomic_shared&) -> atomic_shared& = delete;
+    ~atomic_shared();
+
+    auto load() const -> value_type;
+    void store(value_type desired);
+    auto exchange(value_type desired) -> value_type;
+    auto compare_exchange(value_type& expected, value_type desired) -> bool;
+
+private:
+    // loads hand out copies to several threads at once, which a local count cannot track
+    static_assert(!std::is_same<Count, local_count>::value,
+                  "util::atomic_shared needs a thread-safe count, not util::local_count");
+
+    static auto make_holder(value_type&& value) -> value_type*;
+    static auto equivalent(const value_type& lhs, const value_type& rhs) noexcept -> bool;
+
+    std::atomic<value_type*> holder{nullptr};
+};
+
+/**
+ * Constructs an atomic instance holding the given util::shared instance.
+ *
+ * @param desired the initial instance
+ */
+template <class T, class Count>
+atomic_shared<T, Count>::atomic_shared(value_type desired)
+    : holder(make_holder(std::move(desired))) {}
+
+/**
+ * Destroys the atomic instance and releases its util::shared instance. No other thread may access
+ * the atomic instance anymore.
+ */
+template <class T, class Count>
+atomic_shared<T, Count>::~atomic_shared() {
+    delete this->holder.load(std::memory_order_acquire);
+}
+
+/**
+ * Returns a copy of the current util::shared instance. The copy keeps the object alive even if
+ * other threads replace it afterwards.
+ *
+ * @return the current instance
+ */
+template <class T, class Count>
+auto atomic_shared<T, Count>::load() const -> value_type {
+    hazard_pointer hazard;
+    const auto* current = hazard.protect(this->holder);
+
+    return current ? *current : value_type();
+}
+
+/**
+ * Replaces the current util::shared instance.
+ *
+ * @param desired the new instance
+ */
+template <class T, class Count>
+void atomic_shared<T, Count>::store(value_type desired) {
+    this->exchange(std::move(desired));
+}
+
+/**
+ * Replaces the current util::shared instance and returns the previous one.
+ *
+ * @param desired the new instance
+ * @return the previous instance
+ */
+template <class T, class Count>
+auto atomic_shared<T, Count>::exchange(value_type desired) -> value_type {
+    auto* previous = this->holder.exchange(make_holder(std::move(desired)));
+    if (!previous) {
+        return value_type();
+    }
+
+    // readers may still copy from the previous holder, so it is copied as well and retired
+    auto result = *previous;
+    hazard_domain::global().retire(previous);
+
+    return result;
+}
+
+/**
+ * Replaces the current util::shared instance if it manages the same object as expected, otherwise
+ * loads the current instance into expected.
+ *
+ * @param expected the instance which is expected to be current, receives the current one on failure
+ * @param desired the new instance
+ * @return true if the instance was replaced or false if not
+ */
+template <class T, class Count>
+auto atomic_shared<T, Count>::compare_exchange(value_type& expected, value_type desired) -> bool {
+    auto* replacement = make_holder(std::move(desired));
+    hazard_pointer hazard;
+
+    while (true) {
+        auto* current = hazard.protect(this->holder);
+        if (!(current ? equivalent(*current, expected) : !expected)) {
+            expected = current ? *current : value_type();
+            delete replacement;
+            return false;
+        }
+
+        // still protected, so the holder cannot be freed and reallocated at the same address
+        if (this->holder.compare_exchange_strong(current, replacement)) {
+            hazard.reset_protection();
+            hazard_domain::global().retire(current);
+            return true;
+        }
+    }
+}
+
+/**
+ * Moves a non-empty util::shared instance into a new holder, empty instances are held as null.
+ */
+template <class T, class Count>
+auto atomic_shared<T, Count>::make_holder(value_type&& value) -> value_type* {
+    return value ? new value_type(std::move(value)) : nullptr;
+}
+
+/**
+ * Checks if two util::shared instances manage the same object with the same control block.
+ */
+template <class T, class Count>
+auto atomic_shared<T, Count>::equivalent(const value_type& lhs, const value_type& rhs) noexcept
+    -> bool {
+    return lhs.get() == rhs.get() && lhs.block == rhs.block;
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_ATOMIC_SHARED_HEADER_IS_ALREADY_INCLUDED
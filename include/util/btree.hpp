@@ -0,0 +1,1360 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_BTREE_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_BTREE_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sorted.hpp"
+
+#ifdef UTIL_ASSERT
+#include "assert.hpp"
+#endif
+
+namespace util {
+
+namespace detail {
+template <class T, class Compare, class Allocator>
+class btree_iterator;
+}  // namespace detail
+
+/**
+ * An in-memory B+tree keeping its elements sorted.
+ *
+ * All elements are stored in leaves of about 256 bytes, which are linked to iterate in both
+ * directions without touching the inner nodes. Inner nodes of about 512 bytes hold the separator
+ * keys and the number of elements below each child, so besides searching by value the tree can be
+ * searched by position. Insert, erase, find and access by position take O(log n) time with a high
+ * fanout, so a lookup touches only a few cache lines per level and far fewer nodes than a skip
+ * list. Sorted ranges are bulk loaded bottom-up in O(n).
+ *
+ * Equivalent elements are kept in insertion order. The elements are immutable, only const
+ * iterators are provided. Elements move between nodes when nodes split or merge, so insert and
+ * erase invalidate all iterators and references.
+ *
+ * @snippet test/btree.test.cpp btree_insert
+ * @tparam T the type of the stored elements, must be copy constructible and nothrow movable
+ * @tparam Compare A comparison function object which returns true if the first argument is less
+ * than (i.e. is ordered before) the second. The type must meet the requirements of Compare.
+ * @tparam Allocator the allocator used to acquire the memory of the nodes
+ */
+template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+class btree {
+    static_assert(std::is_nothrow_move_constructible<T>::value &&
+                      std::is_nothrow_move_assignable<T>::value,
+                  "elements move between nodes and must not throw while moving");
+
+    struct node;
+    struct leaf;
+    struct inner;
+
+public:
+    using value_type = T;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = detail::btree_iterator<T, Compare, Allocator>;
+    using const_iterator = iterator;
+
+    // a leaf fills about four cache lines, an inner node about eight
+    static constexpr size_type leaf_capacity =
+        std::max<size_type>(8, (256 - 4 * sizeof(void*)) / sizeof(T));
+    static constexpr size_type inner_capacity = std::max<size_type>(
+        4, (512 - 2 * sizeof(void*) + sizeof(T)) / (2 * sizeof(void*) + sizeof(T)));
+
+    btree() noexcept = default;
+    explicit btree(const Compare& comp, const Allocator& alloc = Allocator());
+    ~btree();
+    btree(const btree& other);
+    btree(btree&& other) noexcept;
+    auto operator=(const btree& other) -> btree&;
+    auto operator=(btree&& other) noexcept(
+        std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value) -> btree&;
+
+    // element access
+
+    auto at(size_type pos) const -> const_reference;
+    auto operator[](size_type pos) const -> const_reference;
+    auto front() const -> const_reference;
+    auto back() const -> const_reference;
+
+    // lookup
+
+    auto lower_bound(const_reference value) const -> const_iterator;
+    auto upper_bound(const_reference value) const -> const_iterator;
+    auto find(const_reference value) const -> const_iterator;
+    auto index_of(const_iterator pos) const -> size_type;
+    auto rank(const_reference value) const -> size_type;
+
+    // iterators
+
+    auto begin() const noexcept -> const_iterator;
+    auto cbegin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+    auto cend() const noexcept -> const_iterator;
+
+    // capacity and size
+
+    auto empty() const noexcept -> bool;
+    auto size() const noexcept -> size_type;
+    auto max_size() const noexcept -> size_type;
+    auto height() const noexcept -> size_type;
+
+    // modifiers
+
+    void clear() noexcept;
+    auto insert(const_reference value) -> const_iterator;
+    auto insert(value_type&& value) -> const_iterator;
+    template <class... Args>
+    auto emplace(Args&&... args) -> const_iterator;
+    template <class InputIt>
+    void bulk_load(InputIt first, InputIt last);
+    auto erase(const_iterator pos) -> const_iterator;
+    auto erase(const_iterator first, const_iterator last) -> const_iterator;
+    void swap(btree& other) noexcept;
+
+private:
+    friend class detail::btree_iterator<T, Compare, Allocator>;
+
+    // the fanout is at least two, so 2^64 elements are more than any memory can hold
+    static constexpr size_type max_depth = 64;
+
+    static constexpr size_type leaf_minimum = leaf_capacity / 2;
+    static constexpr size_type inner_minimum = inner_capacity / 2;
+
+    // erasing more than 1 / rebuild_fraction of the elements rebuilds the tree instead
+    static constexpr size_type rebuild_fraction = 8;
+
+    // size is the number of elements of a leaf or the number of children of an inner node
+    struct node {
+        inner* parent = nullptr;
+        size_type size = 0;
+    };
+
+    struct alignas(64) leaf : node {
+        leaf* prev = nullptr;
+        leaf* next = nullptr;
+        union {
+            T values[leaf_capacity];
+        };
+
+        leaf() noexcept {}  // NOLINT(modernize-use-equals-default) values are constructed later
+        ~leaf() {}          // NOLINT(modernize-use-equals-default) values are destroyed manually
+
+        leaf(const leaf&) = delete;
+        leaf(leaf&&) = delete;
+        auto operator=(const leaf&) -> leaf& = delete;
+        auto operator=(leaf&&) -> leaf& = delete;
+    };
+
+    // keys[i] separates children[i] and children[i + 1]: no element of children[i] is ordered after
+    // it and no element of children[i + 1] is ordered before it
+    struct alignas(64) inner : node {
+        size_type counts[inner_capacity];
+        node* children[inner_capacity];
+        union {
+            T keys[inner_capacity - 1];
+        };
+
+        inner() noexcept {}  // NOLINT(modernize-use-equals-default) keys are constructed later
+        ~inner() {}          // NOLINT(modernize-use-equals-default) keys are destroyed manually
+
+        inner(const inner&) = delete;
+        inner(inner&&) = delete;
+        auto operator=(const inner&) -> inner& = delete;
+        auto operator=(inner&&) -> inner& = delete;
+    };
+
+    struct step {
+        inner* parent;
+        size_type child;
+    };
+
+    using leaf_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<leaf>;
+    using leaf_traits = std::allocator_traits<leaf_allocator>;
+    using inner_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<inner>;
+    using inner_traits = std::allocator_traits<inner_allocator>;
+
+    Compare comp = Compare();
+    Allocator alloc = Allocator();
+    node* root = nullptr;
+    leaf* first = nullptr;
+    leaf* last = nullptr;
+    size_type depth = 0;  // the number of inner levels above the leaves
+    size_type count = 0;
+
+    static void insert_into(T* items, size_type size, size_type pos, T&& value) noexcept;
+    static void erase_from(T* items, size_type size, size_type pos) noexcept;
+    static void move_into(T* from, size_type size, T* to) noexcept;
+    static void shift_children(inner* n, size_type pos) noexcept;
+    static void unshift_children(inner* n, size_type pos) noexcept;
+    static auto key_count(const inner* n) noexcept -> size_type;
+
+    auto make_leaf() -> leaf*;
+    auto make_inner() -> inner*;
+    void destroy_leaf(leaf* n) noexcept;
+    void destroy_inner(inner* n) noexcept;
+    void destroy_levels(node* n, size_type levels) noexcept;
+
+    auto is_full(const node* n, bool is_leaf) const noexcept -> bool;
+    auto lower_index(const inner* n, const_reference value) const -> size_type;
+    auto upper_index(const inner* n, const_reference value) const -> size_type;
+    auto make_iterator(const leaf* n, size_type pos) const noexcept -> const_iterator;
+    auto iterator_at(size_type pos) const noexcept -> const_iterator;
+
+    auto insert_value(value_type&& value) -> const_iterator;
+    void grow();
+    void split_child(inner* parent, size_type pos, bool is_leaf);
+    void erase_at(size_type pos);
+    auto fix_child(inner* parent, size_type pos, bool is_leaf) -> size_type;
+    void borrow_left(inner* parent, size_type pos, bool is_leaf);
+    void borrow_right(inner* parent, size_type pos, bool is_leaf);
+    void merge_children(inner* parent, size_type pos, bool is_leaf) noexcept;
+
+    template <class InputIt>
+    void load(InputIt first_value, InputIt last_value);
+    template <class InputIt>
+    void load_leaves(InputIt first_value, InputIt last_value);
+    void load_inner_levels();
+    void move_all(btree& other);
+    void steal(btree& other) noexcept;
+};
+
+namespace detail {
+
+/**
+ * A bidirectional const iterator through the elements of a B+tree in sorted order, following the
+ * links between the leaves.
+ */
+template <class T, class Compare, class Allocator>
+class btree_iterator {
+    using tree_type = btree<T, Compare, Allocator>;
+    using leaf_type = typename tree_type::leaf;
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    btree_iterator() noexcept = default;
+
+    auto operator*() const noexcept -> reference { return current->values[index]; }
+    auto operator->() const noexcept -> pointer { return std::addressof(current->values[index]); }
+
+    auto operator++() noexcept -> btree_iterator& {
+        if (++index == current->size) {
+            current = current->next;
+            index = 0;
+        }
+        return *this;
+    }
+
+    auto operator++(int) noexcept -> btree_iterator {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    auto operator--() noexcept -> btree_iterator& {
+        if (current == nullptr) {
+            current = tree->last;
+            index = current->size - 1;
+        } else if (index == 0) {
+            current = current->prev;
+            index = current->size - 1;
+        } else {
+            --index;
+        }
+        return *this;
+    }
+
+    auto operator--(int) noexcept -> btree_iterator {
+        auto tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    friend auto operator==(const btree_iterator& lhs, const btree_iterator& rhs) noexcept -> bool {
+        return lhs.current == rhs.current && lhs.index == rhs.index;
+    }
+
+    friend auto operator!=(const btree_iterator& lhs, const btree_iterator& rhs) noexcept -> bool {
+        return !(lhs == rhs);
+    }
+
+private:
+    friend tree_type;
+
+    btree_iterator(const leaf_type* current, std::size_t index, const tree_type* tree) noexcept
+        : current(current), index(index), tree(tree) {}
+
+    const leaf_type* current = nullptr;
+    std::size_t index = 0;
+    const tree_type* tree = nullptr;
+};
+
+}  // namespace detail
+
+/**
+ * Constructs an empty B+tree ordered by the given comparison, allocating with the given allocator.
+ *
+ * @param comp the comparison function object ordering the elements
+ * @param alloc the allocator of the nodes
+ */
+template <class T, class Compare, class Allocator>
+btree<T, Compare, Allocator>::btree(const Compare& comp, const Allocator& alloc)
+    : comp(comp), alloc(alloc) {}
+
+template <class T, class Compare, class Allocator>
+btree<T, Compare, Allocator>::~btree() {
+    clear();
+}
+
+/**
+ * Constructs a B+tree with copies of the elements of another B+tree, bulk loaded in O(n).
+ *
+ * @param other another B+tree to copy the elements from
+ */
+template <class T, class Compare, class Allocator>
+btree<T, Compare, Allocator>::btree(const btree& other)
+    : comp(other.comp),
+      alloc(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc)) {
+    load(other.begin(), other.end());
+}
+
+/**
+ * Constructs a B+tree by taking over the nodes of another B+tree, which is left empty.
+ *
+ * @param other another B+tree to move the elements from
+ */
+template <class T, class Compare, class Allocator>
+btree<T, Compare, Allocator>::btree(btree&& other) noexcept
+    : comp(other.comp), alloc(std::move(other.alloc)) {
+    steal(other);
+}
+
+/**
+ * Replaces the elements with copies of the elements of another B+tree. The allocator is copied too
+ * if it propagates on copy assignment.
+ *
+ * @param other another B+tree to copy the elements from
+ * @return a reference to this instance
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::operator=(const btree& other) -> btree& {
+    if (this != &other) {
+        clear();
+        comp = other.comp;
+        if constexpr (std::allocator_traits<
+                          Allocator>::propagate_on_container_copy_assignment::value) {
+            alloc = other.alloc;
+        }
+        load(other.begin(), other.end());
+    }
+    return *this;
+}
+
+/**
+ * Replaces the elements by taking over the nodes of another B+tree, which is left empty. If the
+ * allocator does not propagate on move assignment and differs from the one of the other B+tree, the
+ * elements are moved into new nodes instead.
+ *
+ * @param other another B+tree to move the elements from
+ * @return a reference to this instance
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::operator=(btree&& other) noexcept(
+    std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<Allocator>::is_always_equal::value) -> btree& {
+    if (this != &other) {
+        clear();
+        comp = other.comp;
+        if constexpr (std::allocator_traits<
+                          Allocator>::propagate_on_container_move_assignment::value) {
+            alloc = std::move(other.alloc);
+            steal(other);
+        } else if (alloc == other.alloc) {
+            steal(other);
+        } else {
+            move_all(other);
+        }
+    }
+    return *this;
+}
+
+/**
+ * Returns a const reference to an element at the requested position with boundary checking.
+ *
+ * @param pos the position of the element to return
+ * @throw out_of_range if pos >= size()
+ * @return a const reference to the element at the requested position
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::at(size_type pos) const -> const_reference {
+    if (pos >= size()) {
+        throw std::out_of_range{"pos is out of range"};
+    }
+
+    return operator[](pos);
+}
+
+/**
+ * Returns a const reference to an element at the requested position without boundary checking in
+ * O(log n) time. Undefined behaviour if accessing a position >= size().
+ *
+ * @snippet test/btree.test.cpp btree_operator_square_brackets
+ * @param pos the position of the element to return
+ * @return a const reference to the element at the requested position
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::operator[](size_type pos) const -> const_reference {
+#ifdef UTIL_ASSERT
+    util_assert(pos < size());
+#endif
+
+    const auto it = iterator_at(pos);
+    return *it;
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::front() const -> const_reference {
+    return first->values[0];
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::back() const -> const_reference {
+    return last->values[last->size - 1];
+}
+
+/**
+ * Searches the first element that is not ordered before the given value in O(log n) time.
+ *
+ * @snippet test/btree.test.cpp btree_lower_bound
+ * @param value the value to compare the elements to
+ * @return a const iterator to the first element not less than value or end() if there is none
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::lower_bound(const_reference value) const -> const_iterator {
+    if (root == nullptr) {
+        return end();
+    }
+
+    const node* n = root;
+    for (auto level = depth; level > 0; --level) {
+        const auto* const parent = static_cast<const inner*>(n);
+        n = parent->children[lower_index(parent, value)];
+    }
+    const auto* const target = static_cast<const leaf*>(n);
+    const auto* const values = target->values;
+    return make_iterator(target,
+                         std::lower_bound(values, values + target->size, value, comp) - values);
+}
+
+/**
+ * Searches the first element that is ordered after the given value in O(log n) time.
+ *
+ * @param value the value to compare the elements to
+ * @return a const iterator to the first element greater than value or end() if there is none
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::upper_bound(const_reference value) const -> const_iterator {
+    if (root == nullptr) {
+        return end();
+    }
+
+    const node* n = root;
+    for (auto level = depth; level > 0; --level) {
+        const auto* const parent = static_cast<const inner*>(n);
+        n = parent->children[upper_index(parent, value)];
+    }
+    const auto* const target = static_cast<const leaf*>(n);
+    const auto* const values = target->values;
+    return make_iterator(target,
+                         std::upper_bound(values, values + target->size, value, comp) - values);
+}
+
+/**
+ * Searches an element equivalent to the given value in O(log n) time.
+ *
+ * @param value the value to search for
+ * @return a const iterator to the first equivalent element or end() if there is none
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::find(const_reference value) const -> const_iterator {
+    const auto it = lower_bound(value);
+    return it != end() && !comp(value, *it) ? it : end();
+}
+
+/**
+ * Returns the position of the element an iterator points to in O(log n) time, by walking up from
+ * its leaf and summing the element counts of the children left of the path.
+ *
+ * @param pos an iterator to an element of this B+tree or end()
+ * @return the position of the element or size() for end()
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::index_of(const_iterator pos) const -> size_type {
+    if (pos.current == nullptr) {
+        return count;
+    }
+
+    auto index = pos.index;
+    for (const node* n = pos.current; n->parent != nullptr; n = n->parent) {
+        const auto* const parent = n->parent;
+        for (size_type i = 0; parent->children[i] != n; ++i) {
+            index += parent->counts[i];
+        }
+    }
+    return index;
+}
+
+/**
+ * Counts the elements ordered before the given value in O(log n) time by summing the element
+ * counts of the children passed while searching.
+ *
+ * @snippet test/btree.test.cpp btree_rank
+ * @param value the value to compare the elements to
+ * @return the number of elements less than value, i.e. the position of lower_bound(value)
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::rank(const_reference value) const -> size_type {
+    if (root == nullptr) {
+        return 0;
+    }
+
+    size_type reached = 0;
+    const node* n = root;
+    for (auto level = depth; level > 0; --level) {
+        const auto* const parent = static_cast<const inner*>(n);
+        const auto child = lower_index(parent, value);
+        for (size_type i = 0; i < child; ++i) {
+            reached += parent->counts[i];
+        }
+        n = parent->children[child];
+    }
+    const auto* const values = static_cast<const leaf*>(n)->values;
+    return reached + (std::lower_bound(values, values + n->size, value, comp) - values);
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::begin() const noexcept -> const_iterator {
+    return const_iterator(first, 0, this);
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::cbegin() const noexcept -> const_iterator {
+    return begin();
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::end() const noexcept -> const_iterator {
+    return const_iterator(nullptr, 0, this);
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::cend() const noexcept -> const_iterator {
+    return end();
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::empty() const noexcept -> bool {
+    return count == 0;
+}
+
+/**
+ * Returns the count of elements in this B+tree in constant time.
+ *
+ * @return the number of contained elements
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::size() const noexcept -> size_type {
+    return count;
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::max_size() const noexcept -> size_type {
+    const auto leaves = leaf_traits::max_size(leaf_allocator(alloc));
+    return std::min(leaves, std::numeric_limits<size_type>::max() / leaf_capacity) * leaf_minimum;
+}
+
+/**
+ * Returns the number of levels of this B+tree, 0 if it is empty and 1 if all elements are in one
+ * leaf.
+ *
+ * @return the number of nodes on a path from the root to a leaf
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::height() const noexcept -> size_type {
+    return root == nullptr ? 0 : depth + 1;
+}
+
+/**
+ * Erases all elements from this B+tree.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::clear() noexcept {
+    if (root != nullptr) {
+        destroy_levels(root, depth);
+    }
+    for (auto* n = first; n != nullptr;) {
+        auto* const next = n->next;
+        destroy_leaf(n);
+        n = next;
+    }
+
+    root = nullptr;
+    first = nullptr;
+    last = nullptr;
+    depth = 0;
+    count = 0;
+}
+
+/**
+ * Inserts an element after all equivalent elements in O(log n) time. Full nodes on the way down
+ * are split before descending into them, so a split never has to propagate upwards.
+ *
+ * @snippet test/btree.test.cpp btree_insert
+ * @param value the element to insert
+ * @return a const iterator to the inserted element
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::insert(const_reference value) -> const_iterator {
+    return insert_value(value_type(value));
+}
+
+/**
+ * @see btree<T, Compare, Allocator>::insert(const_reference value) -> const_iterator
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::insert(value_type&& value) -> const_iterator {
+    return insert_value(std::move(value));
+}
+
+/**
+ * Constructs an element and inserts it after all equivalent elements.
+ *
+ * @param args the arguments to construct the element with
+ * @return a const iterator to the inserted element
+ */
+template <class T, class Compare, class Allocator>
+template <class... Args>
+auto btree<T, Compare, Allocator>::emplace(Args&&... args) -> const_iterator {
+    return insert_value(value_type(std::forward<Args>(args)...));
+}
+
+/**
+ * Replaces the elements with a range of elements which is already sorted by Compare in O(n). The
+ * leaves are filled completely and linked, then the inner levels are built bottom-up, so no node
+ * is ever split. The tree is left empty if copying an element throws.
+ *
+ * @snippet test/btree.test.cpp btree_bulk_load
+ * @tparam InputIt the type of the input iterator
+ * @param first the beginning of the sorted range of elements
+ * @param last the end of the sorted range of elements
+ * @throw util::assertion if the range is not sorted, only if UTIL_ASSERT is defined
+ */
+template <class T, class Compare, class Allocator>
+template <class InputIt>
+void btree<T, Compare, Allocator>::bulk_load(InputIt first, InputIt last) {
+    clear();
+    load(first, last);
+
+#ifdef UTIL_ASSERT
+    util_assert(std::is_sorted(begin(), end(), comp));
+#endif  // UTIL_ASSERT
+}
+
+/**
+ * Erases an element in O(log n) time. Nodes on the way down that could underflow are refilled from
+ * a sibling or merged with it before descending into them.
+ *
+ * @snippet test/btree.test.cpp btree_erase
+ * @param pos an iterator to the element to erase
+ * @return a const iterator to the element following the erased one
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::erase(const_iterator pos) -> const_iterator {
+    const auto index = index_of(pos);
+    erase_at(index);
+    return iterator_at(index);
+}
+
+/**
+ * Erases a range of k elements in O(min(k log n, n)) time. Short ranges are erased element by
+ * element, ranges longer than a fraction of the tree rebuild it from the remaining elements with a
+ * bulk load instead. The tree is left unchanged if the rebuild throws.
+ *
+ * @param first an iterator to the first element to erase
+ * @param last an iterator after the last element to erase
+ * @return a const iterator to the element following the erased ones
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::erase(const_iterator first, const_iterator last)
+    -> const_iterator {
+    const auto index = index_of(first);
+    const auto erased = index_of(last) - index;
+    if (erased <= count / rebuild_fraction) {
+        for (auto remaining = erased; remaining > 0; --remaining) {
+            erase_at(index);
+        }
+        return iterator_at(index);
+    }
+
+    std::vector<value_type> kept;
+    kept.reserve(count - erased);
+    kept.insert(kept.end(), begin(), first);
+    kept.insert(kept.end(), last, end());
+
+    btree rebuilt(comp, alloc);
+    rebuilt.load(std::make_move_iterator(kept.begin()), std::make_move_iterator(kept.end()));
+    clear();
+    steal(rebuilt);
+    return iterator_at(index);
+}
+
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::swap(btree& other) noexcept {
+    using std::swap;
+    swap(comp, other.comp);
+    if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+        swap(alloc, other.alloc);
+    }
+    swap(root, other.root);
+    swap(first, other.first);
+    swap(last, other.last);
+    swap(depth, other.depth);
+    swap(count, other.count);
+}
+
+/**
+ * Inserts a value at a position of an array of size elements, the slot at size must be raw.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::insert_into(T* items, size_type size, size_type pos,
+                                               T&& value) noexcept {
+    if (pos == size) {
+        ::new (static_cast<void*>(items + size)) T(std::move(value));
+        return;
+    }
+    ::new (static_cast<void*>(items + size)) T(std::move(items[size - 1]));
+    std::move_backward(items + pos, items + size - 1, items + size);
+    items[pos] = std::move(value);
+}
+
+/**
+ * Erases the element at a position of an array of size elements, leaving the last slot raw.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::erase_from(T* items, size_type size, size_type pos) noexcept {
+    std::move(items + pos + 1, items + size, items + pos);
+    items[size - 1].~T();
+}
+
+/**
+ * Moves size elements into raw slots of another array, leaving their slots raw.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::move_into(T* from, size_type size, T* to) noexcept {
+    std::uninitialized_move(from, from + size, to);
+    std::destroy(from, from + size);
+}
+
+/**
+ * Makes room for a child at a position of an inner node, without changing its size.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::shift_children(inner* n, size_type pos) noexcept {
+    std::copy_backward(n->children + pos, n->children + n->size, n->children + n->size + 1);
+    std::copy_backward(n->counts + pos, n->counts + n->size, n->counts + n->size + 1);
+}
+
+/**
+ * Removes the child at a position of an inner node, without changing its size.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::unshift_children(inner* n, size_type pos) noexcept {
+    std::copy(n->children + pos + 1, n->children + n->size, n->children + pos);
+    std::copy(n->counts + pos + 1, n->counts + n->size, n->counts + pos);
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::key_count(const inner* n) noexcept -> size_type {
+    return n->size == 0 ? 0 : n->size - 1;
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::make_leaf() -> leaf* {
+    auto node_alloc = leaf_allocator(alloc);
+    return ::new (static_cast<void*>(leaf_traits::allocate(node_alloc, 1))) leaf();
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::make_inner() -> inner* {
+    auto node_alloc = inner_allocator(alloc);
+    return ::new (static_cast<void*>(inner_traits::allocate(node_alloc, 1))) inner();
+}
+
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::destroy_leaf(leaf* n) noexcept {
+    std::destroy(n->values, n->values + n->size);
+    n->~leaf();
+    auto node_alloc = leaf_allocator(alloc);
+    leaf_traits::deallocate(node_alloc, n, 1);
+}
+
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::destroy_inner(inner* n) noexcept {
+    std::destroy(n->keys, n->keys + key_count(n));
+    n->~inner();
+    auto node_alloc = inner_allocator(alloc);
+    inner_traits::deallocate(node_alloc, n, 1);
+}
+
+/**
+ * Destroys the inner nodes of a subtree with the given number of inner levels. The leaves are
+ * destroyed separately along their links.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::destroy_levels(node* n, size_type levels) noexcept {
+    if (levels == 0) {
+        return;
+    }
+    auto* const parent = static_cast<inner*>(n);
+    for (size_type i = 0; i < parent->size; ++i) {
+        destroy_levels(parent->children[i], levels - 1);
+    }
+    destroy_inner(parent);
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::is_full(const node* n, bool is_leaf) const noexcept -> bool {
+    return n->size == (is_leaf ? leaf_capacity : inner_capacity);
+}
+
+/**
+ * Returns the child of an inner node that contains the first element not ordered before the value,
+ * or the last element before it if that is the last element of the child.
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::lower_index(const inner* n, const_reference value) const
+    -> size_type {
+    return std::lower_bound(n->keys, n->keys + key_count(n), value, comp) - n->keys;
+}
+
+/**
+ * Returns the child of an inner node that contains the first element ordered after the value, or
+ * the last element before it if that is the last element of the child.
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::upper_index(const inner* n, const_reference value) const
+    -> size_type {
+    return std::upper_bound(n->keys, n->keys + key_count(n), value, comp) - n->keys;
+}
+
+/**
+ * Returns an iterator to a position of a leaf, continuing at the next leaf for the end of a leaf.
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::make_iterator(const leaf* n, size_type pos) const noexcept
+    -> const_iterator {
+    return pos == n->size ? const_iterator(n->next, 0, this) : const_iterator(n, pos, this);
+}
+
+/**
+ * Returns an iterator to the element at a position by descending along the element counts.
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::iterator_at(size_type pos) const noexcept -> const_iterator {
+    if (pos >= count) {
+        return end();
+    }
+
+    const node* n = root;
+    for (auto level = depth; level > 0; --level) {
+        const auto* const parent = static_cast<const inner*>(n);
+        size_type child = 0;
+        for (; pos >= parent->counts[child]; ++child) {
+            pos -= parent->counts[child];
+        }
+        n = parent->children[child];
+    }
+    return const_iterator(static_cast<const leaf*>(n), pos, this);
+}
+
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::insert_value(value_type&& value) -> const_iterator {
+    if (root == nullptr) {
+        auto* const n = make_leaf();
+        root = n;
+        first = n;
+        last = n;
+    }
+    if (is_full(root, depth == 0)) {
+        grow();
+    }
+
+    std::array<step, max_depth> path{};
+    node* n = root;
+    for (auto level = depth; level > 0; --level) {
+        auto* const parent = static_cast<inner*>(n);
+        auto child = upper_index(parent, value);
+        if (is_full(parent->children[child], level == 1)) {
+            split_child(parent, child, level == 1);
+            child += comp(value, parent->keys[child]) ? 0 : 1;
+        }
+        path[depth - level] = {parent, child};
+        n = parent->children[child];
+    }
+
+    auto* const target = static_cast<leaf*>(n);
+    auto* const values = target->values;
+    const auto pos = std::upper_bound(values, values + target->size, value, comp) - values;
+    insert_into(values, target->size, pos, std::move(value));
+    ++target->size;
+
+    for (size_type level = 0; level < depth; ++level) {
+        ++path[level].parent->counts[path[level].child];
+    }
+    ++count;
+
+    return const_iterator(target, pos, this);
+}
+
+/**
+ * Puts a new root with the old root as its only child above the tree.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::grow() {
+    auto* const new_root = make_inner();
+    new_root->size = 1;
+    new_root->children[0] = root;
+    new_root->counts[0] = count;
+    root->parent = new_root;
+    root = new_root;
+    ++depth;
+}
+
+/**
+ * Splits a full child of an inner node that is not full into two halves. For leaves the first
+ * element of the right half is copied into the parent as the separator, inner nodes move their
+ * middle key up.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::split_child(inner* parent, size_type pos, bool is_leaf) {
+    size_type left_count = 0;
+    size_type right_count = 0;
+    node* right = nullptr;
+
+    if (is_leaf) {
+        auto* const left_leaf = static_cast<leaf*>(parent->children[pos]);
+        auto* const right_leaf = make_leaf();
+        const auto middle = leaf_capacity / 2;
+        try {
+            insert_into(parent->keys, key_count(parent), pos, T(left_leaf->values[middle]));
+        } catch (...) {
+            destroy_leaf(right_leaf);
+            throw;
+        }
+
+        move_into(left_leaf->values + middle, leaf_capacity - middle, right_leaf->values);
+        left_leaf->size = middle;
+        right_leaf->size = leaf_capacity - middle;
+
+        right_leaf->prev = left_leaf;
+        right_leaf->next = left_leaf->next;
+        (left_leaf->next == nullptr ? last : left_leaf->next->prev) = right_leaf;
+        left_leaf->next = right_leaf;
+
+        left_count = left_leaf->size;
+        right_count = right_leaf->size;
+        right = right_leaf;
+    } else {
+        auto* const left_inner = static_cast<inner*>(parent->children[pos]);
+        auto* const right_inner = make_inner();
+        const auto middle = inner_capacity / 2;
+        insert_into(parent->keys, key_count(parent), pos, std::move(left_inner->keys[middle - 1]));
+        left_inner->keys[middle - 1].~T();
+
+        move_into(left_inner->keys + middle, inner_capacity - 1 - middle, right_inner->keys);
+        for (auto i = middle; i < inner_capacity; ++i) {
+            right_inner->children[i - middle] = left_inner->children[i];
+            right_inner->counts[i - middle] = left_inner->counts[i];
+            right_inner->children[i - middle]->parent = right_inner;
+            right_count += left_inner->counts[i];
+        }
+        left_inner->size = middle;
+        right_inner->size = inner_capacity - middle;
+
+        left_count = parent->counts[pos] - right_count;
+        right = right_inner;
+    }
+
+    shift_children(parent, pos + 1);
+    parent->children[pos + 1] = right;
+    parent->counts[pos] = left_count;
+    parent->counts[pos + 1] = right_count;
+    right->parent = parent;
+    ++parent->size;
+}
+
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::erase_at(size_type pos) {
+    std::array<step, max_depth> path{};
+    size_type steps = 0;
+    node* n = root;
+    for (auto level = depth; level > 0;) {
+        auto* const parent = static_cast<inner*>(n);
+        if (parent == root && parent->size == 1) {
+            root = parent->children[0];
+            root->parent = nullptr;
+            destroy_inner(parent);
+            --depth;
+            --level;
+            n = root;
+            continue;
+        }
+
+        auto child = size_type{0};
+        auto offset = pos;
+        for (; offset >= parent->counts[child]; ++child) {
+            offset -= parent->counts[child];
+        }
+
+        const auto minimum = level == 1 ? leaf_minimum : inner_minimum;
+        if (parent->children[child]->size <= minimum) {
+            fix_child(parent, child, level == 1);
+            continue;  // the children changed, search this node again
+        }
+
+        path[steps++] = {parent, child};
+        n = parent->children[child];
+        pos = offset;
+        --level;
+    }
+
+    auto* const target = static_cast<leaf*>(n);
+    erase_from(target->values, target->size, pos);
+    --target->size;
+
+    for (size_type i = 0; i < steps; ++i) {
+        --path[i].parent->counts[path[i].child];
+    }
+    --count;
+
+    if (count == 0) {
+        clear();
+    }
+}
+
+/**
+ * Refills a child at minimum occupancy from a sibling or merges it with a sibling, so it stays at
+ * least at minimum occupancy after one element or child is erased from it.
+ *
+ * @return the position of the refilled child
+ */
+template <class T, class Compare, class Allocator>
+auto btree<T, Compare, Allocator>::fix_child(inner* parent, size_type pos, bool is_leaf)
+    -> size_type {
+    const auto minimum = is_leaf ? leaf_minimum : inner_minimum;
+    if (pos > 0 && parent->children[pos - 1]->size > minimum) {
+        borrow_left(parent, pos, is_leaf);
+        return pos;
+    }
+    if (pos + 1 < parent->size && parent->children[pos + 1]->size > minimum) {
+        borrow_right(parent, pos, is_leaf);
+        return pos;
+    }
+    if (pos > 0) {
+        merge_children(parent, pos - 1, is_leaf);
+        return pos - 1;
+    }
+    merge_children(parent, pos, is_leaf);
+    return pos;
+}
+
+/**
+ * Moves the last element or child of the left sibling to the front of a child.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::borrow_left(inner* parent, size_type pos, bool is_leaf) {
+    size_type moved = 1;
+    if (is_leaf) {
+        auto* const left = static_cast<leaf*>(parent->children[pos - 1]);
+        auto* const right = static_cast<leaf*>(parent->children[pos]);
+        auto separator = T(left->values[left->size - 1]);
+
+        insert_into(right->values, right->size, 0, std::move(left->values[left->size - 1]));
+        left->values[left->size - 1].~T();
+        --left->size;
+        ++right->size;
+        parent->keys[pos - 1] = std::move(separator);
+    } else {
+        auto* const left = static_cast<inner*>(parent->children[pos - 1]);
+        auto* const right = static_cast<inner*>(parent->children[pos]);
+        auto* const child = left->children[left->size - 1];
+        moved = left->counts[left->size - 1];
+
+        insert_into(right->keys, key_count(right), 0, std::move(parent->keys[pos - 1]));
+        shift_children(right, 0);
+        right->children[0] = child;
+        right->counts[0] = moved;
+        child->parent = right;
+        ++right->size;
+
+        parent->keys[pos - 1] = std::move(left->keys[key_count(left) - 1]);
+        left->keys[key_count(left) - 1].~T();
+        --left->size;
+    }
+    parent->counts[pos - 1] -= moved;
+    parent->counts[pos] += moved;
+}
+
+/**
+ * Moves the first element or child of the right sibling to the back of a child.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::borrow_right(inner* parent, size_type pos, bool is_leaf) {
+    size_type moved = 1;
+    if (is_leaf) {
+        auto* const left = static_cast<leaf*>(parent->children[pos]);
+        auto* const right = static_cast<leaf*>(parent->children[pos + 1]);
+        auto separator = T(right->values[1]);
+
+        ::new (static_cast<void*>(left->values + left->size)) T(std::move(right->values[0]));
+        erase_from(right->values, right->size, 0);
+        ++left->size;
+        --right->size;
+        parent->keys[pos] = std::move(separator);
+    } else {
+        auto* const left = static_cast<inner*>(parent->children[pos]);
+        auto* const right = static_cast<inner*>(parent->children[pos + 1]);
+        auto* const child = right->children[0];
+        moved = right->counts[0];
+
+        ::new (static_cast<void*>(left->keys + key_count(left))) T(std::move(parent->keys[pos]));
+        left->children[left->size] = child;
+        left->counts[left->size] = moved;
+        child->parent = left;
+        ++left->size;
+
+        parent->keys[pos] = std::move(right->keys[0]);
+        erase_from(right->keys, key_count(right), 0);
+        unshift_children(right, 0);
+        --right->size;
+    }
+    parent->counts[pos] += moved;
+    parent->counts[pos + 1] -= moved;
+}
+
+/**
+ * Merges the child at a position with its right sibling, which is destroyed. Both children must be
+ * at most at minimum occupancy.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::merge_children(inner* parent, size_type pos,
+                                                  bool is_leaf) noexcept {
+    if (is_leaf) {
+        auto* const left = static_cast<leaf*>(parent->children[pos]);
+        auto* const right = static_cast<leaf*>(parent->children[pos + 1]);
+
+        move_into(right->values, right->size, left->values + left->size);
+        left->size += right->size;
+        right->size = 0;
+
+        left->next = right->next;
+        (right->next == nullptr ? last : right->next->prev) = left;
+        destroy_leaf(right);
+    } else {
+        auto* const left = static_cast<inner*>(parent->children[pos]);
+        auto* const right = static_cast<inner*>(parent->children[pos + 1]);
+
+        ::new (static_cast<void*>(left->keys + key_count(left))) T(std::move(parent->keys[pos]));
+        move_into(right->keys, key_count(right), left->keys + left->size);
+        for (size_type i = 0; i < right->size; ++i) {
+            left->children[left->size + i] = right->children[i];
+            left->counts[left->size + i] = right->counts[i];
+            right->children[i]->parent = left;
+        }
+        left->size += right->size;
+        right->size = 0;
+        destroy_inner(right);
+    }
+
+    erase_from(parent->keys, key_count(parent), pos);
+    parent->counts[pos] += parent->counts[pos + 1];
+    unshift_children(parent, pos + 1);
+    --parent->size;
+}
+
+/**
+ * Builds this empty B+tree from a sorted range, leaving it empty if copying an element throws.
+ */
+template <class T, class Compare, class Allocator>
+template <class InputIt>
+void btree<T, Compare, Allocator>::load(InputIt first_value, InputIt last_value) {
+    try {
+        load_leaves(first_value, last_value);
+        load_inner_levels();
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+/**
+ * Fills linked leaves completely, except that the last leaf takes elements from the one before to
+ * reach minimum occupancy.
+ */
+template <class T, class Compare, class Allocator>
+template <class InputIt>
+void btree<T, Compare, Allocator>::load_leaves(InputIt first_value, InputIt last_value) {
+    leaf* current = nullptr;
+    for (; first_value != last_value; ++first_value) {
+        if (current == nullptr || current->size == leaf_capacity) {
+            auto* const next = make_leaf();
+            next->prev = current;
+            (current == nullptr ? first : current->next) = next;
+            last = next;
+            current = next;
+        }
+        ::new (static_cast<void*>(current->values + current->size)) T(*first_value);
+        ++current->size;
+        ++count;
+    }
+
+    if (current == nullptr || current->prev == nullptr || current->size >= leaf_minimum) {
+        return;
+    }
+    auto* const prev = current->prev;
+    const auto moved = (prev->size + current->size) / 2 - current->size;
+    for (auto i = current->size; i-- > 0;) {
+        ::new (static_cast<void*>(current->values + i + moved)) T(std::move(current->values[i]));
+        current->values[i].~T();
+    }
+    move_into(prev->values + prev->size - moved, moved, current->values);
+    prev->size -= moved;
+    current->size += moved;
+}
+
+/**
+ * Builds the inner levels above the linked leaves bottom-up. Each level is split into as few nodes
+ * as possible with evenly distributed children, so every node is at least at minimum occupancy.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::load_inner_levels() {
+    if (first == nullptr) {
+        return;
+    }
+
+    struct entry {
+        node* n;
+        size_type count;
+        const T* smallest;
+    };
+
+    std::vector<entry> level;
+    for (auto* n = first; n != nullptr; n = n->next) {
+        level.push_back({n, n->size, n->values});
+    }
+
+    // the tree has no root until all levels are built, so the inner nodes built so far are
+    // destroyed here if copying a separator throws, the leaves are destroyed by clear()
+    std::vector<inner*> built;
+    size_type levels = 0;
+    try {
+        while (level.size() > 1) {
+            const auto nodes = (level.size() + inner_capacity - 1) / inner_capacity;
+            std::vector<entry> parents;
+            parents.reserve(nodes);
+            built.reserve(built.size() + nodes);
+
+            for (size_type i = 0; i < nodes; ++i) {
+                const auto begin_child = level.size() * i / nodes;
+                const auto end_child = level.size() * (i + 1) / nodes;
+                auto* const parent = make_inner();
+                built.push_back(parent);
+
+                size_type total = 0;
+                for (auto child = begin_child; child < end_child; ++child) {
+                    if (child != begin_child) {
+                        ::new (static_cast<void*>(parent->keys + key_count(parent)))
+                            T(*level[child].smallest);
+                    }
+                    parent->children[parent->size] = level[child].n;
+                    parent->counts[parent->size] = level[child].count;
+                    level[child].n->parent = parent;
+                    ++parent->size;
+                    total += level[child].count;
+                }
+                parents.push_back({parent, total, level[begin_child].smallest});
+            }
+
+            level = std::move(parents);
+            ++levels;
+        }
+    } catch (...) {
+        for (auto* const n : built) {
+            destroy_inner(n);
+        }
+        throw;
+    }
+
+    root = level.front().n;
+    depth = levels;
+}
+
+/**
+ * Moves the elements of another B+tree into new nodes of this one, which must be empty, and clears
+ * the other one, for allocators which cannot free the nodes of each other.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::move_all(btree& other) {
+    std::vector<value_type> moved;
+    moved.reserve(other.count);
+    for (auto* n = other.first; n != nullptr; n = n->next) {
+        std::move(n->values, n->values + n->size, std::back_inserter(moved));
+    }
+    other.clear();
+    load(std::make_move_iterator(moved.begin()), std::make_move_iterator(moved.end()));
+}
+
+/**
+ * Takes over the nodes of another B+tree, this B+tree must be empty. Requires the allocators to be
+ * equal or to propagate.
+ */
+template <class T, class Compare, class Allocator>
+void btree<T, Compare, Allocator>::steal(btree& other) noexcept {
+    root = std::exchange(other.root, nullptr);
+    first = std::exchange(other.first, nullptr);
+    last = std::exchange(other.last, nullptr);
+    depth = std::exchange(other.depth, 0);
+    count = std::exchange(other.count, 0);
+}
+
+// a B+tree combines logarithmic insert with the lookup and iteration locality of a vector
+template <class T, class Allocator = std::allocator<T>>
+using sorted_btree = sorted<btree<T, std::less<T>, Allocator>>;
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_BTREE_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,461 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_COMPRESSED_SORTED_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_COMPRESSED_SORTED_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "simd.hpp"
+#include "sorted.hpp"
+
+#ifdef UTIL_ASSERT
+#include "assert.hpp"
+#endif
+
+namespace util {
+
+template <class T>
+class compressed_sorted;
+
+namespace detail {
+
+template <class T>
+class compressed_sorted_iterator;
+
+constexpr auto bit_width(std::uint64_t value) noexcept -> unsigned {
+    unsigned width = 0;
+    for (; value != 0; value >>= 1U) {
+        ++width;
+    }
+    return width;
+}
+
+constexpr auto width_mask(unsigned width) noexcept -> std::uint64_t {
+    return width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+}
+
+/**
+ * Extracts the bits starting at the given bit position. Always reads two words, so the packed words
+ * need padding after their end.
+ */
+inline auto unpack(const std::uint64_t* packed, std::size_t bit, std::uint64_t mask) noexcept
+    -> std::uint64_t {
+    const auto shift = bit % 64;
+    const auto low = packed[bit / 64] >> shift;
+    const auto high = (packed[bit / 64 + 1] << 1U) << (63 - shift);
+    return (low | high) & mask;
+}
+
+}  // namespace detail
+
+/**
+ * An immutable sorted set of unsigned integers compressed by delta encoding and bit packing.
+ *
+ * The values are split into blocks of 128. Each block stores the differences between neighboring
+ * values with the bit width of its largest difference, so dense values take a few bits each. A
+ * skip index of the block maxima is searched first, then only the found block is decoded, with a
+ * SIMD prefix sum for 32 and 64 bit values. Iterators decode one difference per step.
+ *
+ * @snippet test/compressed_sorted.test.cpp compressed_sorted
+ * @tparam T an unsigned integer type
+ */
+template <class T>
+class compressed_sorted {
+public:
+    static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                  "only unsigned integers can be compressed");
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_iterator = detail::compressed_sorted_iterator<T>;
+
+    static constexpr size_type block_size = 128;
+
+    compressed_sorted() = default;
+    template <class Container>
+    explicit compressed_sorted(const sorted<Container, std::less<T>>& elements);
+    template <class InputIt>
+    compressed_sorted(InputIt first, InputIt last);
+    template <class InputIt>
+    compressed_sorted(presorted_t, InputIt first, InputIt last);
+
+    // lookup
+
+    auto lower_bound(value_type value) const -> const_iterator;
+    auto find(value_type value) const -> const_iterator;
+    auto contains(value_type value) const -> bool;
+
+    // iterators
+
+    auto begin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+
+    // capacity
+
+    auto empty() const noexcept -> bool;
+    auto size() const noexcept -> size_type;
+    auto memory_usage() const noexcept -> size_type;
+
+    // decoding
+
+    auto decode_block(size_type block, value_type* out) const noexcept -> size_type;
+    void decode(value_type* out) const noexcept;
+    auto decode() const -> std::vector<value_type>;
+
+private:
+    friend class detail::compressed_sorted_iterator<T>;
+
+    size_type count = 0;
+    std::vector<value_type> maxima;    // the skip index, the largest value of each block
+    std::vector<value_type> firsts;    // the smallest value of each block
+    std::vector<size_type> offsets;    // the first word of each block, one more than blocks
+    std::vector<std::uint8_t> widths;  // the bits per difference of each block
+    std::vector<std::uint64_t> words;  // the packed differences of all blocks and padding
+
+    auto block_count() const noexcept -> size_type;
+    auto block_length(size_type block) const noexcept -> size_type;
+    auto delta(size_type block, size_type pos) const noexcept -> value_type;
+    template <class ForwardIt>
+    void encode(ForwardIt first, ForwardIt last);
+};
+
+namespace detail {
+
+/**
+ * A forward iterator over the values of a util::compressed_sorted. Dereferencing returns the value
+ * itself, as the values are not stored uncompressed.
+ */
+template <class T>
+class compressed_sorted_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = T;
+
+    compressed_sorted_iterator() noexcept = default;
+
+    auto operator*() const noexcept -> reference { return current; }
+    auto operator->() const noexcept -> pointer { return &current; }
+
+    auto operator++() noexcept -> compressed_sorted_iterator& {
+        if (++pos < set->block_length(block)) {
+            current += set->delta(block, pos);
+        } else {
+            pos = 0;
+            ++block;
+            current = block < set->block_count() ? set->firsts[block] : T{};
+        }
+        return *this;
+    }
+
+    auto operator++(int) noexcept -> compressed_sorted_iterator {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    friend auto operator==(const compressed_sorted_iterator& lhs,
+                           const compressed_sorted_iterator& rhs) noexcept -> bool {
+        return lhs.block == rhs.block && lhs.pos == rhs.pos;
+    }
+
+    friend auto operator!=(const compressed_sorted_iterator& lhs,
+                           const compressed_sorted_iterator& rhs) noexcept -> bool {
+        return !(lhs == rhs);
+    }
+
+private:
+    friend class util::compressed_sorted<T>;
+
+    compressed_sorted_iterator(const compressed_sorted<T>* set, std::size_t block, std::size_t pos,
+                               T current) noexcept
+        : set(set), block(block), pos(pos), current(current) {}
+
+    const compressed_sorted<T>* set = nullptr;
+    std::size_t block = 0;
+    std::size_t pos = 0;
+    T current{};
+};
+
+}  // namespace detail
+
+/**
+ * Compresses the elements of a sorted container.
+ *
+ * @param elements the sorted container ordered by std::less
+ */
+template <class T>
+template <class Container>
+compressed_sorted<T>::compressed_sorted(const sorted<Container, std::less<T>>& elements) {
+    encode(elements.begin(), elements.end());
+}
+
+/**
+ * Sorts and compresses a range of values.
+ *
+ * @tparam InputIt the type of the input iterator
+ * @param first the beginning of the values
+ * @param last the end of the values
+ */
+template <class T>
+template <class InputIt>
+compressed_sorted<T>::compressed_sorted(InputIt first, InputIt last) {
+    std::vector<value_type> values(first, last);
+    std::sort(values.begin(), values.end());
+    encode(values.begin(), values.end());
+}
+
+/**
+ * Compresses a range of values that is already sorted ascending.
+ *
+ * @tparam InputIt the type of the input iterator, a forward iterator avoids a copy
+ * @param first the beginning of the sorted values
+ * @param last the end of the sorted values
+ * @throw util::assertion if the range is not sorted, only if UTIL_ASSERT is defined
+ */
+template <class T>
+template <class InputIt>
+compressed_sorted<T>::compressed_sorted(presorted_t /*unused*/, InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+#ifdef UTIL_ASSERT
+        util_assert(std::is_sorted(first, last));
+#endif  // UTIL_ASSERT
+        encode(first, last);
+    } else {
+        const std::vector<value_type> values(first, last);
+#ifdef UTIL_ASSERT
+        util_assert(std::is_sorted(values.begin(), values.end()));
+#endif  // UTIL_ASSERT
+        encode(values.begin(), values.end());
+    }
+}
+
+/**
+ * Searches the first value not less than the given value: the block is found by a search of the
+ * block maxima, the position by summing up the differences of the block until value is reached.
+ *
+ * @snippet test/compressed_sorted.test.cpp compressed_sorted
+ * @param value the value to compare to
+ * @return an iterator to the first value not less than value or end() if there is none
+ */
+template <class T>
+auto compressed_sorted<T>::lower_bound(value_type value) const -> const_iterator {
+    size_type block = 0;
+    if constexpr (is_simd_searchable<T>::value) {
+        const auto* const first = maxima.data();
+        block = static_cast<size_type>(
+            simd_lower_bound(first, first + maxima.size(), value) - first);
+    } else {
+        block = static_cast<size_type>(std::lower_bound(maxima.begin(), maxima.end(), value) -
+                                       maxima.begin());
+    }
+    if (block == block_count()) {
+        return end();
+    }
+
+    // the maximum of the block is not less than value, so the sum stops within the block
+    const auto width = widths[block];
+    const auto* const packed = words.data() + offsets[block];
+    const auto mask = detail::width_mask(width);
+    auto current = firsts[block];
+    size_type pos = 0;
+    for (size_type bit = width; current < value; bit += width) {
+        current += static_cast<value_type>(detail::unpack(packed, bit, mask));
+        ++pos;
+    }
+    return const_iterator(this, block, pos, current);
+}
+
+/**
+ * Searches the given value.
+ *
+ * @param value the value to search for
+ * @return an iterator to the value or end() if it is not contained
+ */
+template <class T>
+auto compressed_sorted<T>::find(value_type value) const -> const_iterator {
+    const auto it = lower_bound(value);
+    return it != end() && *it == value ? it : end();
+}
+
+/**
+ * Checks if the given value is contained.
+ *
+ * @param value the value to search for
+ * @return true if the value is contained, otherwise false
+ */
+template <class T>
+auto compressed_sorted<T>::contains(value_type value) const -> bool {
+    return find(value) != end();
+}
+
+template <class T>
+auto compressed_sorted<T>::begin() const noexcept -> const_iterator {
+    return const_iterator(this, 0, 0, empty() ? T{} : firsts.front());
+}
+
+template <class T>
+auto compressed_sorted<T>::end() const noexcept -> const_iterator {
+    return const_iterator(this, block_count(), 0, T{});
+}
+
+template <class T>
+auto compressed_sorted<T>::empty() const noexcept -> bool {
+    return count == 0;
+}
+
+template <class T>
+auto compressed_sorted<T>::size() const noexcept -> size_type {
+    return count;
+}
+
+/**
+ * Returns the number of bytes allocated for the compressed values and the skip index.
+ *
+ * @return the number of bytes in use
+ */
+template <class T>
+auto compressed_sorted<T>::memory_usage() const noexcept -> size_type {
+    return maxima.capacity() * sizeof(value_type) + firsts.capacity() * sizeof(value_type) +
+           offsets.capacity() * sizeof(size_type) + widths.capacity() +
+           words.capacity() * sizeof(std::uint64_t);
+}
+
+/**
+ * Decodes the values of one block.
+ *
+ * @param block the index of the block, less than (size() + block_size - 1) / block_size
+ * @param out the memory to write the values to, with space for block_size values
+ * @return the number of values written, block_size for all blocks except the last
+ */
+template <class T>
+auto compressed_sorted<T>::decode_block(size_type block, value_type* out) const noexcept
+    -> size_type {
+    const auto length = block_length(block);
+    const auto width = widths[block];
+    const auto* const packed = words.data() + offsets[block];
+    const auto mask = detail::width_mask(width);
+
+    out[0] = firsts[block];
+    for (size_type pos = 1, bit = width; pos < length; ++pos, bit += width) {
+        out[pos] = static_cast<value_type>(detail::unpack(packed, bit, mask));
+    }
+    detail::prefix_sum(out, length);
+    return length;
+}
+
+/**
+ * Decodes all values block by block.
+ *
+ * @param out the memory to write the values to, with space for size() values
+ */
+template <class T>
+void compressed_sorted<T>::decode(value_type* out) const noexcept {
+    for (size_type block = 0; block < block_count(); ++block) {
+        out += decode_block(block, out);
+    }
+}
+
+/**
+ * Decodes all values into a vector.
+ *
+ * @return the sorted values
+ */
+template <class T>
+auto compressed_sorted<T>::decode() const -> std::vector<value_type> {
+    std::vector<value_type> values(count);
+    decode(values.data());
+    return values;
+}
+
+template <class T>
+auto compressed_sorted<T>::block_count() const noexcept -> size_type {
+    return firsts.size();
+}
+
+template <class T>
+auto compressed_sorted<T>::block_length(size_type block) const noexcept -> size_type {
+    return std::min(block_size, count - block * block_size);
+}
+
+/**
+ * Extracts the packed difference between the value at pos and its predecessor within a block.
+ */
+template <class T>
+auto compressed_sorted<T>::delta(size_type block, size_type pos) const noexcept -> value_type {
+    const auto width = widths[block];
+    return static_cast<value_type>(
+        detail::unpack(words.data() + offsets[block], pos * width, detail::width_mask(width)));
+}
+
+template <class T>
+template <class ForwardIt>
+void compressed_sorted<T>::encode(ForwardIt first, ForwardIt last) {
+    count = static_cast<size_type>(std::distance(first, last));
+    const auto blocks = (count + block_size - 1) / block_size;
+    maxima.reserve(blocks);
+    firsts.reserve(blocks);
+    offsets.reserve(blocks + 1);
+    widths.reserve(blocks);
+    offsets.push_back(0);
+
+    std::array<value_type, block_size> deltas{};
+    while (first != last) {
+        size_type length = 0;
+        value_type previous = *first;
+        value_type largest = 0;
+        firsts.push_back(previous);
+        for (; first != last && length < block_size; ++first, ++length) {
+            deltas[length] = static_cast<value_type>(*first - previous);
+            largest = std::max(largest, deltas[length]);
+            previous = *first;
+        }
+        maxima.push_back(previous);
+
+        const auto width = detail::bit_width(largest);
+        const auto start = words.size();
+        words.resize(start + (length * width + 63) / 64);
+        for (size_type pos = 1; pos < length && width != 0; ++pos) {
+            const auto bit = pos * width;
+            const auto shift = bit % 64;
+            const auto bits = static_cast<std::uint64_t>(deltas[pos]);
+            words[start + bit / 64] |= bits << shift;
+            if (shift + width > 64) {
+                words[start + bit / 64 + 1] |= bits >> (64 - shift);
+            }
+        }
+        widths.push_back(static_cast<std::uint8_t>(width));
+        offsets.push_back(words.size());
+    }
+    words.resize(words.size() + 2);  // unpacking reads one word ahead, even for empty blocks
+    words.shrink_to_fit();
+}
+
+/**
+ * Compresses the elements of a sorted container of unsigned integers.
+ *
+ * @snippet test/compressed_sorted.test.cpp compressed_sorted
+ * @param elements the sorted container ordered by std::less
+ * @return a compressed copy of the elements
+ */
+template <class Container>
+auto compress(const sorted<Container, std::less<typename Container::value_type>>& elements)
+    -> compressed_sorted<typename Container::value_type> {
+    return compressed_sorted<typename Container::value_type>(elements);
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_COMPRESSED_SORTED_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,262 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_CONCURRENT_SORTED_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_CONCURRENT_SORTED_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "epoch_domain.hpp"
+#include "sorted.hpp"
+
+namespace util {
+
+/**
+ * A sorted container for many concurrent readers and few writers.
+ *
+ * Readers take snapshots of the current version without blocking: a snapshot takes a read lock of
+ * the global util::epoch_domain and then reads the pointer to the version, so readers on different
+ * threads do not write to shared memory. Writers are serialized by a mutex, copy the current
+ * version, modify the copy and publish it atomically. A replaced version is retired to the epoch
+ * domain and deleted by the writer once all snapshots taken before the replacement are released,
+ * so a snapshot stays valid for as long as it lives.
+ *
+ * @snippet test/concurrent_sorted.test.cpp concurrent_sorted
+ * @tparam Container the type of container to keep sorted, see util::sorted
+ * @tparam Compare the comparison function object, see util::sorted
+ */
+template <class Container, class Compare = std::less<typename Container::value_type>>
+class concurrent_sorted {
+public:
+    using sorted_type = sorted<Container, Compare>;
+    using value_type = typename sorted_type::value_type;
+    using size_type = typename sorted_type::size_type;
+    using const_reference = typename sorted_type::const_reference;
+
+    class snapshot;
+
+    concurrent_sorted();
+    explicit concurrent_sorted(sorted_type initial);
+    ~concurrent_sorted();
+    concurrent_sorted(const concurrent_sorted&) = delete;
+    concurrent_sorted(concurrent_sorted&&) = delete;
+    auto operator=(const concurrent_sorted&) -> concurrent_sorted& = delete;
+    auto operator=(concurrent_sorted&&) -> concurrent_sorted& = delete;
+
+    // readers
+
+    auto read() const -> snapshot;
+    auto contains(const_reference value) const -> bool;
+    auto size() const -> size_type;
+
+    // writers
+
+    void insert(const_reference value);
+    template <class InputIt>
+    void insert(InputIt first, InputIt last);
+    auto erase(const_reference value) -> size_type;
+    template <class Function>
+    void update(Function&& function);
+    void assign(sorted_type replacement);
+
+private:
+    std::atomic<const sorted_type*> current;
+    std::mutex writer;
+
+    void publish(const sorted_type* version);
+};
+
+/**
+ * A consistent read-only view of a concurrent_sorted at one point in time. Holding a snapshot
+ * keeps its version and all later versions from being deleted, so snapshots should be short-lived.
+ */
+template <class Container, class Compare>
+class concurrent_sorted<Container, Compare>::snapshot {
+public:
+    snapshot(const snapshot&) = delete;
+    auto operator=(const snapshot&) -> snapshot& = delete;
+
+    snapshot(snapshot&& other) noexcept = default;
+    auto operator=(snapshot&& other) noexcept -> snapshot& = default;
+    ~snapshot() = default;
+
+    auto operator*() const noexcept -> const sorted_type& { return *version; }
+    auto operator->() const noexcept -> const sorted_type* { return version; }
+
+private:
+    friend class concurrent_sorted;
+
+    explicit snapshot(const std::atomic<const sorted_type*>& current)
+        : version(current.load()) {}
+
+    epoch_domain::read_lock lock;  // taken before the version is loaded
+    const sorted_type* version;
+};
+
+/**
+ * Constructs an empty concurrent sorted container.
+ */
+template <class Container, class Compare>
+concurrent_sorted<Container, Compare>::concurrent_sorted() : current(new sorted_type()) {}
+
+/**
+ * Constructs a concurrent sorted container with the elements of a sorted container.
+ *
+ * @param initial the sorted container to take over as the first version
+ */
+template <class Container, class Compare>
+concurrent_sorted<Container, Compare>::concurrent_sorted(sorted_type initial)
+    : current(new sorted_type(std::move(initial))) {}
+
+/**
+ * Deletes the current version, replaced versions are deleted by the epoch domain. Undefined
+ * behaviour if snapshots are still held.
+ */
+template <class Container, class Compare>
+concurrent_sorted<Container, Compare>::~concurrent_sorted() {
+    delete current.load();
+}
+
+/**
+ * Takes a snapshot of the current version without blocking.
+ *
+ * @snippet test/concurrent_sorted.test.cpp concurrent_sorted
+ * @return a snapshot giving read access to the current version
+ */
+template <class Container, class Compare>
+auto concurrent_sorted<Container, Compare>::read() const -> snapshot {
+    return snapshot(current);
+}
+
+/**
+ * Checks if the current version has an element equivalent to the given value.
+ *
+ * @param value the value to search for
+ * @return true if there is an equivalent element, otherwise false
+ */
+template <class Container, class Compare>
+auto concurrent_sorted<Container, Compare>::contains(const_reference value) const -> bool {
+    return read()->contains(value);
+}
+
+/**
+ * Returns the number of elements of the current version.
+ *
+ * @return the number of elements
+ */
+template <class Container, class Compare>
+auto concurrent_sorted<Container, Compare>::size() const -> size_type {
+    return read()->size();
+}
+
+/**
+ * Publishes a new version with the given value inserted. Copies all elements.
+ *
+ * @param value the value to insert
+ */
+template <class Container, class Compare>
+void concurrent_sorted<Container, Compare>::insert(const_reference value) {
+    update([&](sorted_type& next) { next.insert(value); });
+}
+
+/**
+ * Publishes a new version with a batch of values inserted. The batch is sorted and merged with the
+ * elements of the current version in one pass, so a batch of m values costs O(n + m log m) for
+ * vectors instead of m copies of all n elements.
+ *
+ * @snippet test/concurrent_sorted.test.cpp concurrent_sorted
+ * @tparam InputIt the type of the input iterator
+ * @param first the beginning of the values to insert
+ * @param last the end of the values to insert
+ */
+template <class Container, class Compare>
+template <class InputIt>
+void concurrent_sorted<Container, Compare>::insert(InputIt first, InputIt last) {
+    const std::lock_guard<std::mutex> lock(writer);
+    const auto* const old = current.load();
+
+    std::vector<value_type> batch(first, last);
+    std::stable_sort(batch.begin(), batch.end(), old->key_comp());
+
+    std::vector<value_type> merged;
+    merged.reserve(old->size() + batch.size());
+    std::merge(old->begin(), old->end(), batch.begin(), batch.end(), std::back_inserter(merged),
+               old->key_comp());
+
+    if constexpr (std::is_same<Container, std::vector<value_type>>::value) {
+        publish(new sorted_type(presorted, std::move(merged)));
+    } else {
+        publish(new sorted_type(presorted, merged.begin(), merged.end()));
+    }
+}
+
+/**
+ * Publishes a new version without the elements equivalent to the given value.
+ *
+ * @param value the value to erase
+ * @return the number of erased elements
+ */
+template <class Container, class Compare>
+auto concurrent_sorted<Container, Compare>::erase(const_reference value) -> size_type {
+    size_type erased = 0;
+    update([&](sorted_type& next) {
+        const auto size = next.size();
+        next.erase(next.lower_bound(value), next.upper_bound(value));
+        erased = size - next.size();
+    });
+    return erased;
+}
+
+/**
+ * Publishes a new version modified by a function. The function gets a copy of the current version,
+ * readers keep seeing the current version until the function returns.
+ *
+ * @tparam Function the type of the function object taking a sorted_type&
+ * @param function the function to modify the copy of the current version with
+ */
+template <class Container, class Compare>
+template <class Function>
+void concurrent_sorted<Container, Compare>::update(Function&& function) {
+    const std::lock_guard<std::mutex> lock(writer);
+    auto* const next = new sorted_type(*current.load());
+    try {
+        std::forward<Function>(function)(*next);
+    } catch (...) {
+        delete next;
+        throw;
+    }
+    publish(next);
+}
+
+/**
+ * Publishes a given sorted container as the new version.
+ *
+ * @param replacement the sorted container to take over
+ */
+template <class Container, class Compare>
+void concurrent_sorted<Container, Compare>::assign(sorted_type replacement) {
+    const std::lock_guard<std::mutex> lock(writer);
+    publish(new sorted_type(std::move(replacement)));
+}
+
+template <class Container, class Compare>
+void concurrent_sorted<Container, Compare>::publish(const sorted_type* version) {
+    // versions are large, so they are reclaimed right away instead of in batches
+    auto& domain = epoch_domain::global();
+    domain.retire(current.exchange(version));
+    domain.reclaim();
+}
+
+template <class T, class Allocator = std::allocator<T>>
+using concurrent_sorted_vector = concurrent_sorted<std::vector<T, Allocator>>;
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_CONCURRENT_SORTED_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_EPOCH_DOMAIN_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_EPOCH_DOMAIN_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "reclamation_domain.hpp"
+
+namespace util {
+
+/**
+ * A domain of epoch-based reclamation (RCU-style) for read-mostly data shared between threads.
+ *
+ * Readers hold a read_lock while they access shared objects, which announces the current epoch of
+ * the domain in a slot exclusive to the reader. Writers retire objects they unlinked instead of
+ * deleting them, every retired object is stamped with the epoch it was retired in, which advances
+ * the epoch. An object is reclaimed by its deleter once every active read_lock announces a later
+ * epoch, i.e. once all readers which might have seen the object are done. Unlike a
+ * util::hazard_pointer, a read_lock protects everything a reader reaches, so it costs one store per
+ * read section instead of one per object, but a reader holding its lock for a long time keeps all
+ * objects retired meanwhile alive.
+ *
+ * Retired objects are reclaimed in batches of at least min_batch by the writers retiring them, or
+ * by calling reclaim(). Slots are padded to a cache line each and are reused once released, they
+ * are freed with the domain. Most code uses the process-wide domain returned by global().
+ *
+ * @code{.cpp}
+ * std::atomic<config*> current{new config()};
+ * // reader
+ * const util::epoch_domain::read_lock lock;
+ * const config* loaded = current.load();
+ * // writer
+ * util::epoch_domain::global().retire(current.exchange(new config()));
+ * @endcode
+ */
+class epoch_domain : public detail::reclamation_domain<epoch_domain, std::uint64_t> {
+public:
+    static constexpr std::size_t min_batch = 64;
+
+    class read_lock;
+
+    template <class T, class Deleter = std::default_delete<T>>
+    void retire(T* ptr, Deleter deleter = Deleter());
+    void reclaim();
+
+private:
+    // the current epoch, slots announce the epoch their read lock was taken in or 0 if idle
+    alignas(64) std::atomic<std::uint64_t> epoch{1};
+};
+
+/**
+ * A read-side critical section of the calling thread. While it is held, no object retired to its
+ * domain after the lock was taken is reclaimed, so everything reachable from shared data stays
+ * valid. Read locks may be nested and moved, e.g. into a snapshot object handed to the caller.
+ *
+ * Read locks of the global domain reuse a slot cached per thread, so taking one usually costs a
+ * load of the epoch and a store to the slot.
+ */
+class epoch_domain::read_lock {
+public:
+    explicit read_lock(epoch_domain& domain = epoch_domain::global());
+    read_lock(read_lock&& other) noexcept;
+    read_lock(const read_lock&) = delete;
+    auto operator=(read_lock&& other) noexcept -> read_lock&;
+    auto operator=(const read_lock&) -> read_lock& = delete;
+    ~read_lock();
+
+    void swap(read_lock& other) noexcept;
+
+private:
+    using slot_cache = detail::slot_cache<epoch_domain>;
+
+    epoch_domain* domain;
+    slot_cache::slot* owned;
+};
+
+/**
+ * Retires an object which was unlinked from all shared data and will be reclaimed by calling the
+ * given deleter as soon as all read locks taken before this call are released.
+ *
+ * @tparam T the type of the object
+ * @tparam Deleter the type of the deleter, callable with the pointer
+ * @param ptr the object to retire
+ * @param deleter the deleter reclaiming the object
+ */
+template <class T, class Deleter>
+void epoch_domain::retire(T* ptr, Deleter deleter) {
+    if (!ptr) {
+        return;
+    }
+
+    // readers announcing a later epoch took their lock after the object was unlinked
+    this->add_retired(ptr, std::move(deleter), this->epoch.fetch_add(1));
+
+    if (this->retired_count() >= min_batch) {
+        this->reclaim();
+    }
+}
+
+/**
+ * Scans all read locks of the domain and reclaims all retired objects which were retired before
+ * the oldest of them was taken. Younger objects stay retired until a later scan.
+ */
+inline void epoch_domain::reclaim() {
+    auto* list = this->take();
+    if (!list) {
+        return;
+    }
+
+    auto oldest = std::numeric_limits<std::uint64_t>::max();
+    for (auto* s = this->first_slot(); s; s = s->next) {
+        const auto announced = s->announced.load();
+        oldest = announced != 0 ? std::min(oldest, announced) : oldest;
+    }
+
+    this->sweep(list, [oldest](const retired& object) { return object.stamp >= oldest; });
+}
+
+/**
+ * Takes a read lock by announcing the current epoch of the domain.
+ *
+ * @param domain the domain whose retired objects the read lock protects
+ */
+inline epoch_domain::read_lock::read_lock(epoch_domain& domain)
+    : domain(&domain), owned(slot_cache::acquire(domain)) {
+    // an outdated epoch only delays reclamation, the acquire load orders all unlinking of objects
+    // retired before it, the sequentially consistent store orders the announcement before the
+    // loads of the reader
+    this->owned->announced.store(domain.epoch.load(std::memory_order_acquire));
+}
+
+/**
+ * Takes over the read lock of another instance, which is unlocked.
+ *
+ * @param other another read lock
+ */
+inline epoch_domain::read_lock::read_lock(read_lock&& other) noexcept
+    : domain(other.domain), owned(std::exchange(other.owned, nullptr)) {}
+
+/**
+ * Releases this read lock and takes over the read lock of another instance, which is unlocked.
+ *
+ * @param other another read lock
+ * @return a reference to this instance
+ */
+inline auto epoch_domain::read_lock::operator=(read_lock&& other) noexcept -> read_lock& {
+    read_lock(std::move(other)).swap(*this);
+
+    return *this;
+}
+
+/**
+ * Releases the read lock, slots of the global domain are kept by the thread.
+ */
+inline epoch_domain::read_lock::~read_lock() {
+    if (!this->owned) {
+        return;
+    }
+
+    slot_cache::release(*this->domain, this->owned);
+}
+
+/**
+ * Exchanges the slots of two read locks.
+ *
+ * @param other another read lock
+ */
+inline void epoch_domain::read_lock::swap(read_lock& other) noexcept {
+    std::swap(this->domain, other.domain);
+    std::swap(this->owned, other.owned);
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_EPOCH_DOMAIN_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,235 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_FROZEN_SORTED_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_FROZEN_SORTED_HEADER_IS_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "sorted.hpp"
+
+namespace util {
+
+namespace detail {
+
+/**
+ * Returns the number of consecutive set bits starting at the least significant bit.
+ */
+inline auto trailing_ones(std::size_t value) noexcept -> unsigned {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(~static_cast<unsigned long long>(value)));
+#else
+    unsigned count = 0;
+    while (value & 1U) {
+        value >>= 1U;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+/**
+ * Hints the processor to fetch the cache line containing the given address. The address has to
+ * point into or one past an object, forming any other pointer is undefined even for a hint.
+ */
+inline void prefetch(const void* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    static_cast<void>(address);
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * An immutable, search-optimized copy of sorted elements.
+ *
+ * The elements are stored in Eytzinger (breadth-first) order: the root of an implicit binary
+ * search tree is at index 1 and the children of index k are at 2k and 2k+1. The first levels of the
+ * tree share a few cache lines and the search prefetches the descendants several levels ahead, so
+ * lookups on large data sets stall far less on memory than a binary search over the sorted order.
+ * The search loop contains no data-dependent branches.
+ *
+ * Use this for read-mostly data that is loaded once and then only searched, e.g. after filling a
+ * util::sorted_vector. The elements cannot be modified or iterated in sorted order.
+ *
+ * @snippet test/frozen_sorted.test.cpp frozen_sorted_ctor_sorted
+ * @tparam T the type of the stored elements
+ * @tparam Compare A comparison function object which returns true if the first argument is less
+ * than (i.e. is ordered before) the second. Must be the same ordering the input is sorted by.
+ */
+template <class T, class Compare = std::less<T>>
+class frozen_sorted {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reference = const value_type&;
+    using const_pointer = const value_type*;
+
+    frozen_sorted() = default;
+
+    template <class Container>
+    explicit frozen_sorted(const sorted<Container, Compare>& elements);
+    template <class ForwardIt>
+    frozen_sorted(ForwardIt first, ForwardIt last);
+
+    // capacity and size
+
+    auto empty() const noexcept -> bool;
+    auto size() const noexcept -> size_type;
+
+    // lookup
+
+    auto lower_bound(const_reference value) const -> const_pointer;
+    auto find(const_reference value) const -> const_pointer;
+    auto contains(const_reference value) const -> bool;
+
+private:
+    // number of elements fitting into one 64 byte cache line, used as the prefetch distance
+    static constexpr size_type block = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+
+    Compare comp = Compare();
+    std::vector<T> elements{};  // index 0 is unused, the tree root is at index 1
+
+    template <class ForwardIt>
+    auto build(ForwardIt& it, size_type k) -> void;
+};
+
+/**
+ * Freezes a sorted container into a search-optimized layout.
+ *
+ * @snippet test/frozen_sorted.test.cpp frozen_sorted_freeze
+ * @param elements the sorted container to copy the elements from
+ * @return a frozen copy of the given elements
+ */
+template <class Container, class Compare>
+auto freeze(const sorted<Container, Compare>& elements)
+    -> frozen_sorted<typename Container::value_type, Compare> {
+    return frozen_sorted<typename Container::value_type, Compare>(elements);
+}
+
+/**
+ * Constructs a frozen copy of the elements of a sorted container.
+ *
+ * @snippet test/frozen_sorted.test.cpp frozen_sorted_ctor_sorted
+ * @param elements the sorted container to copy the elements from
+ */
+template <class T, class Compare>
+template <class Container>
+frozen_sorted<T, Compare>::frozen_sorted(const sorted<Container, Compare>& elements)
+    : frozen_sorted(elements.begin(), elements.end()) {}
+
+/**
+ * Constructs a frozen copy of a range of elements which is already sorted by Compare.
+ *
+ * @snippet test/frozen_sorted.test.cpp frozen_sorted_ctor_iter
+ * @tparam ForwardIt the type of the forward iterator
+ * @param first the beginning of the sorted range of elements
+ * @param last the end of the sorted range of elements
+ */
+template <class T, class Compare>
+template <class ForwardIt>
+frozen_sorted<T, Compare>::frozen_sorted(ForwardIt first, ForwardIt last) {
+    const auto count = static_cast<size_type>(std::distance(first, last));
+    if (count == 0) {
+        return;
+    }
+
+    elements.assign(count + 1, *first);  // index 0 is only a placeholder
+    build(first, 1);
+}
+
+/**
+ * Fills the implicit tree in-order, so the sorted input ends up in breadth-first order.
+ */
+template <class T, class Compare>
+template <class ForwardIt>
+auto frozen_sorted<T, Compare>::build(ForwardIt& it, size_type k) -> void {
+    if (k < elements.size()) {
+        build(it, 2 * k);
+        elements[k] = *it;
+        ++it;
+        build(it, 2 * k + 1);
+    }
+}
+
+/**
+ * Checks if this frozen container has no elements.
+ *
+ * @return true if there are no elements, otherwise false
+ */
+template <class T, class Compare>
+auto frozen_sorted<T, Compare>::empty() const noexcept -> bool {
+    return elements.empty();
+}
+
+/**
+ * Returns the count of elements in this frozen container.
+ *
+ * @return the number of contained elements
+ */
+template <class T, class Compare>
+auto frozen_sorted<T, Compare>::size() const noexcept -> size_type {
+    return elements.empty() ? 0 : elements.size() - 1;
+}
+
+/**
+ * Searches the first element that is not ordered before the given value.
+ *
+ * @snippet test/frozen_sorted.test.cpp frozen_sorted_lower_bound
+ * @param value the value to compare the elements to
+ * @return a pointer to the first element not less than value or nullptr if there is none
+ */
+template <class T, class Compare>
+auto frozen_sorted<T, Compare>::lower_bound(const_reference value) const -> const_pointer {
+    const auto count = size();
+    const auto* const base = elements.data();
+
+    // the descendants of the last levels lie past the end, which must not even be addressed, so
+    // only the levels above are prefetched and the rest of the path is searched without
+    const auto prefetched = (count + 1) / block;
+    size_type k = 1;
+    while (k < prefetched) {
+        detail::prefetch(base + k * block);
+        k = 2 * k + static_cast<size_type>(comp(base[k], value));
+    }
+    while (k <= count) {
+        k = 2 * k + static_cast<size_type>(comp(base[k], value));
+    }
+
+    // the path went right every time after the last left turn, which was at the answer
+    k >>= detail::trailing_ones(k) + 1;
+    return k == 0 ? nullptr : base + k;
+}
+
+/**
+ * Searches an element equivalent to the given value.
+ *
+ * @snippet test/frozen_sorted.test.cpp frozen_sorted_find
+ * @param value the value to search for
+ * @return a pointer to an equivalent element or nullptr if there is none
+ */
+template <class T, class Compare>
+auto frozen_sorted<T, Compare>::find(const_reference value) const -> const_pointer {
+    const auto* const found = lower_bound(value);
+    return found != nullptr && !comp(value, *found) ? found : nullptr;
+}
+
+/**
+ * Checks if there is an element equivalent to the given value.
+ *
+ * @param value the value to search for
+ * @return true if there is an equivalent element, otherwise false
+ */
+template <class T, class Compare>
+auto frozen_sorted<T, Compare>::contains(const_reference value) const -> bool {
+    return find(value) != nullptr;
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_FROZEN_SORTED_HEADER_IS_ALREADY_INCLUDED
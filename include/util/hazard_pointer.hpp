@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_HAZARD_POINTER_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_HAZARD_POINTER_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "reclamation_domain.hpp"
+
+namespace util {
+
+/**
+ * A domain of hazard pointers for safe memory reclamation in lock-free data structures.
+ *
+ * Readers protect the object they are about to access with a util::hazard_pointer, writers retire
+ * objects they unlinked instead of deleting them. Retired objects are collected in a list which is
+ * scanned in batches: once it grows beyond twice the number of hazard pointers (and at least
+ * min_batch), all objects not protected by any hazard pointer are reclaimed by their deleters.
+ * Reading takes no reference counting, only a write to a slot which is exclusive to the reader.
+ *
+ * Hazard pointer slots are padded to a cache line each and are reused once released, they are
+ * freed with the domain. Most code uses the process-wide domain returned by global().
+ *
+ * @code{.cpp}
+ * std::atomic<config*> current{new config()};
+ * // reader
+ * util::hazard_pointer hazard;
+ * const config* loaded = hazard.protect(current);
+ * // writer
+ * util::hazard_domain::global().retire(current.exchange(new config()));
+ * @endcode
+ */
+class hazard_domain : public detail::reclamation_domain<hazard_domain, const void*> {
+public:
+    static constexpr std::size_t min_batch = 64;
+
+    template <class T, class Deleter = std::default_delete<T>>
+    void retire(T* ptr, Deleter deleter = Deleter());
+    void reclaim();
+};
+
+/**
+ * A hazard pointer of the calling thread, i.e. a slot in which the thread announces the object it
+ * accesses so that it is not reclaimed meanwhile. A hazard pointer protects one object at a time
+ * and should be kept by one thread only, hand-over-hand traversals use two of them.
+ *
+ * Hazard pointers of the global domain are cached per thread, so constructing one usually takes no
+ * synchronization.
+ */
+class hazard_pointer {
+public:
+    explicit hazard_pointer(hazard_domain& domain = hazard_domain::global());
+    hazard_pointer(const hazard_pointer&) = delete;
+    auto operator=(const hazard_pointer&) -> hazard_pointer& = delete;
+    ~hazard_pointer();
+
+    template <class T>
+    auto protect(const std::atomic<T*>& source) noexcept -> T*;
+    template <class T>
+    auto try_protect(T*& ptr, const std::atomic<T*>& source) noexcept -> bool;
+    void reset_protection(const void* ptr = nullptr) noexcept;
+    void swap(hazard_pointer& other) noexcept;
+
+private:
+    using slot_cache = detail::slot_cache<hazard_domain>;
+
+    hazard_domain* domain;
+    slot_cache::slot* owned;
+};
+
+/**
+ * Retires an object which was unlinked from all shared data and will be reclaimed by calling the
+ * given deleter as soon as no hazard pointer protects it anymore, e.g. the deleter of a
+ * util::scoped or util::shared instance which gave up the object.
+ *
+ * @tparam T the type of the object
+ * @tparam Deleter the type of the deleter, callable with the pointer
+ * @param ptr the object to retire
+ * @param deleter the deleter reclaiming the object
+ */
+template <class T, class Deleter>
+void hazard_domain::retire(T* ptr, Deleter deleter) {
+    if (!ptr) {
+        return;
+    }
+
+    this->add_retired(ptr, std::move(deleter), ptr);
+
+    const auto threshold = std::max(min_batch, 2 * this->slot_count());
+    if (this->retired_count() >= threshold) {
+        this->reclaim();
+    }
+}
+
+/**
+ * Scans all hazard pointers of the domain and reclaims all retired objects not protected by any of
+ * them. Protected objects stay retired until a later scan.
+ */
+inline void hazard_domain::reclaim() {
+    auto* list = this->take();
+    if (!list) {
+        return;
+    }
+
+    // the objects were unlinked before being retired, so hazards announced from now on cannot
+    // point to them anymore, the fence orders the unlinking before reading the hazards
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::vector<const void*> hazards;
+    for (auto* s = this->first_slot(); s; s = s->next) {
+        if (const auto* ptr = s->announced.load()) {
+            hazards.push_back(ptr);
+        }
+    }
+    std::sort(hazards.begin(), hazards.end());
+
+    this->sweep(list, [&hazards](const retired& object) {
+        return std::binary_search(hazards.begin(), hazards.end(), object.stamp);
+    });
+}
+
+/**
+ * Constructs a hazard pointer protecting nothing yet.
+ *
+ * @param domain the domain whose retired objects the hazard pointer protects
+ */
+inline hazard_pointer::hazard_pointer(hazard_domain& domain)
+    : domain(&domain), owned(slot_cache::acquire(domain)) {}
+
+/**
+ * Clears the protection and releases the slot, slots of the global domain are kept by the thread.
+ */
+inline hazard_pointer::~hazard_pointer() {
+    slot_cache::release(*this->domain, this->owned);
+}
+
+/**
+ * Protects the object the given source currently points to. The announcement is repeated until the
+ * source still points to the announced object afterwards, so that writers which unlink the object
+ * later see the announcement before they reclaim it.
+ *
+ * @param source the atomic pointer to the object to protect
+ * @return the protected object, which stays valid until the protection is reset
+ */
+template <class T>
+auto hazard_pointer::protect(const std::atomic<T*>& source) noexcept -> T* {
+    auto* ptr = source.load(std::memory_order_relaxed);
+    while (!this->try_protect(ptr, source)) {
+    }
+    return ptr;
+}
+
+/**
+ * Protects the given object if the given source still points to it after announcing it.
+ *
+ * @param ptr the object to protect, receives the current object of the source on failure
+ * @param source the atomic pointer which has to point to the object
+ * @return true if the object is protected or false if the source changed
+ */
+template <class T>
+auto hazard_pointer::try_protect(T*& ptr, const std::atomic<T*>& source) noexcept -> bool {
+    this->owned->announced.store(ptr);
+    auto* current = source.load();
+    if (current == ptr) {
+        return true;
+    }
+
+    this->owned->announced.store(nullptr, std::memory_order_release);
+    ptr = current;
+    return false;
+}
+
+/**
+ * Protects the given object without validation or ends the protection with a nullpointer. The
+ * caller has to make sure that the object was not retired before this call, e.g. because it is
+ * reachable through another protected object.
+ *
+ * @param ptr the object to protect or a nullpointer
+ */
+inline void hazard_pointer::reset_protection(const void* ptr) noexcept {
+    this->owned->announced.store(ptr);
+}
+
+/**
+ * Exchanges the slots and thus the protected objects of two hazard pointers.
+ *
+ * @param other another hazard pointer
+ */
+inline void hazard_pointer::swap(hazard_pointer& other) noexcept {
+    std::swap(this->domain, other.domain);
+    std::swap(this->owned, other.owned);
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_HAZARD_POINTER_HEADER_IS_ALREADY_INCLUDED
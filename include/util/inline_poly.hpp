@@ -0,0 +1,312 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_INLINE_POLY_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_INLINE_POLY_HEADER_IS_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace util {
+
+namespace detail {
+
+/**
+ * The manually built table of type-specific operations of an object held by util::inline_poly,
+ * one per stored type and storage kind.
+ */
+template <class Base>
+struct inline_poly_operations {
+    // move-constructs the object of source into target, destroys the source and returns the moved
+    Base* (*relocate)(void* target, void* source) noexcept;
+    void (*destroy)(void* storage) noexcept;
+};
+
+/**
+ * Operations for objects constructed in the internal storage.
+ */
+template <class Base, class Derived>
+struct inline_poly_inplace {
+    static auto relocate(void* target, void* source) noexcept -> Base* {
+        auto* moved = std::launder(static_cast<Derived*>(source));
+        auto* constructed = ::new (target) Derived(std::move(*moved));
+        moved->~Derived();
+        return constructed;
+    }
+
+    static void destroy(void* storage) noexcept {
+        std::launder(static_cast<Derived*>(storage))->~Derived();
+    }
+
+    static constexpr inline_poly_operations<Base> table = {&relocate, &destroy};
+};
+
+/**
+ * Operations for objects allocated on the heap, the internal storage holds their pointer.
+ */
+template <class Base, class Derived>
+struct inline_poly_allocated {
+    static auto relocate(void* target, void* source) noexcept -> Base* {
+        return *::new (target) Derived*(*std::launder(static_cast<Derived**>(source)));
+    }
+
+    static void destroy(void* storage) noexcept {
+        delete *std::launder(static_cast<Derived**>(storage));
+    }
+
+    static constexpr inline_poly_operations<Base> table = {&relocate, &destroy};
+};
+
+}  // namespace detail
+
+/**
+ * A polymorphic object of any type derived from Base stored inside this instance instead of on
+ * the heap, i.e. a util::scoped<Base> without allocation and with the object next to its handle.
+ *
+ * Types which do not fit into Size bytes aligned at Align, or whose move constructor may throw,
+ * are rejected at compile time, unless HeapFallback is enabled to allocate them with `new`.
+ * Moving an instance moves the stored object through a small table of functions built for its
+ * type, so Base needs neither a virtual destructor nor a virtual move. Calls go straight to the
+ * virtual functions of the object.
+ *
+ * @code{.cpp}
+ * util::inline_poly<handler, 32> current(std::in_place_type<logging_handler>, "app.log");
+ * current->handle(event);
+ * @endcode
+ *
+ * @tparam Base the base class of the stored objects
+ * @tparam Size the number of bytes of the internal storage
+ * @tparam Align the alignment of the internal storage
+ * @tparam HeapFallback true to allocate objects which do not fit on the heap
+ */
+template <class Base, std::size_t Size, std::size_t Align = alignof(std::max_align_t),
+          bool HeapFallback = false>
+class inline_poly {
+public:
+    using element_type = Base;
+
+    /**
+     * Checks if objects of the given type are stored in the internal storage.
+     */
+    template <class Derived>
+    static constexpr bool fits = sizeof(Derived) <= Size && Align % alignof(Derived) == 0 &&
+                                 std::is_nothrow_move_constructible<Derived>::value;
+
+    inline_poly() noexcept;
+    inline_poly(std::nullptr_t) noexcept;
+    template <class Derived, class... Args>
+    explicit inline_poly(std::in_place_type_t<Derived> type, Args&&... args);
+    template <class Derived, class = std::enable_if_t<
+                                 !std::is_same<std::decay_t<Derived>, inline_poly>::value &&
+                                 std::is_base_of<Base, std::decay_t<Derived>>::value>>
+    inline_poly(Derived&& object);
+    inline_poly(inline_poly&& other) noexcept;
+    inline_poly(const inline_poly&) = delete;
+    ~inline_poly();
+
+    auto operator=(inline_poly&& other) noexcept -> inline_poly&;
+    auto operator=(const inline_poly&) -> inline_poly& = delete;
+
+    template <class Derived, class... Args>
+    auto emplace(Args&&... args) -> Derived&;
+
+    auto operator->() const noexcept -> Base*;
+    auto operator*() const noexcept -> Base&;
+    explicit operator bool() const noexcept;
+
+    auto get() const noexcept -> Base*;
+    void reset() noexcept;
+    void swap(inline_poly& other) noexcept;
+
+private:
+    static_assert(Size >= sizeof(void*) || !HeapFallback,
+                  "the storage has to hold a pointer for the heap fallback");
+
+    alignas(Align) unsigned char storage[Size];
+    const detail::inline_poly_operations<Base>* operations = nullptr;
+    Base* object = nullptr;
+};
+
+/**
+ * Constructs an empty instance, the storage is left uninitialized.
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+inline_poly<Base, Size, Align, HeapFallback>::inline_poly() noexcept {}
+
+/**
+ * Constructs an empty instance from a nullpointer.
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+inline_poly<Base, Size, Align, HeapFallback>::inline_poly(std::nullptr_t) noexcept
+    : inline_poly() {}
+
+/**
+ * Constructs an object of the given type with the given arguments.
+ *
+ * @tparam Derived the type of the object, derived from Base
+ * @param type the tag selecting the type of the object
+ * @param args the arguments for the constructor of Derived
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+template <class Derived, class... Args>
+inline_poly<Base, Size, Align, HeapFallback>::inline_poly(std::in_place_type_t<Derived> /*type*/,
+                                                          Args&&... args) {
+    this->template emplace<Derived>(std::forward<Args>(args)...);
+}
+
+/**
+ * Constructs an object by moving or copying the given object of a derived type.
+ *
+ * @param object the object to move or copy
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+template <class Derived, class>
+inline_poly<Base, Size, Align, HeapFallback>::inline_poly(Derived&& object) {
+    this->template emplace<std::decay_t<Derived>>(std::forward<Derived>(object));
+}
+
+/**
+ * Moves the object of another instance into this one, the other instance is left empty.
+ *
+ * @param other another instance
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+inline_poly<Base, Size, Align, HeapFallback>::inline_poly(inline_poly&& other) noexcept
+    : operations(other.operations) {
+    if (this->operations) {
+        this->object = this->operations->relocate(this->storage, other.storage);
+        other.operations = nullptr;
+        other.object = nullptr;
+    }
+}
+
+/**
+ * Destroys the object, if any.
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+inline_poly<Base, Size, Align, HeapFallback>::~inline_poly() {
+    this->reset();
+}
+
+/**
+ * Destroys the current object and moves the object of another instance into this one, the other
+ * instance is left empty.
+ *
+ * @return a reference to this instance
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+auto inline_poly<Base, Size, Align, HeapFallback>::operator=(inline_poly&& other) noexcept
+    -> inline_poly& {
+    if (this != &other) {
+        this->reset();
+        if (other.operations) {
+            this->object = other.operations->relocate(this->storage, other.storage);
+            this->operations = std::exchange(other.operations, nullptr);
+            other.object = nullptr;
+        }
+    }
+
+    return *this;
+}
+
+/**
+ * Destroys the current object and constructs a new one of the given type. The instance is empty
+ * if the constructor throws.
+ *
+ * @tparam Derived the type of the object, derived from Base
+ * @param args the arguments for the constructor of Derived
+ * @return a reference to the new object
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+template <class Derived, class... Args>
+auto inline_poly<Base, Size, Align, HeapFallback>::emplace(Args&&... args) -> Derived& {
+    static_assert(std::is_base_of<Base, Derived>::value, "the type has to derive from Base");
+    static_assert(fits<Derived> || HeapFallback,
+                  "the type does not fit into the storage or may throw when moved");
+
+    this->reset();
+    Derived* constructed = nullptr;
+    if constexpr (fits<Derived>) {
+        constructed =
+            ::new (static_cast<void*>(this->storage)) Derived(std::forward<Args>(args)...);
+        this->operations = &detail::inline_poly_inplace<Base, Derived>::table;
+    } else {
+        constructed = new Derived(std::forward<Args>(args)...);
+        ::new (static_cast<void*>(this->storage)) Derived*(constructed);
+        this->operations = &detail::inline_poly_allocated<Base, Derived>::table;
+    }
+    this->object = constructed;
+
+    return *constructed;
+}
+
+/**
+ * Returns the stored object as its base.
+ *
+ * @return the stored object, i.e., `get()`
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+auto inline_poly<Base, Size, Align, HeapFallback>::operator->() const noexcept -> Base* {
+    return this->object;
+}
+
+/**
+ * Returns the stored object as its base.
+ *
+ * @return the stored object, i.e., `*get()`
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+auto inline_poly<Base, Size, Align, HeapFallback>::operator*() const noexcept -> Base& {
+    return *this->object;
+}
+
+/**
+ * Checks if there is a stored object.
+ *
+ * @return true if there is a stored object or false if the instance is empty
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+inline_poly<Base, Size, Align, HeapFallback>::operator bool() const noexcept {
+    return this->object != nullptr;
+}
+
+/**
+ * Returns the stored object as its base.
+ *
+ * @return a pointer to the stored object or a nullpointer if the instance is empty
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+auto inline_poly<Base, Size, Align, HeapFallback>::get() const noexcept -> Base* {
+    return this->object;
+}
+
+/**
+ * Destroys the stored object, leaving the instance empty.
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+void inline_poly<Base, Size, Align, HeapFallback>::reset() noexcept {
+    if (this->operations) {
+        std::exchange(this->operations, nullptr)->destroy(this->storage);
+        this->object = nullptr;
+    }
+}
+
+/**
+ * Exchanges the stored objects of two instances by moving them.
+ *
+ * @param other another instance
+ */
+template <class Base, std::size_t Size, std::size_t Align, bool HeapFallback>
+void inline_poly<Base, Size, Align, HeapFallback>::swap(inline_poly& other) noexcept {
+    if (this != &other) {
+        inline_poly moved(std::move(other));
+        other = std::move(*this);
+        *this = std::move(moved);
+    }
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_INLINE_POLY_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,261 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_INTRUSIVE_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_INTRUSIVE_HEADER_IS_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <utility>
+
+#include "shared.hpp"
+
+namespace util {
+
+template <class T>
+class intrusive;
+
+/**
+ * The base class for objects managed by util::intrusive, holding their reference counter.
+ *
+ * Copying an object does not copy its counter, the copy starts without owners as a new object.
+ *
+ * @code{.cpp}
+ * struct node : util::intrusive_base<node> {
+ *     util::intrusive<node> left;
+ *     util::intrusive<node> right;
+ * };
+ * @endcode
+ *
+ * @tparam Derived the type of the managed object deriving from this base
+ * @tparam Count the reference counter, util::local_count (the default) or util::atomic_count for
+ *         objects shared between threads
+ */
+template <class Derived, class Count = local_count>
+class intrusive_base {
+public:
+    using count_type = Count;
+
+    auto use_count() const noexcept -> std::size_t { return uses.load(); }
+
+protected:
+    intrusive_base() noexcept = default;
+    intrusive_base(const intrusive_base& /*other*/) noexcept {}
+    auto operator=(const intrusive_base& /*other*/) noexcept -> intrusive_base& { return *this; }
+    ~intrusive_base() = default;
+
+private:
+    template <class T>
+    friend class intrusive;
+
+    mutable Count uses{0};
+};
+
+/**
+ * A reference counted pointer to an object which holds its own counter by deriving from
+ * util::intrusive_base. The handle is a single pointer wide, copies only touch the counter next to
+ * the object, and a handle can be made from any raw pointer to a managed object, e.g. `this`.
+ *
+ * @code{.cpp}
+ * auto root = util::make_intrusive<node>();
+ * root->left = util::make_intrusive<node>();
+ * @endcode
+ *
+ * @tparam T the type of the managed object, deriving from util::intrusive_base<T, Count>
+ */
+template <class T>
+class intrusive {
+public:
+    using element_type = T;
+
+    constexpr intrusive() noexcept = default;
+    constexpr intrusive(std::nullptr_t) noexcept;
+    intrusive(T* ptr) noexcept;
+    intrusive(intrusive&& other) noexcept;
+    intrusive(const intrusive& other) noexcept;
+    ~intrusive();
+
+    auto operator=(intrusive&& other) noexcept -> intrusive&;
+    auto operator=(const intrusive& other) noexcept -> intrusive&;
+
+    auto operator->() const noexcept -> T*;
+    auto operator*() const noexcept -> T&;
+    explicit operator bool() const noexcept;
+
+    auto get() const noexcept -> T*;
+    auto use_count() const noexcept -> std::size_t;
+    void reset() noexcept;
+    void swap(intrusive& other) noexcept;
+
+private:
+    void release() noexcept;
+
+    T* ptr = nullptr;
+};
+
+template <class T, class... Args>
+auto make_intrusive(Args&&... args) -> intrusive<T>;
+
+/**
+ * Constructs an empty intrusive pointer from a nullpointer.
+ */
+template <class T>
+constexpr intrusive<T>::intrusive(std::nullptr_t) noexcept : intrusive() {}
+
+/**
+ * Constructs an intrusive pointer to the given object and increases its reference counter. The
+ * object has to be allocated with `new` and may already be managed by other intrusive pointers.
+ *
+ * @param ptr the object to manage or a nullpointer
+ */
+template <class T>
+intrusive<T>::intrusive(T* ptr) noexcept : ptr(ptr) {
+    if (ptr) {
+        ptr->uses.increment();
+    }
+}
+
+/**
+ * Constructs an intrusive pointer from another moved intrusive pointer, which is unassigned.
+ *
+ * @param other another intrusive pointer
+ */
+template <class T>
+intrusive<T>::intrusive(intrusive&& other) noexcept : ptr(other.ptr) {
+    other.ptr = nullptr;
+}
+
+/**
+ * Constructs an intrusive pointer from another intrusive pointer.
+ *
+ * @param other another intrusive pointer
+ */
+template <class T>
+intrusive<T>::intrusive(const intrusive& other) noexcept : intrusive(other.ptr) {}
+
+/**
+ * Destroys the intrusive pointer and deletes the managed object if this was its last reference.
+ */
+template <class T>
+intrusive<T>::~intrusive() {
+    this->release();
+}
+
+/**
+ * Assigns a moved intrusive pointer, which is unassigned.
+ *
+ * @return a reference to this instance
+ */
+template <class T>
+auto intrusive<T>::operator=(intrusive&& other) noexcept -> intrusive<T>& {
+    intrusive(std::move(other)).swap(*this);
+
+    return *this;
+}
+
+/**
+ * Assigns an intrusive pointer.
+ *
+ * @return a reference to this instance
+ */
+template <class T>
+auto intrusive<T>::operator=(const intrusive& other) noexcept -> intrusive<T>& {
+    intrusive(other).swap(*this);
+
+    return *this;
+}
+
+/**
+ * Returns the stored pointer.
+ *
+ * @return the stored pointer, i.e., `get()`
+ */
+template <class T>
+auto intrusive<T>::operator->() const noexcept -> T* {
+    return this->ptr;
+}
+
+/**
+ * Returns the dereferenced managed object.
+ *
+ * @return the dereferenced stored pointer, i.e., `*get()`
+ */
+template <class T>
+auto intrusive<T>::operator*() const noexcept -> T& {
+    return *this->ptr;
+}
+
+/**
+ * Checks if the stored pointer is not null.
+ *
+ * @return true if the stored pointer is not null or false if it is
+ */
+template <class T>
+intrusive<T>::operator bool() const noexcept {
+    return this->ptr != nullptr;
+}
+
+/**
+ * Returns the stored pointer.
+ *
+ * @return the stored pointer
+ */
+template <class T>
+auto intrusive<T>::get() const noexcept -> T* {
+    return this->ptr;
+}
+
+/**
+ * Returns the number of intrusive pointers managing the current object.
+ *
+ * @return the number of intrusive pointers managing the current object or 0 if there is none
+ */
+template <class T>
+auto intrusive<T>::use_count() const noexcept -> std::size_t {
+    return this->ptr ? this->ptr->uses.load() : 0;
+}
+
+/**
+ * Releases the managed object, leaving this instance empty.
+ */
+template <class T>
+void intrusive<T>::reset() noexcept {
+    intrusive().swap(*this);
+}
+
+/**
+ * Exchanges the managed objects of two intrusive pointers without touching the reference counters.
+ *
+ * @param other another intrusive pointer
+ */
+template <class T>
+void intrusive<T>::swap(intrusive& other) noexcept {
+    std::swap(this->ptr, other.ptr);
+}
+
+/**
+ * Decreases the reference counter and deletes the managed object if this was its last reference.
+ */
+template <class T>
+void intrusive<T>::release() noexcept {
+    if (this->ptr && this->ptr->uses.decrement()) {
+        delete this->ptr;
+    }
+}
+
+/**
+ * Constructs an object of type T and wraps it in a util::intrusive using args as the parameter list
+ * for the constructor of T.
+ *
+ * @tparam T the type of object to construct, deriving from util::intrusive_base
+ * @tparam Args the types of arguments for the constructor of T
+ * @param args a list of arguments with which an instance of T will be constructed
+ * @return an util::intrusive pointer to the new instance of type T
+ */
+template <class T, class... Args>
+auto make_intrusive(Args&&... args) -> intrusive<T> {
+    return intrusive<T>(new T(std::forward<Args>(args)...));
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_INTRUSIVE_HEADER_IS_ALREADY_INCLUDED
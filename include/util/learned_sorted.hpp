@@ -0,0 +1,414 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_LEARNED_SORTED_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_LEARNED_SORTED_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "simd.hpp"
+#include "sorted.hpp"
+
+namespace util {
+
+namespace detail {
+
+// interpolation steps before the rest of the range is searched by bisection
+constexpr std::size_t interpolation_steps = 8;
+
+// ranges this short are searched by bisection right away
+constexpr std::size_t interpolation_cutoff = 16;
+
+/**
+ * Searches the first element not less than the value in a short sorted range, with vector
+ * comparisons if the element type has them.
+ */
+template <class T>
+auto window_lower_bound(const T* first, const T* last, T value) noexcept -> const T* {
+    if constexpr (is_simd_searchable<T>::value) {
+        return simd_lower_bound(first, last, value);
+    } else {
+        return std::lower_bound(first, last, value);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Searches the first element in a sorted range that is not less than the given value, probing
+ * where the value would be if the elements were evenly spaced between the bounds of the range.
+ *
+ * On uniformly distributed keys each probe shrinks the range to about its square root, so a search
+ * takes O(log log n) probes and cache misses instead of the O(log n) of a binary search. After a
+ * few probes the remaining range is bisected, so skewed keys take at most a few probes more than a
+ * binary search.
+ *
+ * @snippet test/learned_sorted.test.cpp interpolation_lower_bound
+ * @tparam T an arithmetic type
+ * @param first the beginning of the range sorted by std::less
+ * @param last the end of the range sorted by std::less
+ * @param value the value to compare the elements to
+ * @return a pointer to the first element not less than value or last if there is none
+ */
+template <class T>
+auto interpolation_lower_bound(const T* first, const T* last, T value) noexcept -> const T* {
+    static_assert(std::is_arithmetic<T>::value, "interpolation needs arithmetic elements");
+
+    // the first element not less than value is always in [first, last]
+    for (std::size_t step = 0; step < detail::interpolation_steps; ++step) {
+        const auto count = static_cast<std::size_t>(last - first);
+        if (count <= detail::interpolation_cutoff) {
+            break;
+        }
+        if (!(*first < value)) {
+            return first;
+        }
+        if (last[-1] < value) {
+            return last;
+        }
+
+        const auto low = static_cast<double>(*first);
+        const auto high = static_cast<double>(last[-1]);
+        const auto fraction = (static_cast<double>(value) - low) / (high - low);
+        const auto offset = fraction > 0 ? std::min(fraction, 1.0) * (count - 1) : 0.0;
+        const auto* const probe = first + static_cast<std::size_t>(offset);
+        if (*probe < value) {
+            first = probe + 1;
+        } else {
+            last = probe;
+        }
+    }
+
+    return detail::window_lower_bound(first, last, value);
+}
+
+/**
+ * An immutable copy of sorted arithmetic elements with a learned index.
+ *
+ * A piecewise linear model maps every key to its position in the sorted elements. The model is
+ * built in one pass at construction: a segment grows as long as a line exists that predicts all of
+ * its keys with an error of at most epsilon positions, so evenly distributed keys need only a few
+ * segments and skewed keys get more of them. The first keys of the segments are indexed the same
+ * way, level by level, until the top level fits into a few cache lines.
+ *
+ * A lookup searches the top level completely, then on every level below predicts the position of
+ * the value and searches a window of 2 * epsilon + 2 keys around it, which spans one or two cache
+ * lines instead of the log2(n) misses of a binary search. If the answer is not in the window, e.g.
+ * because of rounding or long runs of equal keys, the search falls back to a binary search of the
+ * part of the range left or right of the window.
+ *
+ * The elements are kept in sorted order, so they can be iterated like a util::sorted_vector.
+ *
+ * @snippet test/learned_sorted.test.cpp learned_sorted
+ * @tparam T an arithmetic type, ordered by std::less
+ */
+template <class T>
+class learned_sorted {
+    static_assert(std::is_arithmetic<T>::value, "the learned index needs arithmetic elements");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reference = const value_type&;
+    using const_pointer = const value_type*;
+    using const_iterator = const_pointer;
+
+    // a window of 2 * 16 + 2 four byte keys spans about two cache lines
+    static constexpr size_type default_epsilon = 16;
+
+    learned_sorted() = default;
+
+    template <class Container>
+    explicit learned_sorted(const sorted<Container, std::less<T>>& elements,
+                            size_type epsilon = default_epsilon);
+    template <class ForwardIt>
+    learned_sorted(ForwardIt first, ForwardIt last, size_type epsilon = default_epsilon);
+
+    // capacity and size
+
+    auto empty() const noexcept -> bool;
+    auto size() const noexcept -> size_type;
+    auto epsilon() const noexcept -> size_type;
+    auto segment_count() const noexcept -> size_type;
+
+    // lookup
+
+    auto lower_bound(value_type value) const noexcept -> const_iterator;
+    auto find(value_type value) const noexcept -> const_iterator;
+    auto contains(value_type value) const noexcept -> bool;
+    auto rank(value_type value) const noexcept -> size_type;
+
+    // iterators
+
+    auto begin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+
+private:
+    // the top level is searched completely, 64 keys span four to eight cache lines
+    static constexpr size_type top_size = 64;
+
+    struct segment {
+        double slope;
+        size_type position;  // the position of the first key of the segment on the level below
+    };
+
+    struct level {
+        std::vector<T> keys;  // the first key of every segment, searched separately to stay compact
+        std::vector<segment> segments;
+    };
+
+    size_type error = default_epsilon;
+    std::vector<T> elements;
+    std::vector<level> levels;  // levels[0] indexes the elements, each level the keys of the last
+
+    static auto fit(const T* data, size_type count, size_type epsilon) -> level;
+    static auto predict(const level& model, size_type index, size_type count, value_type value)
+        -> size_type;
+    auto search(const T* data, size_type count, size_type predicted, value_type value) const
+        -> size_type;
+};
+
+/**
+ * Builds a learned index over a copy of a sorted container.
+ *
+ * @snippet test/learned_sorted.test.cpp learned_sorted
+ * @param elements the sorted container to copy the elements from
+ * @param epsilon the maximum distance of a predicted position to the actual position of a key
+ * @return a copy of the given elements with a learned index
+ */
+template <class Container>
+auto learn(const sorted<Container, std::less<typename Container::value_type>>& elements,
+           std::size_t epsilon = learned_sorted<typename Container::value_type>::default_epsilon)
+    -> learned_sorted<typename Container::value_type> {
+    return learned_sorted<typename Container::value_type>(elements, epsilon);
+}
+
+/**
+ * Constructs a copy of the elements of a sorted container with a learned index.
+ *
+ * @param elements the sorted container to copy the elements from
+ * @param epsilon the maximum distance of a predicted position to the actual position of a key
+ */
+template <class T>
+template <class Container>
+learned_sorted<T>::learned_sorted(const sorted<Container, std::less<T>>& elements,
+                                  size_type epsilon)
+    : learned_sorted(elements.begin(), elements.end(), epsilon) {}
+
+/**
+ * Constructs a copy of a range of elements which is already sorted by std::less with a learned
+ * index.
+ *
+ * @tparam ForwardIt the type of the forward iterator
+ * @param first the beginning of the sorted range of elements
+ * @param last the end of the sorted range of elements
+ * @param epsilon the maximum distance of a predicted position to the actual position of a key
+ */
+template <class T>
+template <class ForwardIt>
+learned_sorted<T>::learned_sorted(ForwardIt first, ForwardIt last, size_type epsilon)
+    : error(epsilon), elements(first, last) {
+    if (elements.empty()) {
+        return;
+    }
+
+    levels.push_back(fit(elements.data(), elements.size(), error));
+    while (levels.back().keys.size() > top_size) {
+        const auto& below = levels.back().keys;
+        levels.push_back(fit(below.data(), below.size(), error));
+    }
+}
+
+template <class T>
+auto learned_sorted<T>::empty() const noexcept -> bool {
+    return elements.empty();
+}
+
+template <class T>
+auto learned_sorted<T>::size() const noexcept -> size_type {
+    return elements.size();
+}
+
+/**
+ * Returns the maximum distance of a predicted position to the actual position of a key.
+ *
+ * @return the error bound the model was built with
+ */
+template <class T>
+auto learned_sorted<T>::epsilon() const noexcept -> size_type {
+    return error;
+}
+
+/**
+ * Returns the number of linear segments of the model over the elements, a measure of how evenly
+ * the keys are distributed.
+ *
+ * @return the number of segments, 0 if there are no elements
+ */
+template <class T>
+auto learned_sorted<T>::segment_count() const noexcept -> size_type {
+    return levels.empty() ? 0 : levels.front().segments.size();
+}
+
+/**
+ * Searches the first element that is not less than the given value.
+ *
+ * @snippet test/learned_sorted.test.cpp learned_sorted
+ * @param value the value to compare the elements to
+ * @return an iterator to the first element not less than value or end() if there is none
+ */
+template <class T>
+auto learned_sorted<T>::lower_bound(value_type value) const noexcept -> const_iterator {
+    if (elements.empty()) {
+        return end();
+    }
+
+    // the segment with the last key not greater than value, or the first segment
+    const auto& top = levels.back().keys;
+    auto index = static_cast<size_type>(
+        detail::window_lower_bound(top.data(), top.data() + top.size(), value) - top.data());
+    for (auto model = levels.size(); model-- > 0;) {
+        const auto& keys = levels[model].keys;
+        if ((index == keys.size() || value < keys[index]) && index > 0) {
+            --index;
+        }
+
+        const auto* const data = model == 0 ? elements.data() : levels[model - 1].keys.data();
+        const auto count = model == 0 ? elements.size() : levels[model - 1].keys.size();
+        index = search(data, count, predict(levels[model], index, count, value), value);
+    }
+    return elements.data() + index;
+}
+
+/**
+ * Searches an element equal to the given value.
+ *
+ * @param value the value to search for
+ * @return an iterator to the first equal element or end() if there is none
+ */
+template <class T>
+auto learned_sorted<T>::find(value_type value) const noexcept -> const_iterator {
+    const auto it = lower_bound(value);
+    return it != end() && !(value < *it) ? it : end();
+}
+
+/**
+ * Checks if there is an element equal to the given value.
+ *
+ * @param value the value to search for
+ * @return true if there is an equal element, otherwise false
+ */
+template <class T>
+auto learned_sorted<T>::contains(value_type value) const noexcept -> bool {
+    return find(value) != end();
+}
+
+/**
+ * Counts the elements less than the given value.
+ *
+ * @param value the value to compare the elements to
+ * @return the number of elements less than value, i.e. the position of lower_bound(value)
+ */
+template <class T>
+auto learned_sorted<T>::rank(value_type value) const noexcept -> size_type {
+    return static_cast<size_type>(lower_bound(value) - begin());
+}
+
+template <class T>
+auto learned_sorted<T>::begin() const noexcept -> const_iterator {
+    return elements.data();
+}
+
+template <class T>
+auto learned_sorted<T>::end() const noexcept -> const_iterator {
+    return elements.data() + elements.size();
+}
+
+/**
+ * Fits the segments of one level with the shrinking cone algorithm: all slopes keeping the keys of
+ * the current segment within the error bound form a cone around the first key of the segment.
+ * Every further key narrows the cone, a key outside the cone starts a new segment. Only the first
+ * of equal keys is fitted, lower_bound never returns a later one.
+ */
+template <class T>
+auto learned_sorted<T>::fit(const T* data, size_type count, size_type epsilon) -> level {
+    constexpr auto unbounded = std::numeric_limits<double>::infinity();
+    const auto error = static_cast<double>(epsilon);
+
+    level fitted;
+    size_type start = 0;
+    auto min_slope = 0.0;
+    auto max_slope = unbounded;
+    const auto close = [&] {
+        fitted.keys.push_back(data[start]);
+        fitted.segments.push_back(
+            {max_slope == unbounded ? 0.0 : (min_slope + max_slope) / 2, start});
+    };
+
+    for (size_type i = 1; i < count; ++i) {
+        if (!(data[i - 1] < data[i])) {
+            continue;
+        }
+
+        const auto dx = static_cast<double>(data[i]) - static_cast<double>(data[start]);
+        const auto dy = static_cast<double>(i - start);
+        const auto low = (dy - error) / dx;
+        const auto high = (dy + error) / dx;
+        if (!(dx > 0) || low > max_slope || high < min_slope) {
+            close();
+            start = i;
+            min_slope = 0.0;
+            max_slope = unbounded;
+        } else {
+            min_slope = std::max(min_slope, low);
+            max_slope = std::min(max_slope, high);
+        }
+    }
+    close();
+    return fitted;
+}
+
+/**
+ * Predicts the position of the first key not less than the value on the level below a segment,
+ * clamped to the positions covered by the segment.
+ */
+template <class T>
+auto learned_sorted<T>::predict(const level& model, size_type index, size_type count,
+                                value_type value) -> size_type {
+    const auto& fitted = model.segments[index];
+    const auto next =
+        index + 1 < model.segments.size() ? model.segments[index + 1].position : count;
+    const auto offset =
+        fitted.slope * (static_cast<double>(value) - static_cast<double>(model.keys[index]));
+    const auto span = static_cast<double>(next - fitted.position);
+    return fitted.position + static_cast<size_type>(offset > 0 ? std::min(offset, span) : 0.0);
+}
+
+/**
+ * Searches the first key not less than the value in the window around a predicted position,
+ * falling back to a binary search left or right of the window if the answer is outside.
+ */
+template <class T>
+auto learned_sorted<T>::search(const T* data, size_type count, size_type predicted,
+                               value_type value) const -> size_type {
+    const auto low = predicted > error ? predicted - error : 0;
+    const auto high = std::min(predicted + error + 2, count);
+
+    const auto* found = detail::window_lower_bound(data + low, data + high, value);
+    if (found == data + low && low > 0 && !(data[low - 1] < value)) {
+        found = std::lower_bound(data, data + low, value);
+    } else if (found == data + high && high < count) {
+        found = std::lower_bound(data + high, data + count, value);
+    }
+    return static_cast<size_type>(found - data);
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_LEARNED_SORTED_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,331 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_MAPPED_FILE_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_MAPPED_FILE_HEADER_IS_ALREADY_INCLUDED
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "scoped_fd.hpp"
+
+namespace util {
+
+/**
+ * A file mapped into memory which is unmapped when leaving the scope, for reading and writing files
+ * in place without copying them through buffers.
+ *
+ * The mapping is shared with the page cache, so writes to a read-write mapping end up in the file
+ * and all processes mapping the same file see the same pages. Pages are read on first access
+ * unless the mapping is populated up front. Access pattern hints and huge pages only tune the
+ * paging and are ignored where the system does not support them. Empty files are mapped as empty.
+ *
+ * @code{.cpp}
+ * util::mapped_file::options options;
+ * options.hint = util::mapped_file::advice::sequential;
+ * const util::mapped_file log("journal.bin", options);
+ * std::count(log.data(), log.data() + log.size(), '\n');
+ * @endcode
+ */
+class mapped_file {
+public:
+    enum class access { read_only, read_write };
+    enum class advice { normal, sequential, random, willneed };
+
+    struct options {
+        access mode = access::read_only;
+        advice hint = advice::normal;
+        bool populate = false;    // reads all pages while mapping (MAP_POPULATE)
+        bool huge_pages = false;  // backs the mapping with transparent huge pages if possible
+    };
+
+    constexpr mapped_file() noexcept = default;
+    explicit mapped_file(const std::string& path);
+    mapped_file(const std::string& path, const options& opts);
+    mapped_file(const scoped_fd& file, const options& opts);
+    mapped_file(mapped_file&& other) noexcept;
+    auto operator=(mapped_file&& other) noexcept -> mapped_file&;
+    mapped_file(const mapped_file&) = delete;
+    auto operator=(const mapped_file&) -> mapped_file& = delete;
+    ~mapped_file();
+
+    static auto create(const std::string& path, std::size_t size) -> mapped_file;
+    static auto create(const std::string& path, std::size_t size, const options& opts)
+        -> mapped_file;
+
+    auto data() noexcept -> char*;
+    auto data() const noexcept -> const char*;
+    auto size() const noexcept -> std::size_t;
+    auto empty() const noexcept -> bool;
+    auto writable() const noexcept -> bool;
+
+    void advise(advice hint) const;
+    void advise(advice hint, std::size_t offset, std::size_t length) const;
+    void sync() const;
+    void reset() noexcept;
+    void swap(mapped_file& other) noexcept;
+
+private:
+    static auto flag(advice hint) noexcept -> int;
+
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+    bool read_write = false;
+};
+
+/**
+ * Maps a whole file for reading.
+ *
+ * @param path the path of the file
+ * @throw std::system_error if the file cannot be opened or mapped
+ */
+inline mapped_file::mapped_file(const std::string& path) : mapped_file(path, options()) {}
+
+/**
+ * Maps a whole file for reading or reading and writing.
+ *
+ * @param path the path of the file
+ * @param opts the access mode and paging options
+ * @throw std::system_error if the file cannot be opened or mapped
+ */
+inline mapped_file::mapped_file(const std::string& path, const options& opts)
+    : mapped_file(scoped_fd::open(path, opts.mode == access::read_write ? O_RDWR : O_RDONLY),
+                  opts) {}
+
+/**
+ * Maps the whole file of an open file descriptor, which has to be opened with matching access
+ * rights. The mapping stays valid after the descriptor is closed.
+ *
+ * @param file the file descriptor of the file
+ * @param opts the access mode and paging options
+ * @throw std::system_error if the file cannot be mapped
+ */
+inline mapped_file::mapped_file(const scoped_fd& file, const options& opts)
+    : read_write(opts.mode == access::read_write) {
+    const auto bytes = file.size();
+    if (bytes == 0) {
+        return;
+    }
+
+    auto flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    flags |= opts.populate ? MAP_POPULATE : 0;
+#endif
+    auto* mapped = ::mmap(nullptr, bytes, this->read_write ? PROT_READ | PROT_WRITE : PROT_READ,
+                          flags, file.get(), 0);
+    if (mapped == MAP_FAILED) {  // NOLINT
+        throw std::system_error(errno, std::generic_category(), "cannot map file");
+    }
+    this->mapping = mapped;
+    this->mapping_size = bytes;
+
+    // hints do not change the contents, so failing to apply them is not an error
+#ifdef MADV_HUGEPAGE
+    if (opts.huge_pages) {
+        ::madvise(this->mapping, this->mapping_size, MADV_HUGEPAGE);
+    }
+#endif
+    if (opts.hint != advice::normal) {
+        ::madvise(this->mapping, this->mapping_size, flag(opts.hint));
+    }
+}
+
+/**
+ * Takes over the mapping of another instance, which is left empty.
+ *
+ * @param other another mapped file
+ */
+inline mapped_file::mapped_file(mapped_file&& other) noexcept
+    : mapping(std::exchange(other.mapping, nullptr)),
+      mapping_size(std::exchange(other.mapping_size, 0)),
+      read_write(std::exchange(other.read_write, false)) {}
+
+/**
+ * Unmaps the current file and takes over the mapping of another instance, which is left empty.
+ *
+ * @param other another mapped file
+ * @return a reference to this instance
+ */
+inline auto mapped_file::operator=(mapped_file&& other) noexcept -> mapped_file& {
+    mapped_file(std::move(other)).swap(*this);
+
+    return *this;
+}
+
+/**
+ * Unmaps the file. Writes to a read-write mapping reach the file with the page cache, call sync()
+ * before to write them to the storage.
+ */
+inline mapped_file::~mapped_file() {
+    this->reset();
+}
+
+/**
+ * Creates or truncates a file of the given size and maps it for reading and writing, e.g. for
+ * journals written in place. New bytes are zero.
+ *
+ * @param path the path of the file
+ * @param size the size of the file in bytes
+ * @return the mapped file
+ * @throw std::system_error if the file cannot be created, resized or mapped
+ */
+inline auto mapped_file::create(const std::string& path, std::size_t size) -> mapped_file {
+    return create(path, size, options());
+}
+
+/**
+ * Creates or truncates a file of the given size and maps it with the given paging options.
+ *
+ * @param path the path of the file
+ * @param size the size of the file in bytes
+ * @param opts the paging options, the access mode is always read-write
+ * @return the mapped file
+ * @throw std::system_error if the file cannot be created, resized or mapped
+ */
+inline auto mapped_file::create(const std::string& path, std::size_t size, const options& opts)
+    -> mapped_file {
+    const auto file = scoped_fd::open(path, O_RDWR | O_CREAT);
+    if (::ftruncate(file.get(), static_cast<off_t>(size)) != 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot resize " + path);
+    }
+
+    auto writable = opts;
+    writable.mode = access::read_write;
+    return mapped_file(file, writable);
+}
+
+/**
+ * Returns the mapped bytes, which may only be written to with a read-write mapping.
+ *
+ * @return the first mapped byte or a nullpointer if nothing is mapped
+ */
+inline auto mapped_file::data() noexcept -> char* {
+    return static_cast<char*>(this->mapping);
+}
+
+/**
+ * Returns the mapped bytes.
+ *
+ * @return the first mapped byte or a nullpointer if nothing is mapped
+ */
+inline auto mapped_file::data() const noexcept -> const char* {
+    return static_cast<const char*>(this->mapping);
+}
+
+/**
+ * Returns the number of mapped bytes, the size of the file when it was mapped.
+ *
+ * @return the number of mapped bytes
+ */
+inline auto mapped_file::size() const noexcept -> std::size_t {
+    return this->mapping_size;
+}
+
+/**
+ * Checks if nothing is mapped.
+ *
+ * @return true if nothing is mapped, otherwise false
+ */
+inline auto mapped_file::empty() const noexcept -> bool {
+    return this->mapping_size == 0;
+}
+
+/**
+ * Checks if the mapping may be written to.
+ *
+ * @return true for read-write mappings, otherwise false
+ */
+inline auto mapped_file::writable() const noexcept -> bool {
+    return this->read_write;
+}
+
+/**
+ * Tells the system how the whole mapping will be accessed, e.g. to read ahead more pages for
+ * sequential scans or fewer for lookups.
+ *
+ * @param hint the expected access pattern
+ * @throw std::system_error if the hint is rejected
+ */
+inline void mapped_file::advise(advice hint) const {
+    this->advise(hint, 0, this->mapping_size);
+}
+
+/**
+ * Tells the system how a part of the mapping will be accessed, e.g. to read a range ahead with
+ * advice::willneed before it is needed.
+ *
+ * @param hint the expected access pattern
+ * @param offset the first byte of the range, rounded down to its page
+ * @param length the number of bytes of the range
+ * @throw std::system_error if the hint is rejected
+ */
+inline void mapped_file::advise(advice hint, std::size_t offset, std::size_t length) const {
+    if (length == 0) {
+        return;
+    }
+
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const auto start = offset / page * page;
+    if (::madvise(static_cast<char*>(this->mapping) + start, length + offset - start,
+                  flag(hint)) != 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot advise mapping");
+    }
+}
+
+/**
+ * Writes the modified pages of a read-write mapping to the storage and waits for it.
+ *
+ * @throw std::system_error if the pages cannot be written
+ */
+inline void mapped_file::sync() const {
+    if (this->read_write && this->mapping && ::msync(this->mapping, this->mapping_size, MS_SYNC)) {
+        throw std::system_error(errno, std::generic_category(), "cannot sync mapping");
+    }
+}
+
+/**
+ * Unmaps the file, leaving this instance empty.
+ */
+inline void mapped_file::reset() noexcept {
+    if (this->mapping) {
+        ::munmap(this->mapping, this->mapping_size);
+    }
+    this->mapping = nullptr;
+    this->mapping_size = 0;
+    this->read_write = false;
+}
+
+/**
+ * Exchanges the mappings of two instances.
+ *
+ * @param other another mapped file
+ */
+inline void mapped_file::swap(mapped_file& other) noexcept {
+    std::swap(this->mapping, other.mapping);
+    std::swap(this->mapping_size, other.mapping_size);
+    std::swap(this->read_write, other.read_write);
+}
+
+inline auto mapped_file::flag(advice hint) noexcept -> int {
+    switch (hint) {
+        case advice::sequential:
+            return MADV_SEQUENTIAL;
+        case advice::random:
+            return MADV_RANDOM;
+        case advice::willneed:
+            return MADV_WILLNEED;
+        default:
+            return MADV_NORMAL;
+    }
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_MAPPED_FILE_HEADER_IS_ALREADY_INCLUDED
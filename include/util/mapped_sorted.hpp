@@ -0,0 +1,481 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_MAPPED_SORTED_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_MAPPED_SORTED_HEADER_IS_ALREADY_INCLUDED
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "exception.hpp"
+#include "mapped_file.hpp"
+#include "scoped_fd.hpp"
+#include "simd.hpp"
+#include "sorted.hpp"
+
+namespace util {
+
+namespace detail {
+
+/**
+ * The header in front of the elements of a sorted file. It is 64 bytes long, so the elements
+ * following it are aligned for every element type mapped at a page boundary.
+ */
+struct mapped_sorted_header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t byte_order;  // mapped_sorted_byte_order written in the byte order of the writer
+    std::uint64_t element_size;
+    std::uint64_t element_align;
+    std::uint64_t count;
+    std::uint64_t checksum;  // FNV-1a of the element bytes
+    std::array<char, 16> reserved;
+};
+
+static_assert(sizeof(mapped_sorted_header) == 64, "the sorted file header must be 64 bytes");
+
+constexpr std::array<char, 8> mapped_sorted_magic = {'U', 'T', 'I', 'L', 'S', 'R', 'T', '\0'};
+constexpr std::uint32_t mapped_sorted_version = 1;
+constexpr std::uint32_t mapped_sorted_byte_order = 0x01020304;
+
+constexpr std::uint64_t fnv_offset_basis = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t fnv_prime = 0x100000001b3ULL;
+
+inline auto fnv1a(const void* data, std::size_t size, std::uint64_t hash = fnv_offset_basis) noexcept
+    -> std::uint64_t {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * fnv_prime;
+    }
+    return hash;
+}
+
+inline void write_all(int fd, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const auto written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "cannot write sorted file");
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+/**
+ * A uniquely named file next to its destination, which replaces the destination on commit() and is
+ * removed on every other way out of the scope, e.g. when writing it throws.
+ */
+class replacing_file {
+public:
+    explicit replacing_file(const std::string& destination);
+    replacing_file(const replacing_file&) = delete;
+    auto operator=(const replacing_file&) -> replacing_file& = delete;
+    ~replacing_file();
+
+    auto get() const noexcept -> int;
+    void commit();
+
+private:
+    std::string destination;
+    std::string temporary;
+    scoped_fd file;
+    bool committed = false;
+};
+
+/**
+ * Creates the temporary file with a name no concurrent writer to the same destination can choose.
+ */
+inline replacing_file::replacing_file(const std::string& destination)
+    : destination(destination), temporary(destination + ".XXXXXX") {
+    // the descriptor is closed on exec from the start, so no concurrently forked child inherits it
+    const auto fd = ::mkostemp(temporary.data(), O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot create " + temporary);
+    }
+    this->file.reset(fd);
+    // mkostemp creates the file readable only by its owner, the destination is read by others
+    if (::fchmod(fd, 0644) != 0) {
+        const auto error = errno;
+        ::unlink(this->temporary.c_str());
+        throw std::system_error(error, std::generic_category(), "cannot create " + temporary);
+    }
+}
+
+inline replacing_file::~replacing_file() {
+    if (!this->committed) {
+        ::unlink(this->temporary.c_str());
+    }
+}
+
+inline auto replacing_file::get() const noexcept -> int {
+    return this->file.get();
+}
+
+/**
+ * Writes the file to the storage, renames it over the destination and writes the directory entry
+ * to the storage, so the destination survives a crash right after.
+ */
+inline void replacing_file::commit() {
+    if (::fsync(this->file.get()) != 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot write sorted file");
+    }
+    this->file.reset();
+
+    if (::rename(this->temporary.c_str(), this->destination.c_str()) != 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot replace sorted file");
+    }
+    this->committed = true;
+
+    const auto slash = this->destination.rfind('/');
+    const auto directory = slash == std::string::npos ? std::string(".")
+                           : slash == 0               ? std::string("/")
+                                                      : this->destination.substr(0, slash);
+    const auto parent = scoped_fd::open(directory, O_RDONLY | O_DIRECTORY);
+    // some file systems cannot sync directories and reject it as invalid
+    if (::fsync(parent.get()) != 0 && errno != EINVAL) {
+        throw std::system_error(errno, std::generic_category(), "cannot sync " + directory);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Writes a sorted container of trivially copyable elements to a file that util::mapped_sorted
+ * maps. The file starts with a 64 byte header holding a magic number, the layout version, the
+ * byte order, the element size and alignment, the number of elements and a checksum, followed by
+ * the raw bytes of the elements in sorted order.
+ *
+ * The file is written under a unique name next to the given path and then renamed, so processes
+ * mapping the previous file keep a consistent view and concurrent writers do not mix their files.
+ * The temporary file is removed if writing fails. The file and its directory entry are synced to
+ * the storage before returning.
+ *
+ * @snippet test/mapped_sorted.test.cpp mapped_sorted
+ * @param elements the sorted container to write
+ * @param path the path of the file to create or replace
+ * @throw std::system_error if the file cannot be written
+ */
+template <class Container, class Compare>
+void save_mapped(const sorted<Container, Compare>& elements, const std::string& path) {
+    using value_type = typename Container::value_type;
+    static_assert(std::is_trivially_copyable<value_type>::value,
+                  "only trivially copyable elements can be mapped");
+
+    detail::mapped_sorted_header header{};
+    header.magic = detail::mapped_sorted_magic;
+    header.version = detail::mapped_sorted_version;
+    header.byte_order = detail::mapped_sorted_byte_order;
+    header.element_size = sizeof(value_type);
+    header.element_align = alignof(value_type);
+    header.count = elements.size();
+    header.checksum = detail::fnv_offset_basis;
+
+    // the checksum covers the bytes as written, copies may differ from the elements in padding
+    detail::replacing_file file(path);
+    detail::write_all(file.get(), &header, sizeof(header));
+    const auto write_elements = [&file, &header](const value_type* data, std::size_t size) {
+        header.checksum = detail::fnv1a(data, size * sizeof(value_type), header.checksum);
+        detail::write_all(file.get(), data, size * sizeof(value_type));
+    };
+    if constexpr (sorted<Container, Compare>::is_vector::value) {
+        write_elements(elements.data(), elements.size());
+    } else {
+        std::vector<value_type> chunk;
+        chunk.reserve(4096);
+        for (auto it = elements.begin(); it != elements.end();) {
+            chunk.clear();
+            for (; it != elements.end() && chunk.size() < chunk.capacity(); ++it) {
+                chunk.push_back(*it);
+            }
+            write_elements(chunk.data(), chunk.size());
+        }
+    }
+
+    // the header with the final checksum replaces the one written ahead of the elements
+    if (::lseek(file.get(), 0, SEEK_SET) != 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot write sorted file");
+    }
+    detail::write_all(file.get(), &header, sizeof(header));
+    file.commit();
+}
+
+/**
+ * A read-only sorted array of trivially copyable elements mapped from a file written by
+ * util::save_mapped, searched in place without reading the file first.
+ *
+ * Opening only checks the header, the elements are paged in on demand and the page cache is shared
+ * by all processes mapping the same file. The checksum covers all elements and is only compared by
+ * verify(), as computing it reads the whole file.
+ *
+ * @snippet test/mapped_sorted.test.cpp mapped_sorted
+ * @tparam T the trivially copyable element type the file was written with
+ * @tparam Compare the comparison function object the file was sorted with
+ */
+template <class T, class Compare = std::less<T>>
+class mapped_sorted {
+public:
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable elements can be mapped");
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reference = const value_type&;
+    using const_pointer = const value_type*;
+    using const_iterator = const value_type*;
+
+    explicit mapped_sorted(const std::string& path, Compare comp = Compare());
+    ~mapped_sorted();
+    mapped_sorted(mapped_sorted&& other) noexcept;
+    auto operator=(mapped_sorted&& other) noexcept -> mapped_sorted&;
+    mapped_sorted(const mapped_sorted&) = delete;
+    auto operator=(const mapped_sorted&) -> mapped_sorted& = delete;
+
+    // element access
+
+    auto at(size_type pos) const -> const_reference;
+    auto operator[](size_type pos) const -> const_reference;
+    auto data() const noexcept -> const_pointer;
+
+    // lookup
+
+    auto lower_bound(const_reference value) const -> const_iterator;
+    auto upper_bound(const_reference value) const -> const_iterator;
+    auto find(const_reference value) const -> const_iterator;
+    auto contains(const_reference value) const -> bool;
+    auto rank(const_reference value) const -> size_type;
+
+    // iterators
+
+    auto begin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+
+    // capacity and integrity
+
+    auto empty() const noexcept -> bool;
+    auto size() const noexcept -> size_type;
+    auto verify() const noexcept -> bool;
+
+private:
+    Compare comp;
+    mapped_file file;
+
+    auto header() const noexcept -> const detail::mapped_sorted_header&;
+};
+
+/**
+ * Maps a sorted file and checks its header.
+ *
+ * @param path the path of the file written by util::save_mapped
+ * @param comp the comparison function object the file was sorted with
+ * @throw std::system_error if the file cannot be opened or mapped
+ * @throw util::exception if the file is no sorted file of this element type
+ */
+template <class T, class Compare>
+mapped_sorted<T, Compare>::mapped_sorted(const std::string& path, Compare comp)
+    : comp(std::move(comp)), file(path) {
+    const auto file_size = file.size();
+    if (file_size < sizeof(detail::mapped_sorted_header)) {
+        throw util::exception("sorted file is too small");
+    }
+
+    const auto& head = header();
+    const char* error = nullptr;
+    if (head.magic != detail::mapped_sorted_magic) {
+        error = "not a sorted file";
+    } else if (head.version != detail::mapped_sorted_version) {
+        error = "unsupported sorted file version";
+    } else if (head.byte_order != detail::mapped_sorted_byte_order) {
+        error = "sorted file has a different byte order";
+    } else if (head.element_size != sizeof(T) || head.element_align != alignof(T)) {
+        error = "sorted file has a different element type";
+    } else if (head.count > (file_size - sizeof(head)) / sizeof(T) ||
+               file_size - sizeof(head) != head.count * sizeof(T)) {
+        error = "sorted file size does not match its element count";
+    }
+
+    if (error != nullptr) {
+        throw util::exception(error);
+    }
+}
+
+/**
+ * Unmaps the file.
+ */
+template <class T, class Compare>
+mapped_sorted<T, Compare>::~mapped_sorted() = default;
+
+template <class T, class Compare>
+mapped_sorted<T, Compare>::mapped_sorted(mapped_sorted&& other) noexcept
+    : comp(std::move(other.comp)), file(std::move(other.file)) {}
+
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::operator=(mapped_sorted&& other) noexcept -> mapped_sorted& {
+    if (this != &other) {
+        comp = std::move(other.comp);
+        file = std::move(other.file);
+    }
+    return *this;
+}
+
+/**
+ * Returns a const reference to an element at the requested position with boundary checking.
+ *
+ * @param pos the position of the element to return
+ * @throw out_of_range if pos >= size()
+ * @return a const reference to the element at the requested position
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::at(size_type pos) const -> const_reference {
+    if (pos >= size()) {
+        throw std::out_of_range{"pos is out of range"};
+    }
+    return data()[pos];
+}
+
+/**
+ * Returns a const reference to an element at the requested position without boundary checking.
+ * Undefined behaviour if accessing a position >= size().
+ *
+ * @param pos the position of the element to return
+ * @return a const reference to the element at the requested position
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::operator[](size_type pos) const -> const_reference {
+    return data()[pos];
+}
+
+/**
+ * Returns a pointer to the mapped elements.
+ *
+ * @return a pointer to the smallest element or nullptr if nothing is mapped
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::data() const noexcept -> const_pointer {
+    if (file.empty()) {
+        return nullptr;
+    }
+    return reinterpret_cast<const_pointer>(  // NOLINT
+        file.data() + sizeof(detail::mapped_sorted_header));
+}
+
+/**
+ * Searches the first element that is not ordered before the given value. Uses the SIMD search for
+ * integer and float elements ordered by std::less.
+ *
+ * @param value the value to compare the elements to
+ * @return a pointer to the first element not less than value or end() if there is none
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::lower_bound(const_reference value) const -> const_iterator {
+    if constexpr (is_simd_searchable<T>::value && (std::is_same<Compare, std::less<T>>::value ||
+                                                   std::is_same<Compare, std::less<>>::value)) {
+        return simd_lower_bound(begin(), end(), value);
+    } else {
+        return std::lower_bound(begin(), end(), value, comp);
+    }
+}
+
+/**
+ * Searches the first element that is ordered after the given value.
+ *
+ * @param value the value to compare the elements to
+ * @return a pointer to the first element greater than value or end() if there is none
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::upper_bound(const_reference value) const -> const_iterator {
+    return std::upper_bound(begin(), end(), value, comp);
+}
+
+/**
+ * Searches an element equivalent to the given value.
+ *
+ * @param value the value to search for
+ * @return a pointer to the first equivalent element or end() if there is none
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::find(const_reference value) const -> const_iterator {
+    const auto* const it = lower_bound(value);
+    return it != end() && !comp(value, *it) ? it : end();
+}
+
+/**
+ * Checks if there is an element equivalent to the given value.
+ *
+ * @param value the value to search for
+ * @return true if there is an equivalent element, otherwise false
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::contains(const_reference value) const -> bool {
+    return find(value) != end();
+}
+
+/**
+ * Counts the elements ordered before the given value.
+ *
+ * @param value the value to compare the elements to
+ * @return the number of elements less than value
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::rank(const_reference value) const -> size_type {
+    return static_cast<size_type>(lower_bound(value) - begin());
+}
+
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::begin() const noexcept -> const_iterator {
+    return data();
+}
+
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::end() const noexcept -> const_iterator {
+    return data() + size();
+}
+
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::empty() const noexcept -> bool {
+    return size() == 0;
+}
+
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::size() const noexcept -> size_type {
+    return file.empty() ? 0 : static_cast<size_type>(header().count);
+}
+
+/**
+ * Compares the checksum of the header with the checksum of the mapped elements. Reads the whole
+ * file.
+ *
+ * @return true if the elements match the checksum, otherwise false
+ */
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::verify() const noexcept -> bool {
+    return !file.empty() && detail::fnv1a(data(), size() * sizeof(T)) == header().checksum;
+}
+
+template <class T, class Compare>
+auto mapped_sorted<T, Compare>::header() const noexcept -> const detail::mapped_sorted_header& {
+    return *reinterpret_cast<const detail::mapped_sorted_header*>(file.data());
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_MAPPED_SORTED_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,230 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_MERGE_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_MERGE_HEADER_IS_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "sorted.hpp"
+
+#ifdef UTIL_ASSERT
+#include "assert.hpp"
+#endif
+
+namespace util {
+
+/**
+ * A tournament tree selecting the smallest current element of many sorted runs.
+ *
+ * Every inner node remembers the loser of the match played there, the overall winner is kept
+ * separately. After the winner is consumed only the matches on the path from its leaf to the root
+ * are replayed, so each element costs about log2(k) comparisons for k runs, without the swaps and
+ * branches of a binary heap. Equivalent elements are ordered by the index of their run, so merging
+ * is stable.
+ *
+ * @snippet test/merge.test.cpp loser_tree
+ * @tparam Iterator the type of the forward iterators of the runs
+ * @tparam Compare A comparison function object which returns true if the first argument is less
+ * than (i.e. is ordered before) the second. The runs must be sorted by it.
+ */
+template <class Iterator,
+          class Compare = std::less<typename std::iterator_traits<Iterator>::value_type>>
+class loser_tree {
+public:
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    using reference = typename std::iterator_traits<Iterator>::reference;
+    using size_type = std::size_t;
+
+    explicit loser_tree(std::vector<std::pair<Iterator, Iterator>> runs,
+                        Compare comp = Compare());
+
+    auto empty() const noexcept -> bool;
+    auto top() const -> reference;
+    auto top_run() const noexcept -> size_type;
+    void pop();
+
+private:
+    Compare comp;
+    std::vector<std::pair<Iterator, Iterator>> runs;
+    std::vector<size_type> losers;  // index 0 holds the overall winner
+    size_type exhausted = 0;
+
+    auto beats(size_type lhs, size_type rhs) const -> bool;
+};
+
+/**
+ * Constructs a loser tree over the given runs and plays the initial tournament.
+ *
+ * @param runs the ranges to merge, each sorted by comp
+ * @param comp the comparison function object
+ */
+template <class Iterator, class Compare>
+loser_tree<Iterator, Compare>::loser_tree(std::vector<std::pair<Iterator, Iterator>> runs,
+                                          Compare comp)
+    : comp(std::move(comp)), runs(std::move(runs)), losers(this->runs.size()) {
+    const auto count = this->runs.size();
+    for (const auto& run : this->runs) {
+        exhausted += run.first == run.second ? 1 : 0;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    // the leaves are the runs at positions count to 2 * count - 1, the parent of node n is n / 2
+    std::vector<size_type> winners(2 * count);
+    for (size_type i = 0; i < count; ++i) {
+        winners[count + i] = i;
+    }
+    for (auto node = count - 1; node > 0; --node) {
+        const auto left = winners[2 * node];
+        const auto right = winners[2 * node + 1];
+        const auto left_wins = beats(left, right);
+        winners[node] = left_wins ? left : right;
+        losers[node] = left_wins ? right : left;
+    }
+    losers[0] = count == 1 ? 0 : winners[1];
+}
+
+/**
+ * Checks if all runs are exhausted.
+ *
+ * @return true if there are no more elements, otherwise false
+ */
+template <class Iterator, class Compare>
+auto loser_tree<Iterator, Compare>::empty() const noexcept -> bool {
+    return exhausted == runs.size();
+}
+
+/**
+ * Returns the smallest current element of all runs. Undefined behaviour if empty().
+ *
+ * @return a reference to the smallest element
+ */
+template <class Iterator, class Compare>
+auto loser_tree<Iterator, Compare>::top() const -> reference {
+#ifdef UTIL_ASSERT
+    util_assert(!empty());
+#endif
+
+    return *runs[losers[0]].first;
+}
+
+/**
+ * Returns the index of the run the smallest current element belongs to.
+ *
+ * @return the index of the run in the order given at construction
+ */
+template <class Iterator, class Compare>
+auto loser_tree<Iterator, Compare>::top_run() const noexcept -> size_type {
+    return losers[0];
+}
+
+/**
+ * Advances the run of the smallest element and replays its path to the root.
+ */
+template <class Iterator, class Compare>
+void loser_tree<Iterator, Compare>::pop() {
+#ifdef UTIL_ASSERT
+    util_assert(!empty());
+#endif
+
+    auto winner = losers[0];
+    auto& run = runs[winner];
+    if (++run.first == run.second) {
+        ++exhausted;
+    }
+
+    for (auto node = (winner + runs.size()) / 2; node > 0; node /= 2) {
+        if (beats(losers[node], winner)) {
+            std::swap(losers[node], winner);
+        }
+    }
+    losers[0] = winner;
+}
+
+/**
+ * Checks if the current element of one run is ordered before the current element of another run.
+ * Exhausted runs lose every match, ties are won by the run with the smaller index.
+ */
+template <class Iterator, class Compare>
+auto loser_tree<Iterator, Compare>::beats(size_type lhs, size_type rhs) const -> bool {
+    const auto& left = runs[lhs];
+    const auto& right = runs[rhs];
+    if (left.first == left.second) {
+        return false;
+    }
+    if (right.first == right.second) {
+        return true;
+    }
+    if (comp(*left.first, *right.first)) {
+        return true;
+    }
+    return lhs < rhs && !comp(*right.first, *left.first);
+}
+
+/**
+ * Controls whether merging keeps equivalent elements.
+ */
+enum class duplicates { keep, remove };
+
+namespace detail {
+
+template <class Range>
+using merge_result =
+    sorted<std::vector<typename Range::value_type::value_type>,
+           decltype(std::declval<const typename Range::value_type&>().key_comp())>;
+
+}  // namespace detail
+
+/**
+ * Merges many sorted containers into one sorted vector in a single pass using a loser tree.
+ *
+ * Equivalent elements keep the order of the containers they come from, and within a container
+ * their order. Removing duplicates keeps the first of equivalent elements, i.e. the one from the
+ * container listed first. This needs O(n log k) comparisons for n elements in k containers, where
+ * repeated pairwise merging needs O(n k).
+ *
+ * @snippet test/merge.test.cpp merge
+ * @tparam Range a range of util::sorted containers sharing the same element type and ordering
+ * @param inputs the sorted containers to merge
+ * @param mode whether to keep or remove equivalent elements
+ * @return a sorted vector with the elements of all containers
+ */
+template <class Range>
+auto merge(const Range& inputs, duplicates mode = duplicates::keep) -> detail::merge_result<Range> {
+    using sorted_type = typename Range::value_type;
+    using value_type = typename sorted_type::value_type;
+    using compare_type = decltype(std::declval<const sorted_type&>().key_comp());
+    using iterator = typename sorted_type::const_iterator;
+
+    std::vector<std::pair<iterator, iterator>> runs;
+    std::size_t total = 0;
+    for (const auto& input : inputs) {
+        runs.emplace_back(input.begin(), input.end());
+        total += input.size();
+    }
+
+    const auto comp = std::begin(inputs) == std::end(inputs) ? compare_type()
+                                                              : std::begin(inputs)->key_comp();
+    std::vector<value_type> result;
+    result.reserve(total);
+
+    loser_tree<iterator, compare_type> tree(std::move(runs), comp);
+    for (; !tree.empty(); tree.pop()) {
+        if (mode == duplicates::keep || result.empty() || comp(result.back(), tree.top())) {
+            result.push_back(tree.top());
+        }
+    }
+
+    return detail::merge_result<Range>(presorted, std::move(result));
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_MERGE_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,296 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_PARALLEL_SORT_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_PARALLEL_SORT_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sorted.hpp"
+#include "thread_pool.hpp"
+
+namespace util {
+
+/**
+ * An execution policy to sort on several threads, either on a thread pool of its own with a given
+ * number of threads or on an existing util::thread_pool.
+ *
+ * @snippet test/parallel_sort.test.cpp parallel_sort
+ */
+class parallel_t {
+public:
+    using size_type = std::size_t;
+
+    explicit constexpr parallel_t(size_type threads = 0) noexcept : thread_count(threads) {}
+    explicit constexpr parallel_t(thread_pool& pool) noexcept : executor(&pool) {}
+
+    auto threads() const noexcept -> size_type;
+    auto pool() const noexcept -> thread_pool*;
+
+private:
+    size_type thread_count = 0;
+    thread_pool* executor = nullptr;
+};
+
+/**
+ * The execution policy to sort on as many threads as the hardware runs concurrently.
+ */
+inline constexpr parallel_t parallel{};
+
+/**
+ * Returns the number of threads to sort on, the size of the pool if there is one, otherwise the
+ * number given at construction or the number of concurrent hardware threads if that was 0.
+ *
+ * @return the number of threads to sort on, at least one
+ */
+inline auto parallel_t::threads() const noexcept -> size_type {
+    if (executor != nullptr) {
+        return executor->size();
+    }
+    if (thread_count != 0) {
+        return thread_count;
+    }
+    return std::max<size_type>(std::thread::hardware_concurrency(), 1);
+}
+
+/**
+ * Returns the thread pool to sort on.
+ *
+ * @return the thread pool given at construction or nullptr if the sort starts its own threads
+ */
+inline auto parallel_t::pool() const noexcept -> thread_pool* {
+    return executor;
+}
+
+namespace detail {
+
+// with fewer elements per thread the overhead of the threads outweighs the parallel work
+constexpr std::size_t parallel_sort_grain = 1U << 14U;
+
+/**
+ * Waits for all tasks, then rethrows the first exception thrown by a task if any. Waiting for all
+ * tasks first keeps the memory the other tasks work on alive until they are done.
+ */
+inline void wait_all(std::vector<std::future<void>>& tasks) {
+    for (auto& task : tasks) {
+        task.wait();
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+    tasks.clear();
+}
+
+/**
+ * Returns how many elements of the first range are among the first count elements of the stable
+ * merge of both ranges, found by a binary search along the diagonal count of the merge matrix.
+ */
+template <class RandomIt, class Compare>
+auto merge_split(RandomIt first1, std::size_t size1, RandomIt first2, std::size_t size2,
+                 std::size_t count, Compare& comp) -> std::size_t {
+    auto low = count > size2 ? count - size2 : 0;
+    auto high = std::min(count, size1);
+    while (low < high) {
+        const auto middle = low + (high - low) / 2;
+        if (comp(first2[count - middle - 1], first1[middle])) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+/**
+ * Merges each pair of neighboring sorted runs of the source into one run of the destination. Every
+ * merge is split into independent parts along the merge path, so all threads have work even when
+ * few long runs are left.
+ *
+ * @return the boundaries of the merged runs
+ */
+template <class SourceIt, class DestinationIt, class Compare>
+auto merge_runs(thread_pool& pool, std::size_t threads, SourceIt source,
+                DestinationIt destination, const std::vector<std::size_t>& runs, Compare& comp)
+    -> std::vector<std::size_t> {
+    const auto total = runs.back();
+    std::vector<std::size_t> merged = {0};
+    std::vector<std::future<void>> tasks;
+
+    for (std::size_t i = 0; i + 1 < runs.size(); i += 2) {
+        const auto first = runs[i];
+        const auto middle = runs[i + 1];
+        const auto last = i + 2 < runs.size() ? runs[i + 2] : middle;
+        const auto parts = std::max<std::size_t>((threads * (last - first) + total - 1) / total, 1);
+
+        for (std::size_t part = 0; part < parts; ++part) {
+            const auto begin = (last - first) * part / parts;
+            const auto end = (last - first) * (part + 1) / parts;
+            tasks.push_back(pool.submit([=, &comp] {
+                const auto left = source + first;
+                const auto right = source + middle;
+                const auto left_size = middle - first;
+                const auto right_size = last - middle;
+                const auto left_begin =
+                    merge_split(left, left_size, right, right_size, begin, comp);
+                const auto left_end = merge_split(left, left_size, right, right_size, end, comp);
+                std::merge(std::make_move_iterator(left + left_begin),
+                           std::make_move_iterator(left + left_end),
+                           std::make_move_iterator(right + (begin - left_begin)),
+                           std::make_move_iterator(right + (end - left_end)),
+                           destination + first + begin, comp);
+            }));
+        }
+        merged.push_back(last);
+    }
+
+    wait_all(tasks);
+    return merged;
+}
+
+}  // namespace detail
+
+/**
+ * Sorts a range on several threads, keeping the order of equivalent elements.
+ *
+ * The range is split into one chunk per thread, the chunks are sorted concurrently and then merged
+ * pairwise in log2(threads) rounds through a buffer of the same size as the range. Each merge is
+ * split along its merge path so that all threads keep working until the last round. Ranges too
+ * small to profit from threads are sorted by std::stable_sort on the calling thread.
+ *
+ * Must not be called from a task of the thread pool it sorts on.
+ *
+ * @snippet test/parallel_sort.test.cpp parallel_sort
+ * @tparam RandomIt the type of the random access iterators of the range
+ * @tparam Compare A comparison function object which returns true if the first argument is less
+ * than (i.e. is ordered before) the second. It is called concurrently from several threads.
+ * @param policy the number of threads or the thread pool to sort on
+ * @param first the beginning of the range to sort
+ * @param last the end of the range to sort
+ * @param comp the comparison function object
+ */
+template <class RandomIt, class Compare = std::less<>>
+void parallel_sort(parallel_t policy, RandomIt first, RandomIt last, Compare comp = Compare()) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    const auto size = static_cast<std::size_t>(last - first);
+    const auto threads = std::min(policy.threads(), size / detail::parallel_sort_grain);
+    if (threads <= 1) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    std::optional<thread_pool> own_pool;
+    auto& pool = policy.pool() != nullptr ? *policy.pool() : own_pool.emplace(threads);
+
+    std::vector<std::size_t> runs;
+    std::vector<std::future<void>> tasks;
+    for (std::size_t i = 0; i <= threads; ++i) {
+        runs.push_back(size * i / threads);
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        tasks.push_back(pool.submit([&, i] {
+            std::stable_sort(first + runs[i], first + runs[i + 1], comp);
+        }));
+    }
+    detail::wait_all(tasks);
+
+    std::vector<value_type> buffer;
+    if constexpr (std::is_default_constructible<value_type>::value) {
+        buffer.resize(size);
+    } else {
+        buffer.assign(first, last);
+    }
+
+    auto in_buffer = false;
+    while (runs.size() > 2) {
+        runs = in_buffer ? detail::merge_runs(pool, threads, buffer.begin(), first, runs, comp)
+                         : detail::merge_runs(pool, threads, first, buffer.begin(), runs, comp);
+        in_buffer = !in_buffer;
+    }
+
+    if (in_buffer) {
+        for (std::size_t i = 0; i < threads; ++i) {
+            const auto begin = size * i / threads;
+            const auto end = size * (i + 1) / threads;
+            tasks.push_back(pool.submit([&, begin, end] {
+                std::move(buffer.begin() + begin, buffer.begin() + end, first + begin);
+            }));
+        }
+        detail::wait_all(tasks);
+    }
+}
+
+namespace detail {
+
+/**
+ * Splits a util::sorted type into its container and comparison types.
+ */
+template <class Sorted>
+struct sorted_parts;
+
+template <class Container, class Compare>
+struct sorted_parts<sorted<Container, Compare>> {
+    using container_type = Container;
+    using compare_type = Compare;
+};
+
+}  // namespace detail
+
+/**
+ * Constructs a sorted container from a given range of elements, sorting them on several threads
+ * with util::parallel_sort. Equivalent elements keep their order in the range.
+ *
+ * @snippet test/parallel_sort.test.cpp make_sorted
+ * @tparam Sorted the type of the sorted container to construct, e.g. util::sorted_vector<int>
+ * @tparam InputIt the type of the input iterator
+ * @param policy the number of threads or the thread pool to sort on
+ * @param first the beginning of the range of elements to insert
+ * @param last the end of the range of elements to insert
+ * @return the sorted container of the elements
+ */
+template <class Sorted, class InputIt>
+auto make_sorted(parallel_t policy, InputIt first, InputIt last) -> Sorted {
+    using container_type = typename detail::sorted_parts<Sorted>::container_type;
+    using compare_type = typename detail::sorted_parts<Sorted>::compare_type;
+    using value_type = typename Sorted::value_type;
+
+    std::vector<value_type> elements(first, last);
+    parallel_sort(policy, elements.begin(), elements.end(), compare_type());
+
+    if constexpr (std::is_same<container_type, std::vector<value_type>>::value) {
+        return Sorted(presorted, std::move(elements));
+    } else {
+        return Sorted(presorted, std::make_move_iterator(elements.begin()),
+                      std::make_move_iterator(elements.end()));
+    }
+}
+
+/**
+ * Constructs a sorted container from a given container of elements, sorting them on several
+ * threads.
+ *
+ * @snippet test/parallel_sort.test.cpp make_sorted
+ * @tparam Sorted the type of the sorted container to construct, e.g. util::sorted_vector<int>
+ * @tparam OtherContainer the type of the container to insert
+ * @param policy the number of threads or the thread pool to sort on
+ * @param container the container of elements to insert, must have begin() and end() methods
+ * returning input iterators
+ * @return the sorted container of the elements
+ */
+template <class Sorted, class OtherContainer>
+auto make_sorted(parallel_t policy, const OtherContainer& container) -> Sorted {
+    return make_sorted<Sorted>(policy, container.begin(), container.end());
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_PARALLEL_SORT_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_POOL_ALLOCATOR_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_POOL_ALLOCATOR_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "shared.hpp"
+
+namespace util {
+
+namespace detail {
+
+/**
+ * Per-thread pools of fixed-size blocks, one set of pools for every combination of block size and
+ * alignment.
+ *
+ * Each block is preceded by a pointer to the pool which carved it. A thread allocates from and
+ * frees to the free list of its own pool without any synchronization. Blocks freed by other
+ * threads are pushed onto the return queue of their pool, which the owning thread takes over as a
+ * whole once its free list runs empty. Pools of finished threads are adopted by new threads with
+ * all their blocks. The memory of the pools is kept for reuse and never returned to the system.
+ */
+template <std::size_t Size, std::size_t Align>
+class block_pool {
+public:
+    static auto allocate() -> void* {
+        auto& pool = local();
+        if (!pool.free) {
+            pool.free = pool.returned.exchange(nullptr, std::memory_order_acquire);
+            if (!pool.free) {
+                pool.refill();
+            }
+        }
+
+        auto* block = pool.free;
+        pool.free = block->next;
+        return block;
+    }
+
+    static void deallocate(void* ptr) noexcept {
+        auto* block = static_cast<node*>(ptr);
+        auto* pool = *reinterpret_cast<block_pool**>(static_cast<char*>(ptr) - header_size);
+
+        if (pool == current()) {
+            block->next = pool->free;
+            pool->free = block;
+        } else {
+            block->next = pool->returned.load(std::memory_order_relaxed);
+            while (!pool->returned.compare_exchange_weak(block->next, block,
+                                                         std::memory_order_release,
+                                                         std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+private:
+    struct node {
+        node* next;
+    };
+
+    static constexpr std::size_t alignment = std::max(Align, alignof(block_pool*));
+    static constexpr std::size_t header_size =
+        (sizeof(block_pool*) + alignment - 1) / alignment * alignment;
+    static constexpr std::size_t stride =
+        (header_size + std::max(Size, sizeof(node)) + alignment - 1) / alignment * alignment;
+    static constexpr std::size_t blocks_per_chunk = std::max<std::size_t>(16, 16384 / stride);
+
+    // the owner adopts a pool for the lifetime of its thread, current() stays valid until the end
+    struct owner {
+        block_pool* pool = adopt();
+
+        owner() { current() = pool; }
+        owner(const owner&) = delete;
+        auto operator=(const owner&) -> owner& = delete;
+        ~owner() {
+            current() = nullptr;
+            pool->active.store(false, std::memory_order_release);
+        }
+    };
+
+    static auto local() -> block_pool& {
+        thread_local const owner adopted;
+        return *adopted.pool;
+    }
+
+    // a trivially destructible pointer to the pool of this thread, null before and after its owner
+    static auto current() noexcept -> block_pool*& {
+        thread_local block_pool* pool = nullptr;
+        return pool;
+    }
+
+    static auto head() noexcept -> std::atomic<block_pool*>& {
+        static std::atomic<block_pool*> first{nullptr};
+        return first;
+    }
+
+    static auto adopt() -> block_pool* {
+        for (auto* pool = head().load(std::memory_order_acquire); pool; pool = pool->next) {
+            bool active = false;
+            if (!pool->active.load(std::memory_order_relaxed) &&
+                pool->active.compare_exchange_strong(active, true, std::memory_order_acquire)) {
+                return pool;
+            }
+        }
+
+        auto* created = new block_pool();
+        created->next = head().load(std::memory_order_relaxed);
+        while (!head().compare_exchange_weak(created->next, created, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+        return created;
+    }
+
+    // carves a new chunk into blocks which all start with a pointer to this pool
+    void refill() {
+        auto* chunk = static_cast<char*>(
+            ::operator new(stride * blocks_per_chunk, std::align_val_t(alignment)));
+        for (std::size_t i = blocks_per_chunk; i-- > 0;) {
+            auto* slot = chunk + i * stride;
+            ::new (static_cast<void*>(slot)) block_pool*(this);
+            auto* block = ::new (static_cast<void*>(slot + header_size)) node{free};
+            free = block;
+        }
+    }
+
+    node* free = nullptr;
+    alignas(64) std::atomic<node*> returned{nullptr};
+    std::atomic<bool> active{true};
+    block_pool* next = nullptr;
+};
+
+}  // namespace detail
+
+/**
+ * An allocator drawing single objects from per-thread pools of blocks of their size, so allocating
+ * and freeing them usually takes a few instructions and no lock. Objects may be freed on any
+ * thread, they are returned to the pool of the allocating thread. Arrays are allocated with `new`.
+ *
+ * Pooled memory is kept for reuse by the same kind of objects and not returned to the system, so
+ * the pools grow to the peak number of live objects.
+ *
+ * @tparam T the type of objects to allocate
+ */
+template <class T>
+class pool_allocator {
+public:
+    using value_type = T;
+
+    constexpr pool_allocator() noexcept = default;
+    template <class U>
+    constexpr pool_allocator(const pool_allocator<U>& /*other*/) noexcept {}
+
+    auto allocate(std::size_t count) -> T*;
+    void deallocate(T* ptr, std::size_t count) noexcept;
+};
+
+/**
+ * Allocates memory for count objects of type T, single objects from the pool of this thread.
+ *
+ * @param count the number of objects
+ * @return a pointer to the uninitialized memory
+ */
+template <class T>
+auto pool_allocator<T>::allocate(std::size_t count) -> T* {
+    if (count == 1) {
+        return static_cast<T*>(detail::block_pool<sizeof(T), alignof(T)>::allocate());
+    }
+
+    return std::allocator<T>().allocate(count);
+}
+
+/**
+ * Frees memory allocated by any pool_allocator for the same type.
+ *
+ * @param ptr the pointer returned by allocate
+ * @param count the number of objects passed to allocate
+ */
+template <class T>
+void pool_allocator<T>::deallocate(T* ptr, std::size_t count) noexcept {
+    if (count == 1) {
+        detail::block_pool<sizeof(T), alignof(T)>::deallocate(ptr);
+    } else {
+        std::allocator<T>().deallocate(ptr, count);
+    }
+}
+
+/**
+ * Pool allocators are stateless, any of them can free the memory allocated by another one.
+ */
+template <class T, class U>
+constexpr auto operator==(const pool_allocator<T>& /*lhs*/,
+                          const pool_allocator<U>& /*rhs*/) noexcept -> bool {
+    return true;
+}
+
+template <class T, class U>
+constexpr auto operator!=(const pool_allocator<T>& /*lhs*/,
+                          const pool_allocator<U>& /*rhs*/) noexcept -> bool {
+    return false;
+}
+
+/**
+ * Constructs an object of type T like util::make_shared, but draws the block of object and
+ * reference counter from the pool of this thread via util::pool_allocator.
+ *
+ * @tparam T the type of object to construct
+ * @tparam Count the reference counter of the returned instance
+ * @tparam Args the types of arguments for the constructor of T
+ * @param args a list of arguments with which an instance of T will be constructed
+ * @return an util::shared object of an instance of type T
+ */
+template <class T, class Count = local_count, class... Args>
+auto make_pooled_shared(Args&&... args) -> shared<T, Count> {
+    return allocate_shared<T, Count>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_POOL_ALLOCATOR_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,336 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_RECLAMATION_DOMAIN_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_RECLAMATION_DOMAIN_HEADER_IS_ALREADY_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace util {
+
+namespace detail {
+
+/**
+ * The machinery shared by util::hazard_domain and util::epoch_domain: a registry of slots in which
+ * readers announce a Value, and a list of retired objects stamped with a Value, which the derived
+ * Domain reclaims by comparing the stamps with the announcements.
+ *
+ * Slots are padded to a cache line each and are reused once released, they are freed with the
+ * domain. An idle slot announces `Value()`.
+ *
+ * @tparam Domain the derived domain, returned by global()
+ * @tparam Value the type of the announcements and stamps
+ */
+template <class Domain, class Value>
+class reclamation_domain {
+public:
+    reclamation_domain() = default;
+    reclamation_domain(const reclamation_domain&) = delete;
+    auto operator=(const reclamation_domain&) -> reclamation_domain& = delete;
+    ~reclamation_domain();
+
+    static auto global() noexcept -> Domain&;
+
+    auto retired_count() const noexcept -> std::size_t;
+
+protected:
+    template <class>
+    friend class slot_cache;
+
+    using value_type = Value;
+
+    struct alignas(64) slot {
+        std::atomic<Value> announced{Value()};
+        std::atomic<bool> active{true};
+        slot* next = nullptr;
+    };
+
+    class retired {
+    public:
+        explicit retired(Value stamp) noexcept : stamp(stamp) {}
+        retired(const retired&) = delete;
+        auto operator=(const retired&) -> retired& = delete;
+        virtual ~retired() = default;
+
+        virtual void reclaim() noexcept = 0;
+
+        Value stamp;
+        retired* next = nullptr;
+    };
+
+    template <class T, class Deleter>
+    class retired_object final : public retired {
+    public:
+        retired_object(T* ptr, Deleter&& deleter, Value stamp) noexcept
+            : retired(stamp), object(ptr), deleter(std::move(deleter)) {}
+
+        void reclaim() noexcept override { deleter(object); }
+
+    private:
+        T* object;
+        Deleter deleter;
+    };
+
+    auto acquire() -> slot*;
+    static void release(slot* owned) noexcept;
+    auto first_slot() const noexcept -> slot*;
+    auto slot_count() const noexcept -> std::size_t;
+
+    template <class T, class Deleter>
+    void add_retired(T* ptr, Deleter deleter, Value stamp);
+    auto take() noexcept -> retired*;
+    template <class Predicate>
+    void sweep(retired* list, Predicate keep) noexcept;
+
+private:
+    void push(retired* first, retired* last, std::size_t count) noexcept;
+
+    std::atomic<slot*> slots{nullptr};
+    std::atomic<std::size_t> slots_size{0};
+    alignas(64) std::atomic<retired*> retired_list{nullptr};
+    std::atomic<std::size_t> retired_size{0};
+};
+
+/**
+ * Hands out slots of a domain to readers. Slots of the global domain are cached per thread, so
+ * taking one usually takes no synchronization, the cache is released when the thread exits.
+ *
+ * @tparam Domain the domain owning the slots
+ */
+template <class Domain>
+class slot_cache {
+public:
+    using slot = typename Domain::slot;
+
+    static auto acquire(Domain& domain) -> slot*;
+    static void release(Domain& domain, slot* owned) noexcept;
+
+private:
+    // the cached slot of the global domain, trivially destructible to stay usable at thread exit
+    struct thread_cache {
+        slot* cached = nullptr;
+        bool exited = false;
+    };
+
+    // releases the cached slot when the thread exits
+    struct cache_owner {
+        cache_owner() = default;
+        cache_owner(const cache_owner&) = delete;
+        auto operator=(const cache_owner&) -> cache_owner& = delete;
+        ~cache_owner();
+    };
+
+    static auto cache() noexcept -> thread_cache&;
+};
+
+/**
+ * Destroys the domain and reclaims all retired objects. No reader of the domain may exist anymore.
+ */
+template <class Domain, class Value>
+reclamation_domain<Domain, Value>::~reclamation_domain() {
+    auto* list = this->take();
+    while (list) {
+        auto* next = list->next;
+        list->reclaim();
+        delete list;
+        list = next;
+    }
+
+    auto* s = this->first_slot();
+    while (s) {
+        auto* next = s->next;
+        delete s;
+        s = next;
+    }
+}
+
+/**
+ * Returns the process-wide domain. It is never destroyed, so it can be used until the very end.
+ *
+ * @return the global domain
+ */
+template <class Domain, class Value>
+auto reclamation_domain<Domain, Value>::global() noexcept -> Domain& {
+    static auto* const domain = new Domain();
+    return *domain;
+}
+
+/**
+ * Returns the number of retired objects waiting for reclamation.
+ *
+ * @return the number of retired but not yet reclaimed objects
+ */
+template <class Domain, class Value>
+auto reclamation_domain<Domain, Value>::retired_count() const noexcept -> std::size_t {
+    return this->retired_size.load(std::memory_order_relaxed);
+}
+
+/**
+ * Takes a released slot or adds a new one to the domain.
+ */
+template <class Domain, class Value>
+auto reclamation_domain<Domain, Value>::acquire() -> slot* {
+    for (auto* s = this->first_slot(); s; s = s->next) {
+        bool active = false;
+        if (!s->active.load(std::memory_order_relaxed) &&
+            s->active.compare_exchange_strong(active, true, std::memory_order_acquire)) {
+            return s;
+        }
+    }
+
+    auto* created = new slot();
+    created->next = this->slots.load(std::memory_order_relaxed);
+    while (!this->slots.compare_exchange_weak(created->next, created, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+    this->slots_size.fetch_add(1, std::memory_order_relaxed);
+    return created;
+}
+
+/**
+ * Clears a slot and makes it available to other readers.
+ */
+template <class Domain, class Value>
+void reclamation_domain<Domain, Value>::release(slot* owned) noexcept {
+    owned->announced.store(Value(), std::memory_order_release);
+    owned->active.store(false, std::memory_order_release);
+}
+
+/**
+ * Returns the most recently added slot, the others follow through their next pointers.
+ */
+template <class Domain, class Value>
+auto reclamation_domain<Domain, Value>::first_slot() const noexcept -> slot* {
+    return this->slots.load(std::memory_order_acquire);
+}
+
+/**
+ * Returns the number of slots ever added to the domain.
+ */
+template <class Domain, class Value>
+auto reclamation_domain<Domain, Value>::slot_count() const noexcept -> std::size_t {
+    return this->slots_size.load(std::memory_order_relaxed);
+}
+
+/**
+ * Retires an object with the given stamp onto the retired list.
+ */
+template <class Domain, class Value>
+template <class T, class Deleter>
+void reclamation_domain<Domain, Value>::add_retired(T* ptr, Deleter deleter, Value stamp) {
+    auto* node = new retired_object<T, Deleter>(ptr, std::move(deleter), stamp);
+    this->push(node, node, 1);
+}
+
+/**
+ * Takes the whole retired list, which the caller has to sweep() afterwards.
+ */
+template <class Domain, class Value>
+auto reclamation_domain<Domain, Value>::take() noexcept -> retired* {
+    return this->retired_list.exchange(nullptr, std::memory_order_acquire);
+}
+
+/**
+ * Reclaims all objects of a taken retired list which are not kept by the given predicate, the kept
+ * objects are pushed back onto the retired list.
+ *
+ * @param list the list returned by take()
+ * @param keep the predicate called with each retired object, true to keep it retired
+ */
+template <class Domain, class Value>
+template <class Predicate>
+void reclamation_domain<Domain, Value>::sweep(retired* list, Predicate keep) noexcept {
+    retired* kept = nullptr;
+    retired* kept_last = nullptr;
+    std::size_t kept_count = 0;
+    std::size_t count = 0;
+    while (list) {
+        auto* next = list->next;
+        ++count;
+        if (keep(*list)) {
+            list->next = kept;
+            kept = list;
+            kept_last = kept_last ? kept_last : list;
+            ++kept_count;
+        } else {
+            list->reclaim();
+            delete list;
+        }
+        list = next;
+    }
+
+    this->retired_size.fetch_sub(count, std::memory_order_relaxed);
+    if (kept) {
+        this->push(kept, kept_last, kept_count);
+    }
+}
+
+/**
+ * Pushes a linked list of retired objects onto the retired list of the domain.
+ */
+template <class Domain, class Value>
+void reclamation_domain<Domain, Value>::push(retired* first, retired* last,
+                                             std::size_t count) noexcept {
+    this->retired_size.fetch_add(count, std::memory_order_relaxed);
+    last->next = this->retired_list.load(std::memory_order_relaxed);
+    while (!this->retired_list.compare_exchange_weak(last->next, first, std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Takes the cached slot of the calling thread for the global domain or acquires one.
+ *
+ * @param domain the domain to take a slot of
+ * @return a slot announcing `Value()`
+ */
+template <class Domain>
+auto slot_cache<Domain>::acquire(Domain& domain) -> slot* {
+    auto& local = cache();
+    if (&domain == &Domain::global() && local.cached) {
+        return std::exchange(local.cached, nullptr);
+    }
+    return domain.acquire();
+}
+
+/**
+ * Clears the announcement of a slot and keeps it in the cache of the calling thread if it belongs
+ * to the global domain and the cache is empty, otherwise releases it to the domain.
+ *
+ * @param domain the domain of the slot
+ * @param owned the slot taken by acquire()
+ */
+template <class Domain>
+void slot_cache<Domain>::release(Domain& domain, slot* owned) noexcept {
+    auto& local = cache();
+    if (&domain == &Domain::global() && !local.cached && !local.exited) {
+        static thread_local const cache_owner owner;
+        owned->announced.store(typename Domain::value_type(), std::memory_order_release);
+        local.cached = owned;
+    } else {
+        Domain::release(owned);
+    }
+}
+
+template <class Domain>
+slot_cache<Domain>::cache_owner::~cache_owner() {
+    auto& local = cache();
+    local.exited = true;
+    if (local.cached) {
+        Domain::release(std::exchange(local.cached, nullptr));
+    }
+}
+
+template <class Domain>
+auto slot_cache<Domain>::cache() noexcept -> thread_cache& {
+    static thread_local thread_cache local;
+    return local;
+}
+
+}  // namespace detail
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_RECLAMATION_DOMAIN_HEADER_IS_ALREADY_INCLUDED
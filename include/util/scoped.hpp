@@ -4,44 +4,138 @@
 #ifndef THAT_THIS_UTIL_SCOPED_HEADER_IS_ALREADY_INCLUDED
 #define THAT_THIS_UTIL_SCOPED_HEADER_IS_ALREADY_INCLUDED
 
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
 namespace util {
 
+namespace detail {
+
 /**
- * A class for managing heap memory within a certain scope.
- *
- * @code{.cpp}
- * util::scoped number(new int(100));
- * @endcode
+ * Stores a deleter, empty deleters as a base class so that they take no space (empty base
+ * optimization), all other deleters as a member.
  */
-template <class T>
-class scoped {
+template <class Deleter, bool = std::is_empty<Deleter>::value && !std::is_final<Deleter>::value>
+class deleter_storage : private Deleter {
+public:
+    deleter_storage() = default;
+    explicit deleter_storage(Deleter&& deleter) noexcept : Deleter(std::move(deleter)) {}
+
+    auto deleter() noexcept -> Deleter& { return *this; }
+    auto deleter() const noexcept -> const Deleter& { return *this; }
+};
+
+template <class Deleter>
+class deleter_storage<Deleter, false> {
+public:
+    deleter_storage() = default;
+    explicit deleter_storage(Deleter&& deleter) noexcept : stored(std::move(deleter)) {}
+
+    auto deleter() noexcept -> Deleter& { return stored; }
+    auto deleter() const noexcept -> const Deleter& { return stored; }
+
+private:
+    Deleter stored{};
+};
+
+/**
+ * Enables the constructors without a deleter only for deleters which can be default constructed
+ * into a usable state, i.e. not for function pointers, which would be null.
+ */
+template <class Deleter>
+using enable_if_default_deleter = std::enable_if_t<std::is_default_constructible<Deleter>::value &&
+                                                   !std::is_pointer<Deleter>::value>;
+
+/**
+ * The ownership part of util::scoped shared by its single object and array forms.
+ */
+template <class T, class Deleter>
+class scoped_base : private deleter_storage<Deleter> {
 public:
     using element_type = T;
     using pointer = element_type*;
     using reference = element_type&;
+    using deleter_type = Deleter;
 
-    explicit scoped(pointer ptr = nullptr) noexcept;
-    ~scoped();
+    template <class D = Deleter, class = enable_if_default_deleter<D>>
+    scoped_base() noexcept;
+    template <class D = Deleter, class = enable_if_default_deleter<D>>
+    explicit scoped_base(pointer ptr) noexcept;
+    scoped_base(pointer ptr, Deleter deleter) noexcept;
+    ~scoped_base();
 
-    scoped(scoped&& other);
-    scoped& operator=(scoped&& other);
+    scoped_base(scoped_base&& other) noexcept;
+    scoped_base& operator=(scoped_base&& other) noexcept;
 
-    scoped(const scoped&) = delete;
-    scoped& operator=(const scoped&) = delete;
+    scoped_base(const scoped_base&) = delete;
+    scoped_base& operator=(const scoped_base&) = delete;
 
-    reference operator*() const;
-    pointer operator->() const;
     explicit operator bool() const noexcept;
 
     pointer release() noexcept;
-    void reset(pointer ptr) noexcept;
-    void swap(scoped& other) noexcept;
+    void reset(pointer ptr = nullptr) noexcept;
+    void swap(scoped_base& other) noexcept;
     pointer get() const;
+    Deleter& get_deleter() noexcept;
+    const Deleter& get_deleter() const noexcept;
 
-private:
+protected:
     pointer ptr_ = nullptr;
 };
 
+}  // namespace detail
+
+/**
+ * A class for managing heap memory within a certain scope.
+ *
+ * The object is released by the given deleter, `delete` by default. Empty deleters, e.g. one
+ * returning objects to a pool or an arena, take no space, so such a scoped pointer is exactly one
+ * pointer wide and releasing calls the deleter directly.
+ *
+ * @code{.cpp}
+ * util::scoped number(new int(100));
+ * @endcode
+ *
+ * @tparam T the type of the managed object, `U[]` for arrays allocated with `new U[]`
+ * @tparam Deleter the type of the function object releasing the managed object
+ */
+template <class T, class Deleter = std::default_delete<T>>
+class scoped : public detail::scoped_base<T, Deleter> {
+public:
+    using typename detail::scoped_base<T, Deleter>::pointer;
+    using typename detail::scoped_base<T, Deleter>::reference;
+
+    using detail::scoped_base<T, Deleter>::scoped_base;
+
+    reference operator*() const;
+    pointer operator->() const;
+};
+
+/**
+ * A class for managing a heap array within a certain scope, released by `delete[]` by default.
+ *
+ * @code{.cpp}
+ * util::scoped<int[]> numbers(new int[3]{1, 2, 3});
+ * @endcode
+ */
+template <class T, class Deleter>
+class scoped<T[], Deleter> : public detail::scoped_base<T, Deleter> {
+public:
+    using typename detail::scoped_base<T, Deleter>::reference;
+
+    using detail::scoped_base<T, Deleter>::scoped_base;
+
+    reference operator[](std::size_t index) const;
+};
+
+template <class T>
+scoped(T*) -> scoped<T>;
+
+template <class T, class Deleter>
+scoped(T*, Deleter) -> scoped<T, Deleter>;
+
 }  // namespace util
 
 #ifdef UTIL_ASSERT
@@ -49,61 +143,77 @@ private:
 #endif
 
 /**
- * Constructs a scoped pointer from a given memory block.
+ * Constructs an empty scoped pointer, only if the deleter can be default constructed.
  */
-template <class T>
-util::scoped<T>::scoped(pointer ptr) noexcept : ptr_(ptr) {}
+template <class T, class Deleter>
+template <class D, class>
+util::detail::scoped_base<T, Deleter>::scoped_base() noexcept {}
 
-template <class T>
-util::scoped<T>::~scoped() {
-    if (ptr_) delete ptr_;
-}
+/**
+ * Constructs a scoped pointer from a given memory block, only if the deleter can be default
+ * constructed. Function pointer deleters have to be passed along with the memory block.
+ */
+template <class T, class Deleter>
+template <class D, class>
+util::detail::scoped_base<T, Deleter>::scoped_base(pointer ptr) noexcept : ptr_(ptr) {}
 
-template <class T>
-typename util::scoped<T>::reference util::scoped<T>::operator*() const {
-#if defined UTIL_ASSERT
-    util_assert(ptr_ != nullptr);
-#endif
+/**
+ * Constructs a scoped pointer from a given memory block which is released by the given deleter.
+ */
+template <class T, class Deleter>
+util::detail::scoped_base<T, Deleter>::scoped_base(pointer ptr, Deleter deleter) noexcept
+    : deleter_storage<Deleter>(std::move(deleter)), ptr_(ptr) {}
 
-    return *ptr_;
+template <class T, class Deleter>
+util::detail::scoped_base<T, Deleter>::~scoped_base() {
+    if (ptr_) get_deleter()(ptr_);
 }
 
-template <class T>
-typename util::scoped<T>::pointer util::scoped<T>::operator->() const {
-#if defined UTIL_ASSERT
-    util_assert(ptr_ != nullptr);
-#endif
+/**
+ * Takes over the memory block and the deleter of another scoped pointer, which is left empty.
+ */
+template <class T, class Deleter>
+util::detail::scoped_base<T, Deleter>::scoped_base(scoped_base&& other) noexcept
+    : deleter_storage<Deleter>(std::move(other.get_deleter())), ptr_(other.release()) {}
 
-    return ptr_;
+template <class T, class Deleter>
+util::detail::scoped_base<T, Deleter>& util::detail::scoped_base<T, Deleter>::operator=(
+    scoped_base&& other) noexcept {
+    reset(other.release());
+    get_deleter() = std::move(other.get_deleter());
+    return *this;
 }
 
-template <class T>
-util::scoped<T>::operator bool() const noexcept {
+template <class T, class Deleter>
+util::detail::scoped_base<T, Deleter>::operator bool() const noexcept {
     return ptr_ != nullptr;
 }
 
-template <class T>
-typename util::scoped<T>::pointer util::scoped<T>::release() noexcept {
+template <class T, class Deleter>
+typename util::detail::scoped_base<T, Deleter>::pointer
+util::detail::scoped_base<T, Deleter>::release() noexcept {
     const auto tmp = ptr_;
     ptr_ = nullptr;
     return tmp;
 }
 
-template <class T>
-void util::scoped<T>::reset(pointer ptr) noexcept {
-    if (ptr_) delete ptr_;
+template <class T, class Deleter>
+void util::detail::scoped_base<T, Deleter>::reset(pointer ptr) noexcept {
+    const auto old = ptr_;
     ptr_ = ptr;
+    if (old) get_deleter()(old);
 }
 
-template <class T>
-void util::scoped<T>::swap(scoped& other) noexcept {
-    const auto tmp = ptr_;
-    ptr_ = other.ptr_;
-    other.ptr_ = tmp;
+template <class T, class Deleter>
+void util::detail::scoped_base<T, Deleter>::swap(scoped_base& other) noexcept {
+    using std::swap;
+    swap(ptr_, other.ptr_);
+    swap(get_deleter(), other.get_deleter());
 }
 
-template <class T>
-typename util::scoped<T>::pointer util::scoped<T>::get() const {
+template <class T, class Deleter>
+typename util::detail::scoped_base<T, Deleter>::pointer util::detail::scoped_base<T, Deleter>::get()
+    const {
 #if defined UTIL_ASSERT
     util_assert(ptr_ != nullptr);
 #endif
@@ -111,4 +221,42 @@ typename util::scoped<T>::pointer util::scoped<T>::get() const {
     return ptr_;
 }
 
-#endif  // THAT_THIS_UTIL_SCOPED_HEADER_IS_ALREADY_INCLUDED
\ No newline at end of file
+template <class T, class Deleter>
+Deleter& util::detail::scoped_base<T, Deleter>::get_deleter() noexcept {
+    return this->deleter();
+}
+
+template <class T, class Deleter>
+const Deleter& util::detail::scoped_base<T, Deleter>::get_deleter() const noexcept {
+    return this->deleter();
+}
+
+template <class T, class Deleter>
+typename util::scoped<T, Deleter>::reference util::scoped<T, Deleter>::operator*() const {
+#if defined UTIL_ASSERT
+    util_assert(this->ptr_ != nullptr);
+#endif
+
+    return *this->ptr_;
+}
+
+template <class T, class Deleter>
+typename util::scoped<T, Deleter>::pointer util::scoped<T, Deleter>::operator->() const {
+#if defined UTIL_ASSERT
+    util_assert(this->ptr_ != nullptr);
+#endif
+
+    return this->ptr_;
+}
+
+template <class T, class Deleter>
+typename util::scoped<T[], Deleter>::reference util::scoped<T[], Deleter>::operator[](
+    std::size_t index) const {
+#if defined UTIL_ASSERT
+    util_assert(this->ptr_ != nullptr);
+#endif
+
+    return this->ptr_[index];
+}
+
+#endif  // THAT_THIS_UTIL_SCOPED_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_SCOPED_FD_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_SCOPED_FD_HEADER_IS_ALREADY_INCLUDED
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace util {
+
+/**
+ * A file descriptor which is closed when leaving the scope, the util::scoped of POSIX files.
+ *
+ * @code{.cpp}
+ * const auto file = util::scoped_fd::open("index.bin", O_RDONLY);
+ * const auto bytes = file.size();
+ * @endcode
+ */
+class scoped_fd {
+public:
+    constexpr scoped_fd() noexcept = default;
+    constexpr explicit scoped_fd(int fd) noexcept;
+    scoped_fd(scoped_fd&& other) noexcept;
+    auto operator=(scoped_fd&& other) noexcept -> scoped_fd&;
+    scoped_fd(const scoped_fd&) = delete;
+    auto operator=(const scoped_fd&) -> scoped_fd& = delete;
+    ~scoped_fd();
+
+    static auto open(const std::string& path, int flags, mode_t mode = 0644) -> scoped_fd;
+
+    auto get() const noexcept -> int;
+    explicit operator bool() const noexcept;
+    auto size() const -> std::size_t;
+
+    auto release() noexcept -> int;
+    void reset(int fd = -1) noexcept;
+    void swap(scoped_fd& other) noexcept;
+
+private:
+    int fd = -1;
+};
+
+/**
+ * Takes ownership of an open file descriptor, negative values are treated as no file.
+ *
+ * @param fd the file descriptor to close with this instance
+ */
+constexpr scoped_fd::scoped_fd(int fd) noexcept : fd(fd < 0 ? -1 : fd) {}
+
+/**
+ * Takes over the file descriptor of another instance, which is left without one.
+ *
+ * @param other another scoped file descriptor
+ */
+inline scoped_fd::scoped_fd(scoped_fd&& other) noexcept : fd(other.release()) {}
+
+/**
+ * Closes the current file descriptor and takes over the one of another instance.
+ *
+ * @param other another scoped file descriptor
+ * @return a reference to this instance
+ */
+inline auto scoped_fd::operator=(scoped_fd&& other) noexcept -> scoped_fd& {
+    this->reset(other.release());
+
+    return *this;
+}
+
+/**
+ * Closes the file descriptor, if any.
+ */
+inline scoped_fd::~scoped_fd() {
+    this->reset();
+}
+
+/**
+ * Opens a file, always with `O_CLOEXEC` so that the descriptor does not leak into child processes.
+ *
+ * @param path the path of the file
+ * @param flags the flags for `open`, e.g. `O_RDONLY` or `O_RDWR | O_CREAT`
+ * @param mode the permissions of a created file
+ * @return the scoped file descriptor of the opened file
+ * @throw std::system_error if the file cannot be opened
+ */
+inline auto scoped_fd::open(const std::string& path, int flags, mode_t mode) -> scoped_fd {
+    while (true) {
+        const auto fd = ::open(path.c_str(), flags | O_CLOEXEC, mode);
+        if (fd >= 0) {
+            return scoped_fd(fd);
+        }
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+        }
+    }
+}
+
+/**
+ * Returns the file descriptor without giving up ownership.
+ *
+ * @return the file descriptor or -1 if there is none
+ */
+inline auto scoped_fd::get() const noexcept -> int {
+    return this->fd;
+}
+
+/**
+ * Checks if there is a file descriptor.
+ *
+ * @return true if there is a file descriptor, otherwise false
+ */
+inline scoped_fd::operator bool() const noexcept {
+    return this->fd >= 0;
+}
+
+/**
+ * Returns the current size of the file.
+ *
+ * @return the size of the file in bytes
+ * @throw std::system_error if the file status cannot be read
+ */
+inline auto scoped_fd::size() const -> std::size_t {
+    struct stat status {};
+    if (::fstat(this->fd, &status) != 0) {
+        throw std::system_error(errno, std::generic_category(), "cannot read file status");
+    }
+    return static_cast<std::size_t>(status.st_size);
+}
+
+/**
+ * Gives up ownership of the file descriptor without closing it.
+ *
+ * @return the file descriptor or -1 if there was none
+ */
+inline auto scoped_fd::release() noexcept -> int {
+    return std::exchange(this->fd, -1);
+}
+
+/**
+ * Closes the current file descriptor and takes ownership of another one.
+ *
+ * @param fd the file descriptor to take over or -1 for none
+ */
+inline void scoped_fd::reset(int fd) noexcept {
+    const auto previous = std::exchange(this->fd, fd < 0 ? -1 : fd);
+    if (previous >= 0) {
+        // the descriptor is released even if close is interrupted, so it is not retried
+        ::close(previous);
+    }
+}
+
+/**
+ * Exchanges the file descriptors of two instances.
+ *
+ * @param other another scoped file descriptor
+ */
+inline void scoped_fd::swap(scoped_fd& other) noexcept {
+    std::swap(this->fd, other.fd);
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_SCOPED_FD_HEADER_IS_ALREADY_INCLUDED
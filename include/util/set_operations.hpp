@@ -0,0 +1,260 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_SET_OPERATIONS_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_SET_OPERATIONS_HEADER_IS_ALREADY_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "simd.hpp"
+#include "sorted.hpp"
+
+namespace util {
+
+namespace detail {
+
+// from this ratio of the larger to the smaller input size on, galloping beats a linear merge
+constexpr std::size_t gallop_ratio = 32;
+
+template <class Container>
+using has_random_access = std::is_base_of<
+    std::random_access_iterator_tag,
+    typename std::iterator_traits<typename Container::const_iterator>::iterator_category>;
+
+/**
+ * Searches the lower bound by probing the positions 1, 2, 4, 8, ... from first and then searching
+ * binary between the last two probes. Finds elements close to first in few steps.
+ */
+template <class RandomIt, class T, class Compare>
+auto gallop_lower_bound(RandomIt first, RandomIt last, const T& value, Compare comp) -> RandomIt {
+    const auto size = last - first;
+    decltype(last - first) bound = 1;
+    while (bound < size && comp(first[bound], value)) {
+        bound *= 2;
+    }
+    return std::lower_bound(first + bound / 2, first + std::min(bound + 1, size), value, comp);
+}
+
+template <class Iterator, class Compare>
+auto is_strictly_increasing(Iterator first, Iterator last, Compare comp) -> bool {
+    return std::adjacent_find(first, last, [&](const auto& lhs, const auto& rhs) {
+               return !comp(lhs, rhs);
+           }) == last;
+}
+
+/**
+ * Wraps sorted elements into the result container without sorting them again.
+ */
+template <class Container, class Compare>
+auto make_presorted(std::vector<typename Container::value_type>&& elements)
+    -> sorted<Container, Compare> {
+    if constexpr (std::is_same<Container, std::vector<typename Container::value_type>>::value) {
+        return sorted<Container, Compare>(presorted, std::move(elements));
+    } else {
+        return sorted<Container, Compare>(presorted, elements.begin(), elements.end());
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Computes the sorted intersection of two sorted containers, with std::set_intersection semantics:
+ * an element present m times in lhs and n times in rhs is present min(m, n) times in the result,
+ * copied from lhs.
+ *
+ * If one container is much smaller, each of its elements is searched in the larger one by
+ * galloping from the previous match, which takes O(m log(n/m)) instead of O(m + n) comparisons.
+ * Two strictly increasing sorted_vector<std::uint32_t> of similar size are intersected four by four
+ * elements with SIMD comparisons. Otherwise the containers are merged linearly.
+ *
+ * @snippet test/set_operations.test.cpp set_intersection
+ * @param lhs the first sorted container
+ * @param rhs the second sorted container, ordered by the same comparison
+ * @return a sorted container of the same type as lhs with the common elements
+ */
+template <class Container1, class Container2, class Compare>
+auto set_intersection(const sorted<Container1, Compare>& lhs, const sorted<Container2, Compare>& rhs)
+    -> sorted<Container1, Compare> {
+    using value_type = typename Container1::value_type;
+
+    const auto comp = lhs.key_comp();
+    const auto lhs_size = lhs.size();
+    const auto rhs_size = rhs.size();
+    std::vector<value_type> result;
+
+    if constexpr (detail::has_random_access<Container1>::value &&
+                  detail::has_random_access<Container2>::value) {
+        if (lhs_size * detail::gallop_ratio <= rhs_size) {
+            auto large = rhs.begin();
+            for (auto it = lhs.begin(); it != lhs.end() && large != rhs.end(); ++it) {
+                large = detail::gallop_lower_bound(large, rhs.end(), *it, comp);
+                if (large != rhs.end() && !comp(*it, *large)) {
+                    result.push_back(*it);
+                    ++large;
+                }
+            }
+            return detail::make_presorted<Container1, Compare>(std::move(result));
+        }
+
+        if (rhs_size * detail::gallop_ratio <= lhs_size) {
+            auto large = lhs.begin();
+            for (auto it = rhs.begin(); it != rhs.end() && large != lhs.end(); ++it) {
+                large = detail::gallop_lower_bound(large, lhs.end(), *it, comp);
+                if (large != lhs.end() && !comp(*it, *large)) {
+                    result.push_back(*large);
+                    ++large;
+                }
+            }
+            return detail::make_presorted<Container1, Compare>(std::move(result));
+        }
+    }
+
+    if constexpr (std::is_same<value_type, std::uint32_t>::value &&
+                  sorted<Container1, Compare>::is_simd_searchable::value &&
+                  sorted<Container2, Compare>::is_simd_searchable::value) {
+        // the block comparison would report duplicates once per duplicate of the other side
+        if (detail::is_strictly_increasing(lhs.begin(), lhs.end(), comp) &&
+            detail::is_strictly_increasing(rhs.begin(), rhs.end(), comp)) {
+            result.resize(std::min(lhs_size, rhs_size));
+            result.resize(
+                detail::intersect(lhs.data(), lhs_size, rhs.data(), rhs_size, result.data()));
+            return detail::make_presorted<Container1, Compare>(std::move(result));
+        }
+    }
+
+    std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          std::back_inserter(result), comp);
+    return detail::make_presorted<Container1, Compare>(std::move(result));
+}
+
+/**
+ * Computes the sorted union of two sorted containers, with std::set_union semantics: an element
+ * present m times in lhs and n times in rhs is present max(m, n) times in the result, preferring
+ * the elements of lhs.
+ *
+ * If one container is much smaller, the runs of the larger container between its elements are
+ * found by galloping and copied as a whole. Otherwise the containers are merged linearly.
+ *
+ * @snippet test/set_operations.test.cpp set_union
+ * @param lhs the first sorted container
+ * @param rhs the second sorted container, ordered by the same comparison
+ * @return a sorted container of the same type as lhs with the elements of both containers
+ */
+template <class Container1, class Container2, class Compare>
+auto set_union(const sorted<Container1, Compare>& lhs, const sorted<Container2, Compare>& rhs)
+    -> sorted<Container1, Compare> {
+    using value_type = typename Container1::value_type;
+
+    const auto comp = lhs.key_comp();
+    const auto lhs_size = lhs.size();
+    const auto rhs_size = rhs.size();
+    std::vector<value_type> result;
+    result.reserve(lhs_size + rhs_size);
+
+    if constexpr (detail::has_random_access<Container1>::value &&
+                  detail::has_random_access<Container2>::value) {
+        if (lhs_size * detail::gallop_ratio <= rhs_size) {
+            auto large = rhs.begin();
+            for (auto it = lhs.begin(); it != lhs.end(); ++it) {
+                const auto bound = detail::gallop_lower_bound(large, rhs.end(), *it, comp);
+                result.insert(result.end(), large, bound);
+                large = bound;
+                result.push_back(*it);
+                if (large != rhs.end() && !comp(*it, *large)) {
+                    ++large;
+                }
+            }
+            result.insert(result.end(), large, rhs.end());
+            return detail::make_presorted<Container1, Compare>(std::move(result));
+        }
+
+        if (rhs_size * detail::gallop_ratio <= lhs_size) {
+            auto large = lhs.begin();
+            for (auto it = rhs.begin(); it != rhs.end(); ++it) {
+                const auto bound = detail::gallop_lower_bound(large, lhs.end(), *it, comp);
+                result.insert(result.end(), large, bound);
+                large = bound;
+                if (large != lhs.end() && !comp(*it, *large)) {
+                    result.push_back(*large);
+                    ++large;
+                } else {
+                    result.push_back(*it);
+                }
+            }
+            result.insert(result.end(), large, lhs.end());
+            return detail::make_presorted<Container1, Compare>(std::move(result));
+        }
+    }
+
+    std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result),
+                   comp);
+    return detail::make_presorted<Container1, Compare>(std::move(result));
+}
+
+/**
+ * Computes the sorted difference of two sorted containers, with std::set_difference semantics: an
+ * element present m times in lhs and n times in rhs is present max(m - n, 0) times in the result.
+ *
+ * If one container is much smaller, its elements are searched in the larger one by galloping.
+ * Otherwise the containers are merged linearly.
+ *
+ * @snippet test/set_operations.test.cpp set_difference
+ * @param lhs the sorted container to take the elements from
+ * @param rhs the sorted container of the elements to leave out, ordered by the same comparison
+ * @return a sorted container of the same type as lhs with the elements only present in lhs
+ */
+template <class Container1, class Container2, class Compare>
+auto set_difference(const sorted<Container1, Compare>& lhs, const sorted<Container2, Compare>& rhs)
+    -> sorted<Container1, Compare> {
+    using value_type = typename Container1::value_type;
+
+    const auto comp = lhs.key_comp();
+    const auto lhs_size = lhs.size();
+    const auto rhs_size = rhs.size();
+    std::vector<value_type> result;
+
+    if constexpr (detail::has_random_access<Container1>::value &&
+                  detail::has_random_access<Container2>::value) {
+        if (lhs_size * detail::gallop_ratio <= rhs_size) {
+            auto large = rhs.begin();
+            for (auto it = lhs.begin(); it != lhs.end(); ++it) {
+                large = detail::gallop_lower_bound(large, rhs.end(), *it, comp);
+                if (large != rhs.end() && !comp(*it, *large)) {
+                    ++large;
+                } else {
+                    result.push_back(*it);
+                }
+            }
+            return detail::make_presorted<Container1, Compare>(std::move(result));
+        }
+
+        if (rhs_size * detail::gallop_ratio <= lhs_size) {
+            result.reserve(lhs_size);
+            auto large = lhs.begin();
+            for (auto it = rhs.begin(); it != rhs.end(); ++it) {
+                const auto bound = detail::gallop_lower_bound(large, lhs.end(), *it, comp);
+                result.insert(result.end(), large, bound);
+                large = bound;
+                if (large != lhs.end() && !comp(*it, *large)) {
+                    ++large;
+                }
+            }
+            result.insert(result.end(), large, lhs.end());
+            return detail::make_presorted<Container1, Compare>(std::move(result));
+        }
+    }
+
+    std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                        std::back_inserter(result), comp);
+    return detail::make_presorted<Container1, Compare>(std::move(result));
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_SET_OPERATIONS_HEADER_IS_ALREADY_INCLUDED
@@ -4,23 +4,548 @@
 #ifndef THAT_THIS_UTIL_SHARED_HEADER_IS_ALREADY_INCLUDED
 #define THAT_THIS_UTIL_SHARED_HEADER_IS_ALREADY_INCLUDED
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
+#include "scoped.hpp"
+
 namespace util {
 
-template <class T>
+/**
+ * A plain reference counter for util::shared instances which never leave the thread that created
+ * them. This is the default and as cheap as counting gets.
+ */
+class local_count {
+public:
+    constexpr explicit local_count(std::size_t initial = 0) noexcept : count(initial) {}
+
+    void increment() noexcept { ++count; }
+    auto decrement() noexcept -> bool { return --count == 0; }
+    auto increment_if_nonzero() noexcept -> bool { return count != 0 && ++count != 0; }
+    auto load() const noexcept -> std::size_t { return count; }
+
+private:
+    std::size_t count;
+};
+
+/**
+ * A thread-safe reference counter which allows copies of a util::shared instance to be passed
+ * between and destroyed on different threads.
+ *
+ * Increments are relaxed since a new reference can only be made from an existing one, which
+ * already keeps the object alive. Decrements release the writes of the destroying thread and the
+ * last one acquires all of them before the object is deleted. Increments from zero are refused, so
+ * that a util::weak reference cannot revive an object which is being deleted.
+ */
+class atomic_count {
+public:
+    constexpr explicit atomic_count(std::size_t initial = 0) noexcept : count(initial) {}
+
+    void increment() noexcept { count.fetch_add(1, std::memory_order_relaxed); }
+    auto decrement() noexcept -> bool { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    auto increment_if_nonzero() noexcept -> bool {
+        auto current = count.load(std::memory_order_relaxed);
+        while (current != 0 && !count.compare_exchange_weak(current, current + 1,
+                                                            std::memory_order_relaxed)) {
+        }
+        return current != 0;
+    }
+    auto load() const noexcept -> std::size_t { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::size_t> count;
+};
+
+namespace detail {
+
+template <class Count>
+class control_block;
+
+class biased_owner;
+
+}  // namespace detail
+
+/**
+ * A reference counting mode for util::shared objects which are mostly used by the thread that
+ * created them but may be passed to other threads (biased reference counting).
+ *
+ * The creating thread owns the counter and counts its references without atomic instructions,
+ * other threads count theirs in a separate atomic counter. When the owner releases its last
+ * reference, it merges both counters and the object is counted like with util::atomic_count from
+ * then on. If other threads release more references than they made while the owner still counts
+ * some, e.g. the last copies of an object the owner handed over, the counter is queued to the
+ * owner instead, which merges it when it creates the next object with this mode, calls collect()
+ * or exits. Until then such an object outlives its last reference. Weak references are counted
+ * atomically. Only usable with util::shared and util::weak.
+ */
+class biased_count {
+public:
+    static void collect() noexcept;
+
+private:
+    friend class detail::control_block<biased_count>;
+
+    // the remote counter holds the references of other threads in steps of one and two flags
+    static constexpr std::intptr_t merged = 1;
+    static constexpr std::intptr_t queued = 2;
+    static constexpr std::intptr_t one = 4;
+
+    explicit biased_count(std::size_t initial) noexcept;
+
+    auto owned() const noexcept -> bool;
+
+    detail::biased_owner* owner;
+    std::atomic<std::size_t> local;  // written by the owner only, 0 once merged
+    std::atomic<std::intptr_t> remote;
+};
+
+namespace detail {
+
+/**
+ * The part of a util::shared allocation which is shared by all instances managing the same object.
+ * The derived blocks know how to dispose of the object and how to free themselves.
+ *
+ * The object is disposed with the last util::shared instance, the block is freed with the last
+ * util::weak instance. All util::shared instances together hold one weak reference, so freeing the
+ * block takes a single decrement unless there are actual weak references.
+ */
+template <class Count>
+class control_block {
+public:
+    control_block() noexcept : uses(1), weaks(1) {}
+    control_block(const control_block&) = delete;
+    auto operator=(const control_block&) -> control_block& = delete;
+    virtual ~control_block() = default;
+
+    virtual void dispose() noexcept = 0;
+    virtual void destroy() noexcept = 0;
+
+    void add_use() noexcept { uses.increment(); }
+    auto add_use_if_alive() noexcept -> bool { return uses.increment_if_nonzero(); }
+    void release_use() noexcept {
+        if (uses.decrement()) {
+            dispose();
+            release_weak();
+        }
+    }
+    void add_weak() noexcept { weaks.increment(); }
+    void release_weak() noexcept {
+        if (weaks.decrement()) {
+            destroy();
+        }
+    }
+    auto use_count() const noexcept -> std::size_t { return uses.load(); }
+
+private:
+    Count uses;
+    Count weaks;
+};
+
+/**
+ * The control block of biased counted objects, see util::biased_count. Objects are disposed when
+ * the merged counter reaches zero without being queued, by whichever thread gets it there.
+ */
+template <>
+class control_block<biased_count> {
+public:
+    control_block() noexcept : uses(1), weaks(1) {}
+    control_block(const control_block&) = delete;
+    auto operator=(const control_block&) -> control_block& = delete;
+    virtual ~control_block() = default;
+
+    virtual void dispose() noexcept = 0;
+    virtual void destroy() noexcept = 0;
+
+    void add_use() noexcept;
+    auto add_use_if_alive() noexcept -> bool;
+    void release_use() noexcept;
+    void add_weak() noexcept { weaks.increment(); }
+    void release_weak() noexcept {
+        if (weaks.decrement()) {
+            destroy();
+        }
+    }
+    auto use_count() const noexcept -> std::size_t;
+
+private:
+    friend class biased_owner;
+
+    auto release_remote() noexcept -> bool;
+    void merge_queued() noexcept;
+
+    biased_count uses;
+    atomic_count weaks;
+    control_block* next_queued = nullptr;
+};
+
+/**
+ * The record of a thread owning biased counters. It queues the counters other threads hand back.
+ * Records are never reused or freed, since counters keep pointing to them after their thread
+ * exited, they are kept in a list of all records instead.
+ */
+class biased_owner {
+public:
+    static auto current() noexcept -> biased_owner*;
+    static auto adopted() noexcept -> biased_owner*;
+
+    void push(control_block<biased_count>* block) noexcept;
+    void drain() noexcept;
+    void collect() noexcept;
+
+private:
+    // the record of this thread, trivially destructible to stay usable at thread exit
+    struct thread_state {
+        biased_owner* record = nullptr;
+        bool exited = false;
+    };
+
+    // merges all queued counters when the thread exits, later ones are merged by their queuers
+    struct exit_guard {
+        exit_guard() = default;
+        exit_guard(const exit_guard&) = delete;
+        auto operator=(const exit_guard&) -> exit_guard& = delete;
+        ~exit_guard();
+    };
+
+    static auto state() noexcept -> thread_state&;
+    static auto head() noexcept -> std::atomic<biased_owner*>&;
+
+    std::atomic<control_block<biased_count>*> queue{nullptr};
+    std::atomic<bool> exited{false};
+    biased_owner* next = nullptr;
+};
+
+/**
+ * Returns the record of this thread, which is created on first use. Null if it could not be
+ * allocated or the thread is exiting.
+ */
+inline auto biased_owner::current() noexcept -> biased_owner* {
+    auto& local = state();
+    if (!local.record && !local.exited) {
+        auto* created = new (std::nothrow) biased_owner();
+        if (!created) {
+            return nullptr;
+        }
+
+        created->next = head().load(std::memory_order_relaxed);
+        while (!head().compare_exchange_weak(created->next, created, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+        local.record = created;
+        static thread_local const exit_guard guard;
+    }
+    return local.record;
+}
+
+/**
+ * Returns the record of this thread without creating it.
+ */
+inline auto biased_owner::adopted() noexcept -> biased_owner* {
+    return state().record;
+}
+
+/**
+ * Queues a counter which other threads released below zero, called by the thread which did so.
+ * Once the owner exited, the caller merges it instead.
+ */
+inline void biased_owner::push(control_block<biased_count>* block) noexcept {
+    block->next_queued = this->queue.load(std::memory_order_relaxed);
+    while (!this->queue.compare_exchange_weak(block->next_queued, block)) {
+    }
+
+    // either the exiting owner takes the queue after this push or this thread sees it exited
+    if (this->exited.load()) {
+        this->drain();
+    }
+}
+
+/**
+ * Merges all queued counters. Called by the owner or, after it exited, by the queuing threads.
+ */
+inline void biased_owner::drain() noexcept {
+    auto* block = this->queue.exchange(nullptr);
+    while (block) {
+        auto* next = block->next_queued;
+        block->merge_queued();
+        block = next;
+    }
+}
+
+/**
+ * Merges all queued counters if there are any, called by the owner.
+ */
+inline void biased_owner::collect() noexcept {
+    if (this->queue.load(std::memory_order_relaxed)) {
+        this->drain();
+    }
+}
+
+inline biased_owner::exit_guard::~exit_guard() {
+    auto& local = state();
+    local.exited = true;
+    if (auto* record = std::exchange(local.record, nullptr)) {
+        record->exited.store(true);
+        record->drain();
+    }
+}
+
+inline auto biased_owner::state() noexcept -> thread_state& {
+    static thread_local thread_state local;
+    return local;
+}
+
+inline auto biased_owner::head() noexcept -> std::atomic<biased_owner*>& {
+    static std::atomic<biased_owner*> first{nullptr};
+    return first;
+}
+
+inline void control_block<biased_count>::add_use() noexcept {
+    if (uses.owned()) {
+        uses.local.store(uses.local.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    } else {
+        uses.remote.fetch_add(biased_count::one, std::memory_order_relaxed);
+    }
+}
+
+inline auto control_block<biased_count>::add_use_if_alive() noexcept -> bool {
+    // an unmerged object is only disposed by its owner, so it can always be revived
+    if (uses.owned()) {
+        this->add_use();
+        return true;
+    }
+
+    constexpr auto released = biased_count::merged | biased_count::queued;
+    auto current = uses.remote.load(std::memory_order_relaxed);
+    while ((current | biased_count::queued) != released &&
+           !uses.remote.compare_exchange_weak(current, current + biased_count::one,
+                                              std::memory_order_relaxed)) {
+    }
+    return (current | biased_count::queued) != released;
+}
+
+inline void control_block<biased_count>::release_use() noexcept {
+    if (uses.owned()) {
+        const auto left = uses.local.load(std::memory_order_relaxed) - 1;
+        uses.local.store(left, std::memory_order_relaxed);
+        if (left != 0) {
+            return;
+        }
+        // the last local reference merges, other threads still count theirs or queued the block
+        if (uses.remote.fetch_add(biased_count::merged, std::memory_order_acq_rel) != 0) {
+            return;
+        }
+    } else if (!this->release_remote()) {
+        return;
+    }
+
+    dispose();
+    release_weak();
+}
+
+inline auto control_block<biased_count>::use_count() const noexcept -> std::size_t {
+    const auto count = static_cast<std::intptr_t>(uses.local.load(std::memory_order_relaxed)) +
+                       (uses.remote.load(std::memory_order_relaxed) >> 2);
+    return count > 0 ? static_cast<std::size_t>(count) : 0;
+}
+
+/**
+ * Releases a reference of another thread and queues the counter to its owner if other threads
+ * released more references than they made before it merged.
+ */
+inline auto control_block<biased_count>::release_remote() noexcept -> bool {
+    auto current = uses.remote.load(std::memory_order_relaxed);
+    auto next = current;
+    do {
+        next = current - biased_count::one;
+        if ((current & (biased_count::merged | biased_count::queued)) == 0 && next < 0) {
+            next |= biased_count::queued;
+        }
+    } while (!uses.remote.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed));
+
+    if ((next & ~current & biased_count::queued) != 0) {
+        uses.owner->push(this);
+        return false;
+    }
+    return next == biased_count::merged;
+}
+
+/**
+ * Merges the counters of a queued block and disposes the object if no references are left.
+ */
+inline void control_block<biased_count>::merge_queued() noexcept {
+    const auto local = static_cast<std::intptr_t>(uses.local.load(std::memory_order_relaxed));
+    uses.local.store(0, std::memory_order_relaxed);
+
+    const auto delta = (local != 0 ? local * biased_count::one + biased_count::merged : 0) -
+                       biased_count::queued;
+    if (uses.remote.fetch_add(delta, std::memory_order_acq_rel) + delta == biased_count::merged) {
+        dispose();
+        release_weak();
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Merges the counters other threads queued to the calling thread, so that objects whose last
+ * reference they released are disposed now.
+ */
+inline void biased_count::collect() noexcept {
+    if (auto* record = detail::biased_owner::adopted()) {
+        record->collect();
+    }
+}
+
+/**
+ * Creates a counter owned by the calling thread and merges the counters queued to it meanwhile.
+ * Without a thread record the counter starts merged.
+ */
+inline biased_count::biased_count(std::size_t initial) noexcept
+    : owner(detail::biased_owner::current()), local(0), remote(merged) {
+    if (this->owner) {
+        this->local.store(initial, std::memory_order_relaxed);
+        this->remote.store(0, std::memory_order_relaxed);
+        this->owner->collect();
+    } else {
+        this->remote.store(static_cast<std::intptr_t>(initial) * one + merged,
+                           std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Checks if the calling thread owns the counter and still counts its references locally.
+ */
+inline auto biased_count::owned() const noexcept -> bool {
+    return this->owner == detail::biased_owner::adopted() &&
+           this->local.load(std::memory_order_relaxed) != 0;
+}
+
+namespace detail {
+
+/**
+ * A control block for an object which was allocated separately and is disposed by calling the
+ * given deleter with its pointer. Empty deleters like std::default_delete take no space.
+ */
+template <class T, class Count, class Deleter>
+class pointer_block final : public control_block<Count>, private deleter_storage<Deleter> {
+public:
+    pointer_block(T* ptr, Deleter&& deleter) noexcept
+        : deleter_storage<Deleter>(std::move(deleter)), ptr(ptr) {}
+
+    void dispose() noexcept override { this->deleter()(ptr); }
+    void destroy() noexcept override { delete this; }
+
+private:
+    T* ptr;
+};
+
+/**
+ * A control block which holds the object itself, i.e. object and counter share one allocation and
+ * usually one cache line.
+ */
+template <class T, class Count>
+class inplace_block final : public control_block<Count> {
+public:
+    template <class... Args>
+    explicit inplace_block(Args&&... args) : value(std::forward<Args>(args)...) {}
+    ~inplace_block() override {}  // NOLINT(modernize-use-equals-default), the value is disposed
+
+    auto get() noexcept -> T* { return &value; }
+    void dispose() noexcept override { value.~T(); }
+    void destroy() noexcept override { delete this; }
+
+private:
+    union {
+        T value;
+    };
+};
+
+/**
+ * A control block which holds the object itself and was allocated by the given allocator, which it
+ * keeps to free itself.
+ */
+template <class T, class Count, class Allocator>
+class allocated_block final : public control_block<Count> {
+public:
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<allocated_block>;
+
+    template <class... Args>
+    explicit allocated_block(const allocator_type& allocator, Args&&... args)
+        : allocator(allocator), value(std::forward<Args>(args)...) {}
+    ~allocated_block() override {}  // NOLINT(modernize-use-equals-default), the value is disposed
+
+    auto get() noexcept -> T* { return &value; }
+    void dispose() noexcept override { value.~T(); }
+    void destroy() noexcept override {
+        allocator_type copy(allocator);
+        this->~allocated_block();
+        std::allocator_traits<allocator_type>::deallocate(copy, this, 1);
+    }
+
+private:
+    allocator_type allocator;
+    union {
+        T value;
+    };
+};
+
+}  // namespace detail
+
+template <class T, class Count = local_count>
+class shared;
+
+template <class T, class Count = local_count>
+class weak;
+
+template <class T, class Count>
+class atomic_shared;
+
+template <class T, class Count = local_count, class... Args>
+auto make_shared(Args&&... args) -> shared<T, Count>;
+
+template <class T, class Count = local_count, class Allocator, class... Args>
+auto allocate_shared(const Allocator& allocator, Args&&... args) -> shared<T, Count>;
+
+/**
+ * A reference counted pointer which deletes the managed object with its last reference.
+ *
+ * Empty instances allocate nothing, util::make_shared allocates the object together with its
+ * counter in a single block. Objects can be released by custom deleters instead of `delete`, and
+ * instances can point to a sub-object while sharing ownership of the whole object.
+ *
+ * @tparam T the type of the managed object
+ * @tparam Count the reference counter, util::local_count (the default), util::atomic_count for
+ *         instances shared between threads or util::biased_count for instances mostly used by the
+ *         creating thread
+ */
+template <class T, class Count>
 class shared {
 public:
-    constexpr shared() = default;
+    using element_type = T;
+    using count_type = Count;
+
+    constexpr shared() noexcept = default;
     constexpr shared(std::nullptr_t) noexcept;
-    shared(T* ptr) noexcept;
+    shared(T* ptr);
+    template <class Deleter>
+    shared(T* ptr, Deleter deleter);
+    template <class U>
+    shared(const shared<U, Count>& owner, T* ptr) noexcept;
+    template <class U>
+    shared(shared<U, Count>&& owner, T* ptr) noexcept;
     shared(shared&& other) noexcept;
-    shared(const shared& other);
+    shared(const shared& other) noexcept;
     ~shared();
 
     auto operator=(shared&& other) noexcept -> shared&;
-    auto operator=(const shared& other) -> shared&;
+    auto operator=(const shared& other) noexcept -> shared&;
 
     auto operator->() const noexcept -> T*;
     auto operator*() const noexcept -> T&;
@@ -28,54 +553,134 @@ public:
 
     auto get() const noexcept -> T*;
     auto use_count() const noexcept -> std::size_t;
+    void swap(shared& other) noexcept;
 
 private:
+    template <class U, class C>
+    friend class shared;
+
+    friend class weak<T, Count>;
+    friend class atomic_shared<T, Count>;
+
+    template <class U, class C, class... Args>
+    friend auto make_shared(Args&&... args) -> shared<U, C>;
+
+    template <class U, class C, class Allocator, class... Args>
+    friend auto allocate_shared(const Allocator& allocator, Args&&... args) -> shared<U, C>;
+
+    shared(detail::control_block<Count>* block, T* ptr) noexcept;
+
+    void release() noexcept;
+
     T* ptr = nullptr;
-    std::size_t* ref = new std::size_t(0);
+    detail::control_block<Count>* block = nullptr;
 };
 
-template <class T, class... Args>
-auto make_shared(Args&&... args) -> shared<T>;
-
 /**
  * Constructs a shared object from a nullpointer.
  */
-template <class T>
-constexpr shared<T>::shared(std::nullptr_t) noexcept : shared() {}
+template <class T, class Count>
+constexpr shared<T, Count>::shared(std::nullptr_t) noexcept : shared() {}
+
+/**
+ * Constructs a shared object from a given pointer. A nullpointer allocates nothing, otherwise the
+ * control block is allocated separately from the object. If that allocation throws, the object is
+ * deleted.
+ */
+template <class T, class Count>
+shared<T, Count>::shared(T* ptr) : shared(ptr, std::default_delete<T>()) {}
+
+/**
+ * Constructs a shared object from a given pointer which is released by calling the given deleter
+ * instead of `delete`, e.g. for objects from arenas, memory mappings or C libraries. The deleter
+ * is stored in the control block, empty deleters take no space there. A nullpointer allocates
+ * nothing and is never passed to the deleter. If allocating the control block throws, the deleter
+ * is called with the pointer.
+ *
+ * @code{.cpp}
+ * util::shared<std::FILE> file(std::fopen("log.txt", "r"), &std::fclose);
+ * @endcode
+ *
+ * @tparam Deleter the type of the deleter, callable with the pointer
+ * @param ptr the object to manage or a nullpointer
+ * @param deleter the deleter releasing the object
+ */
+template <class T, class Count>
+template <class Deleter>
+shared<T, Count>::shared(T* ptr, Deleter deleter) : ptr(ptr) {
+    if (ptr) {
+        try {
+            this->block = new detail::pointer_block<T, Count, Deleter>(ptr, std::move(deleter));
+        } catch (...) {
+            deleter(ptr);
+            throw;
+        }
+    }
+}
+
+/**
+ * Constructs a shared instance which points to the given object but shares ownership with another
+ * shared instance (aliasing), e.g. to hand out slices of a large shared buffer without copying.
+ * The owned object lives as long as any of the instances sharing it.
+ *
+ * @code{.cpp}
+ * auto buffer = util::make_shared<std::array<char, 4096>>();
+ * util::shared<char> second_half(buffer, buffer->data() + 2048);
+ * @endcode
+ *
+ * @param owner the shared instance whose ownership is shared
+ * @param ptr the pointer to store, usually a member or part of the owned object
+ */
+template <class T, class Count>
+template <class U>
+shared<T, Count>::shared(const shared<U, Count>& owner, T* ptr) noexcept
+    : ptr(ptr), block(owner.block) {
+    if (this->block) {
+        this->block->add_use();
+    }
+}
+
+/**
+ * Constructs a shared instance which points to the given object and takes over the ownership of
+ * another moved shared instance, which is unassigned.
+ *
+ * @param owner the shared instance whose ownership is taken over
+ * @param ptr the pointer to store, usually a member or part of the owned object
+ */
+template <class T, class Count>
+template <class U>
+shared<T, Count>::shared(shared<U, Count>&& owner, T* ptr) noexcept : ptr(ptr), block(owner.block) {
+    owner.ptr = nullptr;
+    owner.block = nullptr;
+}
 
 /**
- * Constructs a shared object from a given pointer.
+ * Constructs a shared object taking over an already counted reference of the given block.
  */
-template <class T>
-shared<T>::shared(T* ptr) noexcept : ptr(ptr), ref(new std::size_t(1)) {}
+template <class T, class Count>
+shared<T, Count>::shared(detail::control_block<Count>* block, T* ptr) noexcept
+    : ptr(ptr), block(block) {}
 
 /**
  * Destroys a shared object instance and decreases the reference counter. If the reference counter
  * reaches zero (i.e. this is the last reference to the managed instance) then the managed instance
  * will be deleted.
  */
-template <class T>
-shared<T>::~shared() {
-    (*this->ref)--;
-
-    if (*this->ref == 0) {
-        delete this->ptr;
-        delete this->ref;
-    }
+template <class T, class Count>
+shared<T, Count>::~shared() {
+    this->release();
 }
 
 /**
  * Constructs a shared instance from another moved shared instance. The moved instance's pointer and
- * reference counter are unassigned.
+ * control block are unassigned.
  *
  * @param other another shared instance
  */
-template <class T>
-shared<T>::shared(shared&& other) noexcept {
-    this->ptr = other.ptr;
-    this->ref = other.ref;
+template <class T, class Count>
+shared<T, Count>::shared(shared&& other) noexcept : ptr(other.ptr), block(other.block) {
     other.ptr = nullptr;
-    other.ref = nullptr;
+    other.block = nullptr;
 }
 
 /**
@@ -83,28 +688,22 @@ shared<T>::shared(shared&& other) noexcept {
  *
  * @param other another shared instance
  */
-template <class T>
-shared<T>::shared(const shared& other) {
-    this->ptr = other.ptr;
-    this->ref = other.ref;
-
-    if (other.ptr) {
-        (*this->ref)++;
+template <class T, class Count>
+shared<T, Count>::shared(const shared& other) noexcept : ptr(other.ptr), block(other.block) {
+    if (this->block) {
+        this->block->add_use();
     }
 }
 
 /**
- * Assigns a moved shared instance. The moved instance's pointer and reference counter are
- * unassigned.
+ * Assigns a moved shared instance. The previously managed object is released and the moved
+ * instance's pointer and control block are unassigned.
  *
  * @return a reference to this instance
  */
-template <class T>
-auto shared<T>::operator=(shared&& other) noexcept -> shared<T>& {
-    this->ptr = other.ptr;
-    this->ref = other.ref;
-    other.ptr = nullptr;
-    other.ref = nullptr;
+template <class T, class Count>
+auto shared<T, Count>::operator=(shared&& other) noexcept -> shared<T, Count>& {
+    shared(std::move(other)).swap(*this);
 
     return *this;
 }
@@ -114,22 +713,10 @@ auto shared<T>::operator=(shared&& other) noexcept -> shared<T>& {
  *
  * @return a reference to this instance
  */
-template <class T>
-auto shared<T>::operator=(const shared& other) -> shared<T>& {
+template <class T, class Count>
+auto shared<T, Count>::operator=(const shared& other) noexcept -> shared<T, Count>& {
     if (this != &other) {
-        (*this->ref)--;
-
-        if (*this->ref == 0) {
-            delete this->ptr;
-            delete this->ref;
-        }
-
-        this->ptr = other.ptr;
-        this->ref = other.ref;
-
-        if (other.ptr) {
-            (*this->ref)++;
-        }
+        shared(other).swap(*this);
     }
 
     return *this;
@@ -140,8 +727,8 @@ auto shared<T>::operator=(const shared& other) -> shared<T>& {
  *
  * @return the stored pointer, i.e., `get()`
  */
-template <class T>
-auto shared<T>::operator->() const noexcept -> T* {
+template <class T, class Count>
+auto shared<T, Count>::operator->() const noexcept -> T* {
     return this->ptr;
 }
 
@@ -150,8 +737,8 @@ auto shared<T>::operator->() const noexcept -> T* {
  *
  * @return the dereferenced stored pointer, i.e., `*get()`
  */
-template <class T>
-auto shared<T>::operator*() const noexcept -> T& {
+template <class T, class Count>
+auto shared<T, Count>::operator*() const noexcept -> T& {
     return *this->ptr;
 }
 
@@ -160,8 +747,8 @@ auto shared<T>::operator*() const noexcept -> T& {
  *
  * @return true if the stored pointer is null or false if not
  */
-template <class T>
-shared<T>::operator bool() const noexcept {
+template <class T, class Count>
+shared<T, Count>::operator bool() const noexcept {
     return this->ptr != nullptr;
 }
 
@@ -170,37 +757,284 @@ shared<T>::operator bool() const noexcept {
  *
  * @return the stored pointer
  */
-template <class T>
-auto shared<T>::get() const noexcept -> T* {
+template <class T, class Count>
+auto shared<T, Count>::get() const noexcept -> T* {
     return this->ptr;
 }
 
 /**
  * Returns the number of different shared_ptr instances (this included) managing the current object.
- * If there is no managed object, ​0​ is returned.
+ * If there is no managed object, ​0​ is returned. With util::atomic_count the result is only a
+ * snapshot as other threads may copy or destroy instances at the same time.
  *
  * @return the number of util::shared instances managing the current object or ​0​ if there is
  *         no managed object
  */
-template <class T>
-auto shared<T>::use_count() const noexcept -> std::size_t {
-    return *this->ref;
+template <class T, class Count>
+auto shared<T, Count>::use_count() const noexcept -> std::size_t {
+    return this->block ? this->block->use_count() : 0;
+}
+
+/**
+ * Exchanges the managed objects of two shared instances without touching the reference counters.
+ *
+ * @param other another shared instance
+ */
+template <class T, class Count>
+void shared<T, Count>::swap(shared& other) noexcept {
+    std::swap(this->ptr, other.ptr);
+    std::swap(this->block, other.block);
+}
+
+/**
+ * Decreases the reference counter and deletes the managed object if this was its last reference.
+ */
+template <class T, class Count>
+void shared<T, Count>::release() noexcept {
+    if (this->block) {
+        this->block->release_use();
+    }
 }
 
 /**
- * Constructs an object of type T and wraps it in a std::shared_ptr using args as the parameter list
- * for the constructor of T.
+ * Constructs an object of type T and wraps it in a util::shared using args as the parameter list
+ * for the constructor of T. The object and its reference counter are allocated in one block.
  *
  * @tparam T the type of object to construct
+ * @tparam Count the reference counter of the returned instance
  * @tparam Args the types of arguments for the constructor of T
  * @param args a list of arguments with which an instance of T will be constructed
  * @return an util::shared object of an instance of type T
  */
-template <class T, class... Args>
-auto make_shared(Args&&... args) -> shared<T> {
-    return shared<T>(new T(std::move(args...)));
+template <class T, class Count, class... Args>
+auto make_shared(Args&&... args) -> shared<T, Count> {
+    auto* block = new detail::inplace_block<T, Count>(std::forward<Args>(args)...);
+    return shared<T, Count>(block, block->get());
+}
+
+/**
+ * Constructs an object of type T like util::make_shared, but allocates the block of object and
+ * reference counter with the given allocator, which is rebound to the type of the block.
+ *
+ * @tparam T the type of object to construct
+ * @tparam Count the reference counter of the returned instance
+ * @tparam Allocator the type of the allocator
+ * @tparam Args the types of arguments for the constructor of T
+ * @param allocator the allocator for the block, a copy of it will free the block again
+ * @param args a list of arguments with which an instance of T will be constructed
+ * @return an util::shared object of an instance of type T
+ */
+template <class T, class Count, class Allocator, class... Args>
+auto allocate_shared(const Allocator& allocator, Args&&... args) -> shared<T, Count> {
+    using block_type = detail::allocated_block<T, Count, Allocator>;
+    using traits = std::allocator_traits<typename block_type::allocator_type>;
+
+    typename block_type::allocator_type block_allocator(allocator);
+    auto* block = traits::allocate(block_allocator, 1);
+    try {
+        ::new (static_cast<void*>(block)) block_type(block_allocator, std::forward<Args>(args)...);
+    } catch (...) {
+        traits::deallocate(block_allocator, block, 1);
+        throw;
+    }
+
+    return shared<T, Count>(block, block->get());
+}
+
+/**
+ * A non-owning reference to an object managed by util::shared. It does not keep the object alive,
+ * but can tell whether it still exists and temporarily take ownership of it with lock().
+ *
+ * The managed object is destroyed with its last util::shared instance even if weak references
+ * remain. Only the control block stays until the last weak reference is gone, which for objects
+ * created by util::make_shared includes the memory of the object itself.
+ *
+ * @code{.cpp}
+ * auto config = util::make_shared<std::string>("verbose");
+ * util::weak<std::string> observer(config);
+ * @endcode
+ *
+ * @tparam T the type of the managed object
+ * @tparam Count the reference counter, the same as of the observed util::shared instances
+ */
+template <class T, class Count>
+class weak {
+public:
+    constexpr weak() noexcept = default;
+    weak(const shared<T, Count>& owner) noexcept;
+    weak(weak&& other) noexcept;
+    weak(const weak& other) noexcept;
+    ~weak();
+
+    auto operator=(weak&& other) noexcept -> weak&;
+    auto operator=(const weak& other) noexcept -> weak&;
+    auto operator=(const shared<T, Count>& owner) noexcept -> weak&;
+
+    auto lock() const noexcept -> shared<T, Count>;
+    auto expired() const noexcept -> bool;
+    auto use_count() const noexcept -> std::size_t;
+    void reset() noexcept;
+    void swap(weak& other) noexcept;
+
+private:
+    void acquire() noexcept;
+    void release() noexcept;
+
+    T* ptr = nullptr;
+    detail::control_block<Count>* block = nullptr;
+};
+
+/**
+ * Constructs a weak reference to the object managed by a util::shared instance.
+ *
+ * @param owner the shared instance managing the object, may be empty
+ */
+template <class T, class Count>
+weak<T, Count>::weak(const shared<T, Count>& owner) noexcept : ptr(owner.ptr), block(owner.block) {
+    this->acquire();
+}
+
+/**
+ * Constructs a weak reference from another moved weak reference, which is unassigned.
+ *
+ * @param other another weak reference
+ */
+template <class T, class Count>
+weak<T, Count>::weak(weak&& other) noexcept : ptr(other.ptr), block(other.block) {
+    other.ptr = nullptr;
+    other.block = nullptr;
+}
+
+/**
+ * Constructs a weak reference to the same object as another weak reference.
+ *
+ * @param other another weak reference
+ */
+template <class T, class Count>
+weak<T, Count>::weak(const weak& other) noexcept : ptr(other.ptr), block(other.block) {
+    this->acquire();
+}
+
+/**
+ * Destroys the weak reference and frees the control block if this was the last reference to it.
+ */
+template <class T, class Count>
+weak<T, Count>::~weak() {
+    this->release();
+}
+
+/**
+ * Assigns a moved weak reference, which is unassigned.
+ *
+ * @return a reference to this instance
+ */
+template <class T, class Count>
+auto weak<T, Count>::operator=(weak&& other) noexcept -> weak<T, Count>& {
+    weak(std::move(other)).swap(*this);
+
+    return *this;
+}
+
+/**
+ * Assigns a weak reference.
+ *
+ * @return a reference to this instance
+ */
+template <class T, class Count>
+auto weak<T, Count>::operator=(const weak& other) noexcept -> weak<T, Count>& {
+    if (this != &other) {
+        weak(other).swap(*this);
+    }
+
+    return *this;
+}
+
+/**
+ * Assigns a weak reference to the object managed by a util::shared instance.
+ *
+ * @return a reference to this instance
+ */
+template <class T, class Count>
+auto weak<T, Count>::operator=(const shared<T, Count>& owner) noexcept -> weak<T, Count>& {
+    weak(owner).swap(*this);
+
+    return *this;
+}
+
+/**
+ * Takes shared ownership of the referenced object if it still exists. With util::atomic_count this
+ * is safe against other threads releasing the last owner at the same time.
+ *
+ * @return a util::shared instance managing the referenced object or an empty one if it expired
+ */
+template <class T, class Count>
+auto weak<T, Count>::lock() const noexcept -> shared<T, Count> {
+    if (this->block && this->block->add_use_if_alive()) {
+        return shared<T, Count>(this->block, this->ptr);
+    }
+
+    return shared<T, Count>();
+}
+
+/**
+ * Checks if the referenced object was already destroyed.
+ *
+ * @return true if there is no referenced object (anymore) or false if it still exists
+ */
+template <class T, class Count>
+auto weak<T, Count>::expired() const noexcept -> bool {
+    return this->use_count() == 0;
+}
+
+/**
+ * Returns the number of util::shared instances managing the referenced object.
+ *
+ * @return the number of util::shared instances managing the referenced object or 0 if it expired
+ */
+template <class T, class Count>
+auto weak<T, Count>::use_count() const noexcept -> std::size_t {
+    return this->block ? this->block->use_count() : 0;
+}
+
+/**
+ * Releases the reference, leaving this instance empty.
+ */
+template <class T, class Count>
+void weak<T, Count>::reset() noexcept {
+    weak().swap(*this);
+}
+
+/**
+ * Exchanges the referenced objects of two weak references without touching the reference counters.
+ *
+ * @param other another weak reference
+ */
+template <class T, class Count>
+void weak<T, Count>::swap(weak& other) noexcept {
+    std::swap(this->ptr, other.ptr);
+    std::swap(this->block, other.block);
+}
+
+/**
+ * Increases the weak reference counter of the control block, if any.
+ */
+template <class T, class Count>
+void weak<T, Count>::acquire() noexcept {
+    if (this->block) {
+        this->block->add_weak();
+    }
+}
+
+/**
+ * Decreases the weak reference counter and frees the control block if this was its last reference.
+ */
+template <class T, class Count>
+void weak<T, Count>::release() noexcept {
+    if (this->block) {
+        this->block->release_weak();
+    }
 }
 
 }  // namespace util
 
-#endif  // THAT_THIS_UTIL_SHARED_HEADER_IS_ALREADY_INCLUDED
\ No newline at end of file
+#endif  // THAT_THIS_UTIL_SHARED_HEADER_IS_ALREADY_INCLUDED
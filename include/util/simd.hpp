@@ -0,0 +1,360 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_SIMD_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_SIMD_HEADER_IS_ALREADY_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define UTIL_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace util {
+
+/**
+ * The instruction set extensions usable by the SIMD code paths of the util library.
+ */
+enum class simd_level { scalar, sse42, avx2 };
+
+/**
+ * Detects the best instruction set extension of the running processor. The detection runs once,
+ * further calls return the cached result.
+ *
+ * @return the best supported simd_level, simd_level::scalar on non-x86 platforms or compilers
+ */
+inline auto simd_support() noexcept -> simd_level {
+#ifdef UTIL_SIMD_X86
+    static const simd_level level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return simd_level::avx2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return simd_level::sse42;
+        }
+        return simd_level::scalar;
+    }();
+    return level;
+#else
+    return simd_level::scalar;
+#endif
+}
+
+/**
+ * Checks if the element type has a SIMD accelerated search.
+ */
+template <class T>
+struct is_simd_searchable
+    : std::integral_constant<bool, std::is_same<T, std::uint32_t>::value ||
+                                       std::is_same<T, std::uint64_t>::value ||
+                                       std::is_same<T, float>::value> {};
+
+namespace detail {
+
+template <class T>
+auto count_less_scalar(const T* first, std::size_t count, T value) noexcept -> std::size_t {
+    std::size_t less = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        less += static_cast<std::size_t>(first[i] < value);
+    }
+    return less;
+}
+
+template <class T>
+auto intersect_scalar(const T* lhs, std::size_t lhs_count, const T* rhs, std::size_t rhs_count,
+                      T* out) noexcept -> std::size_t {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    std::size_t written = 0;
+    while (i < lhs_count && j < rhs_count) {
+        if (lhs[i] < rhs[j]) {
+            ++i;
+        } else if (rhs[j] < lhs[i]) {
+            ++j;
+        } else {
+            out[written++] = lhs[i++];
+            ++j;
+        }
+    }
+    return written;
+}
+
+template <class T>
+void prefix_sum_scalar(T* values, std::size_t count) noexcept {
+    for (std::size_t i = 1; i < count; ++i) {
+        values[i] += values[i - 1];
+    }
+}
+
+#ifdef UTIL_SIMD_X86
+
+// the x86 integer comparisons are signed, flipping the sign bit makes them compare unsigned
+
+__attribute__((target("sse4.2"))) inline auto count_less_sse42(const std::uint32_t* first,
+                                                                std::size_t count,
+                                                                std::uint32_t value) noexcept
+    -> std::size_t {
+    const auto sign = _mm_set1_epi32(INT32_MIN);
+    const auto key = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(value)), sign);
+    std::size_t less = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const auto elements = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)), sign);  // NOLINT
+        const auto mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, elements)));
+        less += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(first + i, count - i, value);
+}
+
+__attribute__((target("sse4.2"))) inline auto count_less_sse42(const std::uint64_t* first,
+                                                                std::size_t count,
+                                                                std::uint64_t value) noexcept
+    -> std::size_t {
+    const auto sign = _mm_set1_epi64x(INT64_MIN);
+    const auto key = _mm_xor_si128(_mm_set1_epi64x(static_cast<std::int64_t>(value)), sign);
+    std::size_t less = 0;
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const auto elements = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)), sign);  // NOLINT
+        const auto mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(key, elements)));
+        less += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(first + i, count - i, value);
+}
+
+__attribute__((target("sse4.2"))) inline auto count_less_sse42(const float* first,
+                                                                std::size_t count,
+                                                                float value) noexcept
+    -> std::size_t {
+    const auto key = _mm_set1_ps(value);
+    std::size_t less = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const auto mask = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(first + i), key));
+        less += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(first + i, count - i, value);
+}
+
+__attribute__((target("avx2"))) inline auto count_less_avx2(const std::uint32_t* first,
+                                                             std::size_t count,
+                                                             std::uint32_t value) noexcept
+    -> std::size_t {
+    const auto sign = _mm256_set1_epi32(INT32_MIN);
+    const auto key = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(value)), sign);
+    std::size_t less = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const auto elements = _mm256_xor_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)), sign);  // NOLINT
+        const auto mask =
+            _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, elements)));
+        less += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(first + i, count - i, value);
+}
+
+__attribute__((target("avx2"))) inline auto count_less_avx2(const std::uint64_t* first,
+                                                             std::size_t count,
+                                                             std::uint64_t value) noexcept
+    -> std::size_t {
+    const auto sign = _mm256_set1_epi64x(INT64_MIN);
+    const auto key = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<std::int64_t>(value)), sign);
+    std::size_t less = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const auto elements = _mm256_xor_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)), sign);  // NOLINT
+        const auto mask =
+            _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, elements)));
+        less += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(first + i, count - i, value);
+}
+
+__attribute__((target("avx2"))) inline auto count_less_avx2(const float* first, std::size_t count,
+                                                             float value) noexcept
+    -> std::size_t {
+    const auto key = _mm256_set1_ps(value);
+    std::size_t less = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const auto mask =
+            _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(first + i), key, _CMP_LT_OQ));
+        less += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(first + i, count - i, value);
+}
+
+/**
+ * Intersects two strictly increasing ranges four by four elements: each block of the left range is
+ * compared with all rotations of the current block of the right range, the block with the smaller
+ * maximum is advanced. The remainders are intersected by a scalar merge.
+ */
+__attribute__((target("sse4.2"))) inline auto intersect_sse42(const std::uint32_t* lhs,
+                                                               std::size_t lhs_count,
+                                                               const std::uint32_t* rhs,
+                                                               std::size_t rhs_count,
+                                                               std::uint32_t* out) noexcept
+    -> std::size_t {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    std::size_t written = 0;
+    while (i + 4 <= lhs_count && j + 4 <= rhs_count) {
+        const auto left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));   // NOLINT
+        const auto right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + j));  // NOLINT
+        const auto equal =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(left, right),
+                                      _mm_cmpeq_epi32(left, _mm_shuffle_epi32(right, 0x39))),
+                         _mm_or_si128(_mm_cmpeq_epi32(left, _mm_shuffle_epi32(right, 0x4e)),
+                                      _mm_cmpeq_epi32(left, _mm_shuffle_epi32(right, 0x93))));
+
+        for (auto mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+             mask != 0; mask &= mask - 1) {
+            out[written++] = lhs[i + static_cast<std::size_t>(__builtin_ctz(mask))];
+        }
+
+        const auto lhs_max = lhs[i + 3];
+        const auto rhs_max = rhs[j + 3];
+        i += lhs_max <= rhs_max ? 4 : 0;
+        j += rhs_max <= lhs_max ? 4 : 0;
+    }
+
+    return written +
+           intersect_scalar(lhs + i, lhs_count - i, rhs + j, rhs_count - j, out + written);
+}
+
+/**
+ * Replaces four values at a time by their inclusive prefix sum: two shifted additions sum each
+ * vector, the last sum of the previous vector is added to all lanes.
+ */
+__attribute__((target("sse4.2"))) inline void prefix_sum_sse42(std::uint32_t* values,
+                                                                std::size_t count) noexcept {
+    auto carry = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* const block = reinterpret_cast<__m128i*>(values + i);  // NOLINT
+        auto sums = _mm_loadu_si128(block);
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 4));
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 8));
+        sums = _mm_add_epi32(sums, carry);
+        _mm_storeu_si128(block, sums);
+        carry = _mm_shuffle_epi32(sums, 0xff);
+    }
+    for (; i < count; ++i) {
+        values[i] += i == 0 ? 0 : values[i - 1];
+    }
+}
+
+__attribute__((target("sse4.2"))) inline void prefix_sum_sse42(std::uint64_t* values,
+                                                                std::size_t count) noexcept {
+    auto carry = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        auto* const block = reinterpret_cast<__m128i*>(values + i);  // NOLINT
+        auto sums = _mm_loadu_si128(block);
+        sums = _mm_add_epi64(sums, _mm_slli_si128(sums, 8));
+        sums = _mm_add_epi64(sums, carry);
+        _mm_storeu_si128(block, sums);
+        carry = _mm_unpackhi_epi64(sums, sums);
+    }
+    for (; i < count; ++i) {
+        values[i] += i == 0 ? 0 : values[i - 1];
+    }
+}
+
+#endif  // UTIL_SIMD_X86
+
+/**
+ * Replaces the values of a range by their inclusive prefix sum with the best available instruction
+ * set.
+ */
+template <class T>
+void prefix_sum(T* values, std::size_t count) noexcept {
+#ifdef UTIL_SIMD_X86
+    if constexpr (std::is_same<T, std::uint32_t>::value || std::is_same<T, std::uint64_t>::value) {
+        if (simd_support() >= simd_level::sse42) {
+            prefix_sum_sse42(values, count);
+            return;
+        }
+    }
+#endif
+    prefix_sum_scalar(values, count);
+}
+
+/**
+ * Counts the elements less than value in a range with the best available instruction set.
+ */
+template <class T>
+auto count_less(const T* first, std::size_t count, T value) noexcept -> std::size_t {
+#ifdef UTIL_SIMD_X86
+    switch (simd_support()) {
+        case simd_level::avx2:
+            return count_less_avx2(first, count, value);
+        case simd_level::sse42:
+            return count_less_sse42(first, count, value);
+        case simd_level::scalar:
+            break;
+    }
+#endif
+    return count_less_scalar(first, count, value);
+}
+
+/**
+ * Intersects two strictly increasing ranges with the best available instruction set.
+ *
+ * @return the number of common elements written to out
+ */
+inline auto intersect(const std::uint32_t* lhs, std::size_t lhs_count, const std::uint32_t* rhs,
+                      std::size_t rhs_count, std::uint32_t* out) noexcept -> std::size_t {
+#ifdef UTIL_SIMD_X86
+    if (simd_support() >= simd_level::sse42) {
+        return intersect_sse42(lhs, lhs_count, rhs, rhs_count, out);
+    }
+#endif
+    return intersect_scalar(lhs, lhs_count, rhs, rhs_count, out);
+}
+
+}  // namespace detail
+
+/**
+ * Searches the first element in a sorted range that is not less than the given value.
+ *
+ * The search halves the range with a branchless binary search until the remainder spans a few
+ * cache lines, then counts the smaller elements of the remainder with vector comparisons. This
+ * avoids the hard to predict branches of the last binary search steps. The instruction set is
+ * chosen at runtime, falling back to scalar code on processors or platforms without support.
+ *
+ * @snippet test/simd.test.cpp simd_lower_bound
+ * @tparam T std::uint32_t, std::uint64_t or float
+ * @param first the beginning of the range sorted by std::less
+ * @param last the end of the range sorted by std::less
+ * @param value the value to compare the elements to
+ * @return a pointer to the first element not less than value or last if there is none
+ */
+template <class T>
+auto simd_lower_bound(const T* first, const T* last, T value) noexcept -> const T* {
+    static_assert(is_simd_searchable<T>::value, "no SIMD search for this element type");
+
+    // four cache lines are searched linearly
+    constexpr std::size_t window = 256 / sizeof(T);
+
+    auto count = static_cast<std::size_t>(last - first);
+    while (count > window) {
+        const auto half = count / 2;
+        first = first[half] < value ? first + half : first;
+        count -= half;
+    }
+
+    return first + detail::count_less(first, count, value);
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_SIMD_HEADER_IS_ALREADY_INCLUDED
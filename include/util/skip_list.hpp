@@ -0,0 +1,787 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_SKIP_LIST_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_SKIP_LIST_HEADER_IS_ALREADY_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#ifdef UTIL_ASSERT
+#include "assert.hpp"
+#endif
+
+namespace util {
+
+namespace detail {
+template <class T, class Compare, class Allocator>
+class skip_list_iterator;
+}  // namespace detail
+
+/**
+ * An indexable skip list keeping its elements sorted.
+ *
+ * Every node is linked on a random number of levels, each level skipping about four times as many
+ * nodes as the level below. Each link also stores how many nodes it skips, so besides searching by
+ * value the list can be searched by position. Insert, erase, find and access by position take
+ * O(log n) expected time, the size is cached. Nodes never move, so references and iterators to
+ * elements stay valid until the element itself is erased.
+ *
+ * Equivalent elements are kept in insertion order. The elements are immutable, only const
+ * iterators are provided.
+ *
+ * @snippet test/skip_list.test.cpp skip_list_insert
+ * @tparam T the type of the stored elements
+ * @tparam Compare A comparison function object which returns true if the first argument is less
+ * than (i.e. is ordered before) the second. The type must meet the requirements of Compare.
+ * @tparam Allocator the allocator used to acquire the memory of the nodes
+ */
+template <class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+class skip_list {
+public:
+    using value_type = T;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = detail::skip_list_iterator<T, Compare, Allocator>;
+    using const_iterator = iterator;
+
+    skip_list() noexcept = default;
+    explicit skip_list(const Compare& comp, const Allocator& alloc = Allocator());
+    ~skip_list();
+    skip_list(const skip_list& other);
+    skip_list(skip_list&& other) noexcept;
+    auto operator=(const skip_list& other) -> skip_list&;
+    auto operator=(skip_list&& other) noexcept(
+        std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value) -> skip_list&;
+
+    // element access
+
+    auto at(size_type pos) const -> const_reference;
+    auto operator[](size_type pos) const -> const_reference;
+    auto front() const -> const_reference;
+    auto back() const -> const_reference;
+
+    // lookup
+
+    auto lower_bound(const_reference value) const -> const_iterator;
+    auto upper_bound(const_reference value) const -> const_iterator;
+    auto find(const_reference value) const -> const_iterator;
+    auto index_of(const_iterator pos) const -> size_type;
+    auto rank(const_reference value) const -> size_type;
+
+    // iterators
+
+    auto begin() const noexcept -> const_iterator;
+    auto cbegin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+    auto cend() const noexcept -> const_iterator;
+
+    // capacity and size
+
+    auto empty() const noexcept -> bool;
+    auto size() const noexcept -> size_type;
+    auto max_size() const noexcept -> size_type;
+
+    // modifiers
+
+    void clear() noexcept;
+    auto insert(const_reference value) -> const_iterator;
+    auto insert(value_type&& value) -> const_iterator;
+    template <class... Args>
+    auto emplace(Args&&... args) -> const_iterator;
+    auto erase(const_iterator pos) -> const_iterator;
+    auto erase(const_iterator first, const_iterator last) -> const_iterator;
+    void swap(skip_list& other) noexcept;
+
+private:
+    friend class detail::skip_list_iterator<T, Compare, Allocator>;
+
+    // 4^32 nodes are more than any memory can hold
+    static constexpr size_type max_height = 32;
+
+    struct node;
+
+    struct link {
+        node* next = nullptr;
+        size_type width = 0;  // the number of positions this link advances, unused if next is null
+    };
+
+    struct node {
+        node* prev = nullptr;
+        size_type height = 0;
+        union {
+            T value;
+        };
+
+        node() noexcept {}  // NOLINT(modernize-use-equals-default) the value is constructed later
+        ~node() {}          // NOLINT(modernize-use-equals-default) the value is destroyed manually
+
+        node(const node&) = delete;
+        node(node&&) = delete;
+        auto operator=(const node&) -> node& = delete;
+        auto operator=(node&&) -> node& = delete;
+
+        // the links are allocated directly behind the node
+        auto links() noexcept -> link* { return reinterpret_cast<link*>(this + 1); }  // NOLINT
+    };
+
+    using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    Compare comp = Compare();
+    node_allocator alloc = node_allocator();
+    std::array<link, max_height> head{};
+    node* tail = nullptr;
+    size_type height = 0;
+    size_type count = 0;
+    std::uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+    static auto blocks(size_type height) noexcept -> size_type;
+    auto links_of(node* n) noexcept -> link*;
+    auto random_height() noexcept -> size_type;
+    auto find_before(const_reference value, bool or_equal, node** update, size_type* ranks) const
+        -> void;
+    template <class... Args>
+    auto insert_node(Args&&... args) -> const_iterator;
+    void destroy(node* n) noexcept;
+    void append_all(const skip_list& other);
+    void move_all(skip_list& other);
+    void steal(skip_list& other) noexcept;
+};
+
+namespace detail {
+
+/**
+ * A bidirectional const iterator through the elements of a skip list in sorted order.
+ */
+template <class T, class Compare, class Allocator>
+class skip_list_iterator {
+    using list_type = skip_list<T, Compare, Allocator>;
+    using node_type = typename list_type::node;
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    skip_list_iterator() noexcept = default;
+
+    auto operator*() const noexcept -> reference { return current->value; }
+    auto operator->() const noexcept -> pointer { return std::addressof(current->value); }
+
+    auto operator++() noexcept -> skip_list_iterator& {
+        current = current->links()[0].next;
+        return *this;
+    }
+
+    auto operator++(int) noexcept -> skip_list_iterator {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    auto operator--() noexcept -> skip_list_iterator& {
+        current = current == nullptr ? list->tail : current->prev;
+        return *this;
+    }
+
+    auto operator--(int) noexcept -> skip_list_iterator {
+        auto tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    friend auto operator==(const skip_list_iterator& lhs, const skip_list_iterator& rhs) noexcept
+        -> bool {
+        return lhs.current == rhs.current;
+    }
+
+    friend auto operator!=(const skip_list_iterator& lhs, const skip_list_iterator& rhs) noexcept
+        -> bool {
+        return lhs.current != rhs.current;
+    }
+
+private:
+    friend list_type;
+
+    skip_list_iterator(node_type* current, const list_type* list) noexcept
+        : current(current), list(list) {}
+
+    node_type* current = nullptr;
+    const list_type* list = nullptr;
+};
+
+}  // namespace detail
+
+/**
+ * Constructs an empty skip list ordered by the given comparison, allocating with the given
+ * allocator.
+ *
+ * @param comp the comparison function object ordering the elements
+ * @param alloc the allocator of the nodes
+ */
+template <class T, class Compare, class Allocator>
+skip_list<T, Compare, Allocator>::skip_list(const Compare& comp, const Allocator& alloc)
+    : comp(comp), alloc(alloc) {}
+
+template <class T, class Compare, class Allocator>
+skip_list<T, Compare, Allocator>::~skip_list() {
+    clear();
+}
+
+/**
+ * Constructs a skip list with copies of the elements of another skip list.
+ *
+ * @param other another skip list to copy the elements from
+ */
+template <class T, class Compare, class Allocator>
+skip_list<T, Compare, Allocator>::skip_list(const skip_list& other)
+    : comp(other.comp),
+      alloc(node_traits::select_on_container_copy_construction(other.alloc)) {
+    append_all(other);
+}
+
+/**
+ * Constructs a skip list by taking over the nodes of another skip list, which is left empty.
+ *
+ * @param other another skip list to move the elements from
+ */
+template <class T, class Compare, class Allocator>
+skip_list<T, Compare, Allocator>::skip_list(skip_list&& other) noexcept
+    : comp(other.comp), alloc(std::move(other.alloc)) {
+    steal(other);
+}
+
+/**
+ * Replaces the elements with copies of the elements of another skip list. The allocator is copied
+ * too if it propagates on copy assignment.
+ *
+ * @param other another skip list to copy the elements from
+ * @return a reference to this instance
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::operator=(const skip_list& other) -> skip_list& {
+    if (this != &other) {
+        clear();
+        comp = other.comp;
+        if constexpr (node_traits::propagate_on_container_copy_assignment::value) {
+            alloc = other.alloc;
+        }
+        append_all(other);
+    }
+    return *this;
+}
+
+/**
+ * Replaces the elements by taking over the nodes of another skip list, which is left empty. If the
+ * allocator does not propagate on move assignment and differs from the one of the other skip list,
+ * the elements are moved into new nodes instead.
+ *
+ * @param other another skip list to move the elements from
+ * @return a reference to this instance
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::operator=(skip_list&& other) noexcept(
+    std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<Allocator>::is_always_equal::value) -> skip_list& {
+    if (this != &other) {
+        clear();
+        comp = other.comp;
+        if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+            alloc = std::move(other.alloc);
+            steal(other);
+        } else if (alloc == other.alloc) {
+            steal(other);
+        } else {
+            move_all(other);
+        }
+    }
+    return *this;
+}
+
+/**
+ * Returns a const reference to an element at the requested position with boundary checking.
+ *
+ * @param pos the position of the element to return
+ * @throw out_of_range if pos >= size()
+ * @return a const reference to the element at the requested position
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::at(size_type pos) const -> const_reference {
+    if (pos >= size()) {
+        throw std::out_of_range{"pos is out of range"};
+    }
+
+    return operator[](pos);
+}
+
+/**
+ * Returns a const reference to an element at the requested position without boundary checking in
+ * O(log n) expected time. Undefined behaviour if accessing a position >= size().
+ *
+ * @snippet test/skip_list.test.cpp skip_list_operator_square_brackets
+ * @param pos the position of the element to return
+ * @return a const reference to the element at the requested position
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::operator[](size_type pos) const -> const_reference {
+#ifdef UTIL_ASSERT
+    util_assert(pos < size());
+#endif
+
+    // positions are counted from the head, which is at position zero
+    const auto target = pos + 1;
+    const link* links = head.data();
+    size_type reached = 0;
+    for (auto level = height; level-- > 0;) {
+        while (links[level].next != nullptr && reached + links[level].width <= target) {
+            reached += links[level].width;
+            if (reached == target) {
+                return links[level].next->value;
+            }
+            links = links[level].next->links();
+        }
+    }
+
+    return tail->value;  // not reached for valid positions
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::front() const -> const_reference {
+    return head[0].next->value;
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::back() const -> const_reference {
+    return tail->value;
+}
+
+/**
+ * Searches the first element that is not ordered before the given value in O(log n) expected time.
+ *
+ * @snippet test/skip_list.test.cpp skip_list_lower_bound
+ * @param value the value to compare the elements to
+ * @return a const iterator to the first element not less than value or end() if there is none
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::lower_bound(const_reference value) const -> const_iterator {
+    std::array<node*, max_height> update{};
+    find_before(value, false, update.data(), nullptr);
+    auto* const before = update[0];
+    return const_iterator(before == nullptr ? head[0].next : before->links()[0].next, this);
+}
+
+/**
+ * Searches the first element that is ordered after the given value in O(log n) expected time.
+ *
+ * @param value the value to compare the elements to
+ * @return a const iterator to the first element greater than value or end() if there is none
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::upper_bound(const_reference value) const -> const_iterator {
+    std::array<node*, max_height> update{};
+    find_before(value, true, update.data(), nullptr);
+    auto* const before = update[0];
+    return const_iterator(before == nullptr ? head[0].next : before->links()[0].next, this);
+}
+
+/**
+ * Searches an element equivalent to the given value in O(log n) expected time.
+ *
+ * @param value the value to search for
+ * @return a const iterator to the first equivalent element or end() if there is none
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::find(const_reference value) const -> const_iterator {
+    const auto it = lower_bound(value);
+    return it != end() && !comp(value, *it) ? it : end();
+}
+
+/**
+ * Returns the position of the element an iterator points to in O(log n) expected time, also within
+ * long runs of equivalent elements.
+ *
+ * @snippet test/skip_list.test.cpp skip_list_index_of
+ * @param pos an iterator to an element of this skip list or end()
+ * @return the position of the element or size() for end()
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::index_of(const_iterator pos) const -> size_type {
+    if (pos.current == nullptr) {
+        return count;
+    }
+
+    // climbs from the node to the tail along its highest link, the search path from the head in
+    // reverse, so the node is found by identity without comparing values
+    auto* current = pos.current;
+    size_type passed = 0;
+    while (current->links()[0].next != nullptr) {
+        auto level = current->height - 1;
+        while (current->links()[level].next == nullptr) {
+            --level;
+        }
+        passed += current->links()[level].width;
+        current = current->links()[level].next;
+    }
+    return count - 1 - passed;
+}
+
+/**
+ * Counts the elements ordered before the given value in O(log n) expected time by summing the
+ * widths of the links passed while searching.
+ *
+ * @snippet test/skip_list.test.cpp skip_list_rank
+ * @param value the value to compare the elements to
+ * @return the number of elements less than value, i.e. the position of lower_bound(value)
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::rank(const_reference value) const -> size_type {
+    const link* links = head.data();
+    size_type reached = 0;
+    for (auto level = height; level-- > 0;) {
+        for (auto* next = links[level].next; next != nullptr && comp(next->value, value);
+             next = links[level].next) {
+            reached += links[level].width;
+            links = next->links();
+        }
+    }
+    return reached;
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::begin() const noexcept -> const_iterator {
+    return const_iterator(head[0].next, this);
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::cbegin() const noexcept -> const_iterator {
+    return begin();
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::end() const noexcept -> const_iterator {
+    return const_iterator(nullptr, this);
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::cend() const noexcept -> const_iterator {
+    return end();
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::empty() const noexcept -> bool {
+    return count == 0;
+}
+
+/**
+ * Returns the count of elements in this skip list in constant time.
+ *
+ * @return the number of contained elements
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::size() const noexcept -> size_type {
+    return count;
+}
+
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::max_size() const noexcept -> size_type {
+    return node_traits::max_size(alloc) / blocks(1);
+}
+
+/**
+ * Erases all elements from this skip list.
+ */
+template <class T, class Compare, class Allocator>
+void skip_list<T, Compare, Allocator>::clear() noexcept {
+    for (auto* n = head[0].next; n != nullptr;) {
+        auto* const next = n->links()[0].next;
+        destroy(n);
+        n = next;
+    }
+
+    head.fill(link{});
+    tail = nullptr;
+    height = 0;
+    count = 0;
+}
+
+/**
+ * Inserts an element after all equivalent elements in O(log n) expected time.
+ *
+ * @snippet test/skip_list.test.cpp skip_list_insert
+ * @param value the element to insert
+ * @return a const iterator to the inserted element
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::insert(const_reference value) -> const_iterator {
+    return insert_node(value);
+}
+
+/**
+ * @see skip_list<T, Compare, Allocator>::insert(const_reference value) -> const_iterator
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::insert(value_type&& value) -> const_iterator {
+    return insert_node(std::move(value));
+}
+
+/**
+ * Constructs an element in place and inserts it after all equivalent elements.
+ *
+ * @param args the arguments to construct the element with
+ * @return a const iterator to the inserted element
+ */
+template <class T, class Compare, class Allocator>
+template <class... Args>
+auto skip_list<T, Compare, Allocator>::emplace(Args&&... args) -> const_iterator {
+    return insert_node(std::forward<Args>(args)...);
+}
+
+/**
+ * Erases an element in O(log n) expected time. The links before it are found by its position, so
+ * the cost does not depend on the number of elements equivalent to it.
+ *
+ * @snippet test/skip_list.test.cpp skip_list_erase
+ * @param pos an iterator to the element to erase
+ * @return a const iterator to the element following the erased one
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::erase(const_iterator pos) -> const_iterator {
+    auto* const target = pos.current;
+    const auto target_rank = index_of(pos) + 1;
+
+    // find the last link on every level that ends before the target, by position
+    std::array<link*, max_height> update{};
+    auto* links = head.data();
+    size_type reached = 0;
+    for (auto level = height; level-- > 0;) {
+        while (links[level].next != nullptr && reached + links[level].width < target_rank) {
+            reached += links[level].width;
+            links = links[level].next->links();
+        }
+        update[level] = links;
+    }
+
+    for (size_type level = 0; level < height; ++level) {
+        auto& before = update[level][level];
+        if (before.next == target) {
+            before.width += target->links()[level].width - 1;
+            before.next = target->links()[level].next;
+        } else {
+            --before.width;
+        }
+    }
+
+    auto* const next = target->links()[0].next;
+    (next == nullptr ? tail : next->prev) = target->prev;
+    while (height > 0 && head[height - 1].next == nullptr) {
+        --height;
+    }
+    --count;
+
+    destroy(target);
+    return const_iterator(next, this);
+}
+
+/**
+ * Erases a range of elements.
+ *
+ * @param first an iterator to the first element to erase
+ * @param last an iterator after the last element to erase
+ * @return last
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::erase(const_iterator first, const_iterator last)
+    -> const_iterator {
+    while (first != last) {
+        first = erase(first);
+    }
+    return last;
+}
+
+template <class T, class Compare, class Allocator>
+void skip_list<T, Compare, Allocator>::swap(skip_list& other) noexcept {
+    using std::swap;
+    swap(comp, other.comp);
+    if constexpr (node_traits::propagate_on_container_swap::value) {
+        swap(alloc, other.alloc);
+    }
+    swap(head, other.head);
+    swap(tail, other.tail);
+    swap(height, other.height);
+    swap(count, other.count);
+    swap(seed, other.seed);
+}
+
+/**
+ * Returns the number of node sized blocks needed for a node and its links.
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::blocks(size_type height) noexcept -> size_type {
+    return 1 + (height * sizeof(link) + sizeof(node) - 1) / sizeof(node);
+}
+
+/**
+ * Returns the links of a node or the links of the head for a null node.
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::links_of(node* n) noexcept -> link* {
+    return n == nullptr ? head.data() : n->links();
+}
+
+/**
+ * Draws a height with the probability for each additional level being 1/4.
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::random_height() noexcept -> size_type {
+    // xorshift64
+    seed ^= seed << 13U;
+    seed ^= seed >> 7U;
+    seed ^= seed << 17U;
+
+    size_type result = 1;
+    for (auto bits = seed; (bits & 3U) == 0 && result < max_height; bits >>= 2U) {
+        ++result;
+    }
+    return result;
+}
+
+/**
+ * Finds the last node on every level that is ordered before the value, or not after the value if
+ * or_equal is set. A null node stands for the head. The ranks are the positions of these nodes.
+ */
+template <class T, class Compare, class Allocator>
+auto skip_list<T, Compare, Allocator>::find_before(const_reference value, bool or_equal,
+                                                    node** update, size_type* ranks) const -> void {
+    const link* links = head.data();
+    node* current = nullptr;
+    size_type reached = 0;
+    for (auto level = height; level-- > 0;) {
+        for (auto* next = links[level].next; next != nullptr; next = links[level].next) {
+            if (or_equal ? comp(value, next->value) : !comp(next->value, value)) {
+                break;
+            }
+            reached += links[level].width;
+            current = next;
+            links = next->links();
+        }
+        update[level] = current;
+        if (ranks != nullptr) {
+            ranks[level] = reached;
+        }
+    }
+}
+
+template <class T, class Compare, class Allocator>
+template <class... Args>
+auto skip_list<T, Compare, Allocator>::insert_node(Args&&... args) -> const_iterator {
+    const auto new_height = random_height();
+    auto* const memory = node_traits::allocate(alloc, blocks(new_height));
+    auto* const n = ::new (static_cast<void*>(memory)) node();
+    try {
+        ::new (static_cast<void*>(std::addressof(n->value))) T(std::forward<Args>(args)...);
+    } catch (...) {
+        n->~node();
+        node_traits::deallocate(alloc, memory, blocks(new_height));
+        throw;
+    }
+    n->height = new_height;
+    for (size_type level = 0; level < new_height; ++level) {
+        ::new (static_cast<void*>(n->links() + level)) link();
+    }
+
+    std::array<node*, max_height> update{};
+    std::array<size_type, max_height> ranks{};
+    find_before(n->value, true, update.data(), ranks.data());
+
+    for (; height < new_height; ++height) {
+        update[height] = nullptr;
+        ranks[height] = 0;
+        head[height] = link{};
+    }
+
+    for (size_type level = 0; level < height; ++level) {
+        auto& before = links_of(update[level])[level];
+        if (level < new_height) {
+            auto& after = n->links()[level];
+            after.next = before.next;
+            after.width = before.width - (ranks[0] - ranks[level]);
+            before.next = n;
+            before.width = ranks[0] - ranks[level] + 1;
+        } else {
+            ++before.width;
+        }
+    }
+
+    n->prev = update[0];
+    auto* const next = n->links()[0].next;
+    (next == nullptr ? tail : next->prev) = n;
+    ++count;
+
+    return const_iterator(n, this);
+}
+
+template <class T, class Compare, class Allocator>
+void skip_list<T, Compare, Allocator>::destroy(node* n) noexcept {
+    const auto n_height = n->height;
+    n->value.~T();
+    n->~node();
+    node_traits::deallocate(alloc, n, blocks(n_height));
+}
+
+template <class T, class Compare, class Allocator>
+void skip_list<T, Compare, Allocator>::append_all(const skip_list& other) {
+    for (const auto& value : other) {
+        insert_node(value);
+    }
+}
+
+/**
+ * Moves the elements of another skip list into new nodes of this one and clears the other one, for
+ * allocators which cannot free the nodes of each other.
+ */
+template <class T, class Compare, class Allocator>
+void skip_list<T, Compare, Allocator>::move_all(skip_list& other) {
+    for (auto* n = other.head[0].next; n != nullptr; n = n->links()[0].next) {
+        insert_node(std::move(n->value));
+    }
+    other.clear();
+}
+
+/**
+ * Takes over the nodes of another skip list, this skip list must be empty. Requires the allocators
+ * to be equal or to propagate.
+ */
+template <class T, class Compare, class Allocator>
+void skip_list<T, Compare, Allocator>::steal(skip_list& other) noexcept {
+    head = other.head;
+    tail = other.tail;
+    height = other.height;
+    count = other.count;
+
+    other.head.fill(link{});
+    other.tail = nullptr;
+    other.height = 0;
+    other.count = 0;
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_SKIP_LIST_HEADER_IS_ALREADY_INCLUDED
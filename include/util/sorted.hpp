@@ -8,21 +8,79 @@
 #include <array>
 #include <forward_list>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "simd.hpp"
+#include "skip_list.hpp"
+
 #ifdef UTIL_ASSERT
 #include <util/assert.hpp>
 #endif
 
 namespace util {
 
+namespace detail {
+
+/**
+ * Checks if a container keeps its elements ordered by itself, recognized by a key_compare type.
+ */
+template <class Container, class = void>
+struct is_ordered : std::false_type {};
+
+template <class Container>
+struct is_ordered<Container, std::void_t<typename Container::key_compare>> : std::true_type {};
+
+/**
+ * Checks if a container orders its elements by the given comparison, which is always the case for
+ * containers not ordering their elements by themselves.
+ */
+template <class Container, class Compare, class = void>
+struct orders_by : std::true_type {};
+
+template <class Container, class Compare>
+struct orders_by<Container, Compare, std::void_t<typename Container::key_compare>>
+    : std::is_same<Compare, typename Container::key_compare> {};
+
+/**
+ * Checks if an ordered container can be built from a sorted range at once, recognized by a
+ * bulk_load method.
+ */
+template <class Container, class = void>
+struct has_bulk_load : std::false_type {};
+
+template <class Container>
+struct has_bulk_load<Container,
+                     std::void_t<decltype(std::declval<Container&>().bulk_load(
+                         std::declval<const typename Container::value_type*>(),
+                         std::declval<const typename Container::value_type*>()))>>
+    : std::true_type {};
+
+}  // namespace detail
+
+/**
+ * A tag to construct a sorted container from elements that are already sorted, skipping the sort.
+ *
+ * @snippet test/sorted.test.cpp sorted_ctor_presorted
+ */
+struct presorted_t {
+    explicit presorted_t() = default;
+};
+
+inline constexpr presorted_t presorted{};
+
 /**
  * A container of elements that are kept sorted.
  *
  * @snippet test/sorted.test.cpp sorted_ctor_ilist
- * @tparam Container the type of container to keep sorted
+ * @tparam Container the type of container to keep sorted, either a sequence container like
+ * std::vector or a container ordering its elements by itself like util::skip_list or util::btree,
+ * whose key_compare has to be Compare
  * @tparam Compare A comparison function object which returns ​true if the first argument is less
  * than (i.e. is ordered before) the second. The type must meet the requirements of Compare.
  */
@@ -39,6 +97,13 @@ public:
         std::is_same<Container, std::forward_list<value_type, typename Container::allocator_type>>;
     using is_list =
         std::is_same<Container, std::list<value_type, typename Container::allocator_type>>;
+    using is_ordered = detail::is_ordered<Container>;
+    using is_vector =
+        std::is_same<Container, std::vector<value_type, typename Container::allocator_type>>;
+    using is_simd_searchable = std::integral_constant<
+        bool, is_vector::value && util::is_simd_searchable<value_type>::value &&
+                  (std::is_same<Compare, std::less<value_type>>::value ||
+                   std::is_same<Compare, std::less<>>::value)>;
 
     sorted() noexcept = default;
     ~sorted() = default;
@@ -52,6 +117,9 @@ public:
     template <class InputIt>
     sorted(InputIt begin, InputIt end);
     sorted(std::initializer_list<value_type> ilist);
+    template <class InputIt>
+    sorted(presorted_t, InputIt begin, InputIt end);
+    sorted(presorted_t, Container&& container);
 
     // element access
 
@@ -61,6 +129,19 @@ public:
     auto back() const -> const_reference;
     auto data() const noexcept -> const_pointer;
 
+    // lookup
+
+    auto lower_bound(const_reference value) const -> const_iterator;
+    auto upper_bound(const_reference value) const -> const_iterator;
+    auto find(const_reference value) const -> const_iterator;
+    auto contains(const_reference value) const -> bool;
+
+    // order statistics
+
+    auto rank(const_reference value) const -> size_type;
+    auto select(size_type pos) const -> const_reference;
+    auto count_range(const_reference low, const_reference high) const -> size_type;
+
     // iterators
 
     auto begin() const noexcept -> const_iterator;
@@ -95,15 +176,24 @@ public:
     void pop_front();
     void swap(sorted& other);
 
+    // observers
+
+    auto key_comp() const -> Compare;
+
 private:
+    // lookups compare with comp, so an ordered container has to keep the same order
+    static_assert(detail::orders_by<Container, Compare>::value,
+                  "an ordered container has to compare like Compare");
+
     Compare comp = Compare();
     Container container;
 };
 
+// the node based variants use a skip list for logarithmic insert, lookup and access by position
 template <class T, class Allocator = std::allocator<T>>
-using sorted_forward_list = sorted<std::forward_list<T, Allocator>>;
+using sorted_forward_list = sorted<skip_list<T, std::less<T>, Allocator>>;
 template <class T, class Allocator = std::allocator<T>>
-using sorted_list = sorted<std::list<T, Allocator>>;
+using sorted_list = sorted<skip_list<T, std::less<T>, Allocator>>;
 template <class T, class Allocator = std::allocator<T>>
 using sorted_vector = sorted<std::vector<T, Allocator>>;
 
@@ -132,12 +222,16 @@ sorted<Container, Compare>::sorted(const OtherContainer& container)
 template <class Container, class Compare>
 template <class InputIt>
 sorted<Container, Compare>::sorted(InputIt begin, InputIt end) {
-    if constexpr (is_forward_list::value) {
+    if constexpr (is_ordered::value) {
+        for (; begin != end; ++begin) {
+            container.insert(*begin);
+        }
+    } else if constexpr (is_forward_list::value) {
         container.assign(begin, end);
         container.sort(comp);
     } else {
         for (; begin != end; ++begin) {
-            container.insert(std::lower_bound(container.begin(), container.end(), *begin, comp),
+            container.insert(std::upper_bound(container.begin(), container.end(), *begin, comp),
                              *begin);
         }
     }
@@ -153,6 +247,48 @@ template <class Container, class Compare>
 sorted<Container, Compare>::sorted(std::initializer_list<value_type> ilist)
     : sorted(std::begin(ilist), std::end(ilist)) {}
 
+/**
+ * Constructs a sorted container from a range of elements which is already sorted by Compare. The
+ * elements are appended without sorting or searching.
+ *
+ * @snippet test/sorted.test.cpp sorted_ctor_presorted
+ * @tparam InputIt the type of the input iterator
+ * @param begin the beginning iterator of the sorted range of elements to insert
+ * @param end the iterator of the element one position after the last element
+ * @throw util::assertion if the range is not sorted, only if UTIL_ASSERT is defined
+ */
+template <class Container, class Compare>
+template <class InputIt>
+sorted<Container, Compare>::sorted(presorted_t /*unused*/, InputIt begin, InputIt end) {
+    if constexpr (detail::has_bulk_load<Container>::value) {
+        container.bulk_load(begin, end);
+    } else if constexpr (is_ordered::value) {
+        for (; begin != end; ++begin) {
+            container.insert(*begin);
+        }
+    } else {
+        container.assign(begin, end);
+    }
+
+#ifdef UTIL_ASSERT
+    util_assert(std::is_sorted(container.begin(), container.end(), comp));
+#endif  // UTIL_ASSERT
+}
+
+/**
+ * Constructs a sorted container by taking over a container which is already sorted by Compare.
+ *
+ * @param container the sorted container to take over
+ * @throw util::assertion if the container is not sorted, only if UTIL_ASSERT is defined
+ */
+template <class Container, class Compare>
+sorted<Container, Compare>::sorted(presorted_t /*unused*/, Container&& container)
+    : container(std::move(container)) {
+#ifdef UTIL_ASSERT
+    util_assert(std::is_sorted(this->container.begin(), this->container.end(), comp));
+#endif  // UTIL_ASSERT
+}
+
 /**
  * Returns a const reference to an element at the requested position with boundary checking.
  *
@@ -167,7 +303,9 @@ auto sorted<Container, Compare>::at(size_type pos) const -> const_reference {
         throw std::out_of_range{"pos is out of range"};
     }
 
-    if constexpr (is_forward_list::value || is_list::value) {
+    if constexpr (is_ordered::value) {
+        return container[pos];
+    } else if constexpr (is_forward_list::value || is_list::value) {
         auto it = container.begin();
         while (pos--) {
             ++it;
@@ -192,7 +330,9 @@ auto sorted<Container, Compare>::operator[](size_type pos) const -> const_refere
     util_assert(pos < size());
 #endif  // UTIL_ASSERT
 
-    if constexpr (is_forward_list::value || is_list::value) {
+    if constexpr (is_ordered::value) {
+        return container[pos];
+    } else if constexpr (is_forward_list::value || is_list::value) {
         auto it = container.begin();
         while (pos--) {
             ++it;
@@ -218,6 +358,165 @@ auto sorted<Container, Compare>::data() const noexcept -> const_pointer {
     return container.data();
 }
 
+/**
+ * Searches the first element that is not ordered before the given value.
+ *
+ * A sorted_vector of std::uint32_t, std::uint64_t or float ordered by std::less finishes the search
+ * with SIMD comparisons, see util::simd_lower_bound.
+ *
+ * @snippet test/sorted.test.cpp sorted_lower_bound
+ * @param value the value to compare the elements to
+ * @return a const iterator to the first element not less than value or end() if there is none
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::lower_bound(const_reference value) const -> const_iterator {
+    if constexpr (is_ordered::value) {
+        return container.lower_bound(value);
+    } else if constexpr (is_simd_searchable::value) {
+        const auto* const first = container.data();
+        return container.begin() +
+               (util::simd_lower_bound(first, first + container.size(), value) - first);
+    } else {
+        return std::lower_bound(container.begin(), container.end(), value, comp);
+    }
+}
+
+/**
+ * Searches the first element that is ordered after the given value.
+ *
+ * @snippet test/sorted.test.cpp sorted_upper_bound
+ * @param value the value to compare the elements to
+ * @return a const iterator to the first element greater than value or end() if there is none
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::upper_bound(const_reference value) const -> const_iterator {
+    if constexpr (is_ordered::value) {
+        return container.upper_bound(value);
+    } else {
+        return std::upper_bound(container.begin(), container.end(), value, comp);
+    }
+}
+
+/**
+ * Searches an element equivalent to the given value.
+ *
+ * @snippet test/sorted.test.cpp sorted_find
+ * @param value the value to search for
+ * @return a const iterator to an equivalent element or end() if there is none
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::find(const_reference value) const -> const_iterator {
+    const auto it = lower_bound(value);
+    return it != container.end() && !comp(value, *it) ? it : container.end();
+}
+
+/**
+ * Checks if there is an element equivalent to the given value.
+ *
+ * @param value the value to search for
+ * @return true if there is an equivalent element, otherwise false
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::contains(const_reference value) const -> bool {
+    return find(value) != container.end();
+}
+
+/**
+ * Counts the elements ordered before the given value. Takes O(log n) for vectors and the skip list
+ * based variants and linear time for std::list and std::forward_list.
+ *
+ * @snippet test/sorted.test.cpp sorted_rank
+ * @param value the value to compare the elements to
+ * @return the number of elements less than value
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::rank(const_reference value) const -> size_type {
+    if constexpr (is_ordered::value) {
+        return container.rank(value);
+    } else {
+        return static_cast<size_type>(std::distance(container.begin(), lower_bound(value)));
+    }
+}
+
+/**
+ * Returns the element with the given number of smaller elements, i.e. the k-th smallest element
+ * counting from 0. Takes O(1) for vectors, O(log n) for the skip list based variants and linear
+ * time for std::list and std::forward_list.
+ *
+ * @snippet test/sorted.test.cpp sorted_rank
+ * @param pos the number of elements ordered before the requested element
+ * @throw out_of_range if pos >= size()
+ * @return a const reference to the requested element
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::select(size_type pos) const -> const_reference {
+    return at(pos);
+}
+
+/**
+ * Counts the elements not less than low and less than high. Takes O(log n) for vectors and the
+ * skip list based variants and linear time for std::list and std::forward_list.
+ *
+ * @snippet test/sorted.test.cpp sorted_rank
+ * @param low the inclusive lower end of the value range
+ * @param high the exclusive upper end of the value range
+ * @return the number of elements in [low, high) or 0 if high is not ordered after low
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::count_range(const_reference low, const_reference high) const
+    -> size_type {
+    if (!comp(low, high)) {
+        return 0;
+    }
+    return rank(high) - rank(low);
+}
+
+/**
+ * Returns a const iterator to the first element of this sorted container.
+ *
+ * @return a const iterator to the smallest element or end() if the container is empty
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::begin() const noexcept -> const_iterator {
+    return container.begin();
+}
+
+/**
+ * @see sorted<Container, Compare>::begin() const noexcept -> const_iterator
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::cbegin() const noexcept -> const_iterator {
+    return container.cbegin();
+}
+
+/**
+ * Returns a const iterator to the element following the last element of this sorted container.
+ *
+ * @return a const iterator one position after the largest element
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::end() const noexcept -> const_iterator {
+    return container.end();
+}
+
+/**
+ * @see sorted<Container, Compare>::end() const noexcept -> const_iterator
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::cend() const noexcept -> const_iterator {
+    return container.cend();
+}
+
+/**
+ * Checks if this sorted container has no elements.
+ *
+ * @return true if the container is empty, otherwise false
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::empty() const noexcept -> bool {
+    return container.empty();
+}
+
 /**
  * Returns the count of elements in this sorted container.
  *
@@ -244,7 +543,7 @@ auto sorted<Container, Compare>::size() const noexcept -> size_type {
  */
 template <class Container, class Compare>
 auto sorted<Container, Compare>::capacity() const noexcept -> size_type {
-    if constexpr (is_forward_list::value || is_list::value) {
+    if constexpr (is_ordered::value || is_forward_list::value || is_list::value) {
         return container.max_size();
     } else {
         return container.capacity();
@@ -269,9 +568,9 @@ void sorted<Container, Compare>::clear() noexcept {
  * Inserts an element into the sorted container.
  *
  * In contrast to the normal container's insert method, this insert does not take an additional
- * position parameter. The position is determined by the sorting algorithm. The method invalidates
- * any references, pointers, or iterators referring to contained elements. Any past-the-end
- * iterators are also invalidated.
+ * position parameter. The position is determined by the sorting algorithm, the element is placed
+ * after all equivalent elements. For vector based containers the method invalidates any references,
+ * pointers, or iterators referring to contained elements, node based containers keep them valid.
  *
  * @snippet test/sorted.test.cpp sorted_insert
  * @param value the element to insert
@@ -279,12 +578,13 @@ void sorted<Container, Compare>::clear() noexcept {
  */
 template <class Container, class Compare>
 auto sorted<Container, Compare>::insert(const_reference value) -> const_iterator {
-    if constexpr (is_forward_list::value) {
-        container.push_back(value);
-        container.sort(comp);
+    if constexpr (is_ordered::value) {
+        return container.insert(value);
+    } else if constexpr (is_forward_list::value) {
+        return insert(value_type(value));
     } else {
-        return const_iterator(
-            container.insert(std::lower_bound(container.begin(), container.end()), value, comp));
+        return const_iterator(container.insert(
+            std::upper_bound(container.begin(), container.end(), value, comp), value));
     }
 }
 
@@ -294,28 +594,72 @@ auto sorted<Container, Compare>::insert(const_reference value) -> const_iterator
  */
 template <class Container, class Compare>
 auto sorted<Container, Compare>::insert(value_type&& value) -> const_iterator {
-    if constexpr (is_forward_list::value) {
-        auto it = container.begin();
-        if (comp(value, *it)) {
-            container.push_front(std::move(value));
-            return container.cbegin();
-        }
-
-        for (auto next = ++container.begin(), end = container.end(); next != end; ++next, ++it) {
-            if (comp(value, *next)) {
-                return const_iterator(container.insert_after(it, std::move(value)));
-            }
+    if constexpr (is_ordered::value) {
+        return container.insert(std::move(value));
+    } else if constexpr (is_forward_list::value) {
+        auto it = container.before_begin();
+        for (auto next = container.begin(), end = container.end();
+             next != end && !comp(value, *next); ++next, ++it) {
         }
 
         return const_iterator(container.insert_after(it, std::move(value)));
+    } else {
+        const auto pos = std::upper_bound(container.begin(), container.end(), value, comp);
+        return const_iterator(container.insert(pos, std::move(value)));
+    }
+}
 
+/**
+ * Erases an element from the sorted container.
+ *
+ * @snippet test/sorted.test.cpp sorted_erase
+ * @param pos a const iterator to the element to erase
+ * @return a const iterator to the element following the erased one
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::erase(const_iterator pos) -> const_iterator {
+    if constexpr (is_forward_list::value) {
+        auto it = container.before_begin();
+        while (std::next(it) != pos) {
+            ++it;
+        }
+        return container.erase_after(it);
     } else {
-        return const_iterator(container.insert(
-            std::lower_bound(container.begin(), container.end(), std::move(value), comp),
-            std::move(value)));
+        return container.erase(pos);
     }
 }
 
+/**
+ * Erases a range of elements from the sorted container.
+ *
+ * @param first a const iterator to the first element to erase
+ * @param last a const iterator after the last element to erase
+ * @return a const iterator to the element following the erased ones
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::erase(const_iterator first, const_iterator last)
+    -> const_iterator {
+    if constexpr (is_forward_list::value) {
+        auto it = container.before_begin();
+        while (std::next(it) != first) {
+            ++it;
+        }
+        return container.erase_after(it, last);
+    } else {
+        return container.erase(first, last);
+    }
+}
+
+/**
+ * Returns the function object ordering the elements of this sorted container.
+ *
+ * @return a copy of the comparison function object
+ */
+template <class Container, class Compare>
+auto sorted<Container, Compare>::key_comp() const -> Compare {
+    return comp;
+}
+
 }  // namespace util
 
-#endif  // THAT_THIS_UTIL_SORTED_HEADER_IS_ALREADY_INCLUDED
\ No newline at end of file
+#endif  // THAT_THIS_UTIL_SORTED_HEADER_IS_ALREADY_INCLUDED
@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2021 Christian Göhring <mostsig@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef THAT_THIS_UTIL_THREAD_POOL_HEADER_IS_ALREADY_INCLUDED
+#define THAT_THIS_UTIL_THREAD_POOL_HEADER_IS_ALREADY_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/**
+ * A fixed number of worker threads executing submitted tasks in submission order.
+ *
+ * Tasks must not wait for other tasks of the same pool, as all workers may be blocked waiting
+ * then. The destructor runs the tasks still queued before joining the workers.
+ *
+ * @snippet test/thread_pool.test.cpp thread_pool
+ */
+class thread_pool {
+public:
+    using size_type = std::size_t;
+
+    explicit thread_pool(size_type threads = std::thread::hardware_concurrency());
+    ~thread_pool();
+    thread_pool(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    auto operator=(const thread_pool&) -> thread_pool& = delete;
+    auto operator=(thread_pool&&) -> thread_pool& = delete;
+
+    template <class F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+    auto size() const noexcept -> size_type;
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void work();
+};
+
+/**
+ * Starts the worker threads.
+ *
+ * @param threads the number of worker threads, at least one thread is started
+ */
+inline thread_pool::thread_pool(size_type threads) {
+    threads = threads == 0 ? 1 : threads;
+    workers.reserve(threads);
+    for (size_type i = 0; i < threads; ++i) {
+        workers.emplace_back(&thread_pool::work, this);
+    }
+}
+
+/**
+ * Runs the queued tasks and joins the worker threads.
+ */
+inline thread_pool::~thread_pool() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Queues a task for execution by one of the worker threads.
+ *
+ * @snippet test/thread_pool.test.cpp thread_pool
+ * @param task the function object to call without arguments
+ * @return a future for the result of the task or the exception it threw
+ */
+template <class F>
+auto thread_pool::submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using result_type = std::invoke_result_t<std::decay_t<F>>;
+
+    // std::function needs a copyable target, the packaged task is shared instead
+    auto packaged = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(task));
+    auto result = packaged->get_future();
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        tasks.emplace_back([packaged] { (*packaged)(); });
+    }
+    ready.notify_one();
+    return result;
+}
+
+/**
+ * Returns the number of worker threads.
+ *
+ * @return the number of worker threads
+ */
+inline auto thread_pool::size() const noexcept -> size_type {
+    return workers.size();
+}
+
+inline void thread_pool::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+}  // namespace util
+
+#endif  // THAT_THIS_UTIL_THREAD_POOL_HEADER_IS_ALREADY_INCLUDED
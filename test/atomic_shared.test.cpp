@@ -0,0 +1,122 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/atomic_shared.hpp"
+
+namespace helper {
+
+std::atomic<int> alive{0};  // NOLINT
+
+// a snapshot whose fields have to be consistent whenever a reader sees it
+struct snapshot {
+    int version;
+    int checksum;
+
+    explicit snapshot(int version) : version(version), checksum(-version) { ++alive; }
+    snapshot(const snapshot&) = delete;
+    auto operator=(const snapshot&) -> snapshot& = delete;
+    ~snapshot() {
+        checksum = 0;
+        --alive;
+    }
+};
+
+}  // namespace helper
+
+TEST(UtilAtomicShared, CtorDefault) {
+    const util::atomic_shared<std::string> empty;
+    assert(!empty.load());
+}
+
+TEST(UtilAtomicShared, LoadStore) {
+    //! [atomic_shared_load_store]
+    util::atomic_shared<std::string> config;
+    config.store(util::make_shared<std::string, util::atomic_count>("v1"));
+    const auto current = config.load();
+    config.store(util::make_shared<std::string, util::atomic_count>("v2"));
+    assert(*current == "v1");
+    assert(*config.load() == "v2");
+    //! [atomic_shared_load_store]
+
+    // the replaced instance is released once no reader can copy it anymore
+    const auto previous = config.exchange(nullptr);
+    assert(*previous == "v2");
+    util::hazard_domain::global().reclaim();
+    assert(previous.use_count() == 1);
+    assert(!config.load());
+}
+
+TEST(UtilAtomicShared, CompareExchange) {
+    //! [atomic_shared_compare_exchange]
+    util::atomic_shared<int> counter(util::make_shared<int, util::atomic_count>(1));
+    auto expected = counter.load();
+    assert(counter.compare_exchange(expected, util::make_shared<int, util::atomic_count>(2)));
+
+    // expected is outdated now and receives the current instance instead
+    assert(!counter.compare_exchange(expected, util::make_shared<int, util::atomic_count>(3)));
+    assert(*expected == 2);
+    //! [atomic_shared_compare_exchange]
+
+    util::shared<int, util::atomic_count> empty;
+    assert(!counter.compare_exchange(empty, nullptr));
+    assert(*empty == 2);
+
+    util::atomic_shared<int> unset;
+    util::shared<int, util::atomic_count> none;
+    assert(unset.compare_exchange(none, util::make_shared<int, util::atomic_count>(4)));
+    assert(*unset.load() == 4);
+}
+
+TEST(UtilAtomicShared, Concurrent) {
+    const auto make = [](int version) {
+        return util::make_shared<helper::snapshot, util::atomic_count>(version);
+    };
+    {
+        util::atomic_shared<helper::snapshot> current(make(0));
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&] {
+                while (!done) {
+                    const auto loaded = current.load();
+                    ASSERT_EQ(loaded->checksum, -loaded->version);
+                }
+            });
+        }
+
+        // one thread replaces snapshots blindly while two increment them with compare_exchange
+        std::thread writer([&] {
+            for (int i = 0; i < 2000; ++i) {
+                const auto previous = current.exchange(make(0));
+                ASSERT_EQ(previous->checksum, -previous->version);
+            }
+        });
+        std::vector<std::thread> incrementers;
+        for (int t = 0; t < 2; ++t) {
+            incrementers.emplace_back([&] {
+                for (int i = 0; i < 1000; ++i) {
+                    auto expected = current.load();
+                    while (!current.compare_exchange(expected, make(expected->version + 1))) {
+                    }
+                }
+            });
+        }
+        for (auto& incrementer : incrementers) {
+            incrementer.join();
+        }
+        writer.join();
+        done = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(current.load()->version <= 2000);
+        util::hazard_domain::global().reclaim();
+        assert(helper::alive == 1);
+    }
+    assert(helper::alive == 0);
+}
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/btree.hpp"
+
+namespace helper {
+
+template <class T, class Compare, class Allocator>
+void expect_equal(const util::btree<T, Compare, Allocator>& tree, const std::vector<T>& expected) {
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+    ASSERT_TRUE(std::equal(std::make_reverse_iterator(tree.end()),
+                           std::make_reverse_iterator(tree.begin()), expected.rbegin(),
+                           expected.rend()));
+    for (std::size_t i = 0; i < expected.size(); i += 7) {
+        ASSERT_EQ(tree[i], expected[i]);
+    }
+}
+
+// counts the live allocations of its arena and never propagates, like a polymorphic allocator
+template <class T>
+struct arena_allocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using is_always_equal = std::false_type;
+
+    explicit arena_allocator(int& live) noexcept : live(&live) {}
+    template <class U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : live(other.live) {}
+
+    auto allocate(std::size_t n) -> T* {
+        ++*live;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        --*live;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    int* live;
+};
+
+template <class T, class U>
+auto operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) -> bool {
+    return lhs.live == rhs.live;
+}
+
+template <class T, class U>
+auto operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) -> bool {
+    return !(lhs == rhs);
+}
+
+}  // namespace helper
+
+TEST(UtilBtree, CtorDefault) {
+    const util::btree<int> empty;
+    assert(empty.empty());
+    assert(empty.size() == 0);
+    assert(empty.height() == 0);
+    assert(empty.begin() == empty.end());
+}
+
+TEST(UtilBtree, Insert) {
+    //! [btree_insert]
+    util::btree<std::string> names;
+    names.insert("Dora");
+    names.insert("Chris");
+    auto it = names.insert("Eve");
+    assert(*it == "Eve");
+    assert(names.front() == "Chris");
+    assert(names.back() == "Eve");
+    assert(names.size() == 3);
+    //! [btree_insert]
+}
+
+TEST(UtilBtree, InsertKeepsEquivalentOrder) {
+    using pair = std::pair<int, int>;
+    struct first_less {
+        auto operator()(const pair& lhs, const pair& rhs) const -> bool {
+            return lhs.first < rhs.first;
+        }
+    };
+    util::btree<pair, first_less> pairs;
+    std::vector<pair> expected;
+    for (int i = 0; i < 5000; ++i) {
+        pairs.insert({i % 3, i});
+    }
+    for (int key = 0; key < 3; ++key) {
+        for (int i = key; i < 5000; i += 3) {
+            expected.emplace_back(key, i);
+        }
+    }
+
+    assert(pairs.height() > 1);
+    helper::expect_equal(pairs, expected);
+}
+
+TEST(UtilBtree, OperatorSquareBrackets) {
+    //! [btree_operator_square_brackets]
+    util::btree<int> numbers;
+    for (int i = 1000; i > 0; --i) {
+        numbers.insert(i);
+    }
+    assert(numbers[0] == 1);
+    assert(numbers[41] == 42);
+    assert(numbers[999] == 1000);
+    //! [btree_operator_square_brackets]
+
+    try {
+        numbers.at(1000);
+    } catch (const std::out_of_range& x) {
+        assert(true);
+    }
+}
+
+TEST(UtilBtree, LowerBound) {
+    //! [btree_lower_bound]
+    util::btree<int> numbers;
+    numbers.insert(30);
+    numbers.insert(10);
+    numbers.insert(20);
+    assert(*numbers.lower_bound(15) == 20);
+    assert(*numbers.upper_bound(20) == 30);
+    assert(numbers.lower_bound(31) == numbers.end());
+    assert(numbers.find(25) == numbers.end());
+    //! [btree_lower_bound]
+
+    util::btree<int> many;
+    for (int i = 0; i < 10000; ++i) {
+        many.insert(i / 4 * 2);
+    }
+    for (int i = -1; i < 5001; ++i) {
+        const auto lower = many.lower_bound(i);
+        const auto upper = many.upper_bound(i);
+        ASSERT_EQ(lower == many.end() ? -1 : *lower, i > 4998 ? -1 : (i + 1) / 2 * 2);
+        const auto present = i >= 0 && i <= 4998 && i % 2 == 0;
+        ASSERT_EQ(many.index_of(upper) - many.index_of(lower), present ? 4U : 0U);
+    }
+}
+
+TEST(UtilBtree, Rank) {
+    //! [btree_rank]
+    util::btree<int> numbers;
+    for (const auto number : {5, 1, 3, 3, 9}) {
+        numbers.insert(number);
+    }
+    assert(numbers.rank(0) == 0);
+    assert(numbers.rank(3) == 1);
+    assert(numbers.rank(4) == 3);
+    assert(numbers.rank(10) == 5);
+    //! [btree_rank]
+
+    util::btree<int> many;
+    for (int i = 9999; i >= 0; --i) {
+        many.insert(i * 2);
+    }
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(many.rank(i * 2), static_cast<std::size_t>(i));
+        ASSERT_EQ(many.rank(i * 2 + 1), static_cast<std::size_t>(i + 1));
+        ASSERT_EQ(many.index_of(many.lower_bound(i * 2)), many.rank(i * 2));
+    }
+}
+
+TEST(UtilBtree, BulkLoad) {
+    //! [btree_bulk_load]
+    std::vector<int> numbers(100000);
+    std::iota(numbers.begin(), numbers.end(), 0);
+    util::btree<int> tree;
+    tree.bulk_load(numbers.begin(), numbers.end());
+    assert(tree.size() == 100000);
+    assert(tree.rank(5000) == 5000);
+    //! [btree_bulk_load]
+
+    helper::expect_equal(tree, numbers);
+
+    // a bulk loaded tree is as flat as possible and keeps working after inserts and erases
+    for (int i = 0; i < 100000; i += 3) {
+        tree.insert(i);
+        numbers.insert(std::upper_bound(numbers.begin(), numbers.end(), i), i);
+    }
+    for (int i = 0; i < 100000; i += 5) {
+        tree.erase(tree.find(i));
+        numbers.erase(std::lower_bound(numbers.begin(), numbers.end(), i));
+    }
+    helper::expect_equal(tree, numbers);
+
+    for (std::size_t size = 0; size < 2000; size += 37) {
+        util::btree<int> small;
+        small.bulk_load(numbers.begin(), numbers.begin() + size);
+        helper::expect_equal(small, std::vector<int>(numbers.begin(), numbers.begin() + size));
+        while (!small.empty()) {
+            small.erase(small.begin());
+        }
+    }
+}
+
+TEST(UtilBtree, Erase) {
+    //! [btree_erase]
+    util::btree<int> numbers;
+    numbers.insert(1);
+    numbers.insert(2);
+    numbers.insert(3);
+    auto next = numbers.erase(numbers.find(2));
+    assert(*next == 3);
+    assert(numbers.size() == 2);
+    assert(numbers[1] == 3);
+    //! [btree_erase]
+
+    numbers.erase(numbers.begin(), numbers.end());
+    assert(numbers.empty());
+    assert(numbers.height() == 0);
+}
+
+TEST(UtilBtree, EraseRebalances) {
+    util::btree<int> numbers;
+    std::vector<int> expected;
+    for (int i = 0; i < 20000; ++i) {
+        numbers.insert(i);
+        expected.push_back(i);
+    }
+    const auto height = numbers.height();
+    assert(height > 2);
+
+    // erasing from the front, the back and the middle borrows from and merges with both siblings
+    for (int i = 0; i < 6000; ++i) {
+        numbers.erase(numbers.begin());
+        numbers.erase(std::prev(numbers.end()));
+        numbers.erase(numbers.find(expected[expected.size() / 2]));
+        expected.erase(expected.begin());
+        expected.pop_back();
+        expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(expected.size() / 2));
+    }
+    helper::expect_equal(numbers, expected);
+    assert(numbers.height() < height);
+
+    const auto last = numbers.erase(numbers.find(expected[10]), numbers.find(expected[1900]));
+    expected.erase(expected.begin() + 10, expected.begin() + 1900);
+    assert(*last == expected[10]);
+    helper::expect_equal(numbers, expected);
+}
+
+TEST(UtilBtree, EraseRange) {
+    util::btree<int> numbers;
+    std::vector<int> expected;
+    for (int i = 0; i < 4000; ++i) {
+        numbers.insert(i / 4);
+        expected.push_back(i / 4);
+    }
+
+    // a short range is erased element by element, a long one rebuilds the tree from the rest
+    for (const auto& [low, high] : {std::pair(100, 120), std::pair(200, 900)}) {
+        const auto next = numbers.erase(numbers.lower_bound(low), numbers.upper_bound(high));
+        expected.erase(std::lower_bound(expected.begin(), expected.end(), low),
+                       std::upper_bound(expected.begin(), expected.end(), high));
+        assert(*next == high + 1);
+        helper::expect_equal(numbers, expected);
+    }
+
+    numbers.insert(150);
+    assert(numbers.rank(150) == numbers.index_of(numbers.find(150)));
+    assert(numbers.erase(numbers.begin(), numbers.end()) == numbers.end());
+    assert(numbers.empty());
+}
+
+TEST(UtilBtree, Iterate) {
+    util::btree<int> numbers;
+    numbers.insert(2);
+    numbers.insert(1);
+    numbers.insert(3);
+
+    std::vector<int> backwards(numbers.size());
+    std::reverse_copy(numbers.begin(), numbers.end(), backwards.begin());
+    assert(backwards == std::vector<int>({3, 2, 1}));
+}
+
+TEST(UtilBtree, CopyAndMove) {
+    util::btree<std::string> names;
+    for (int i = 0; i < 1000; ++i) {
+        names.insert(std::to_string(i));
+    }
+
+    const auto copy = names;
+    assert(std::equal(copy.begin(), copy.end(), names.begin(), names.end()));
+
+    auto moved = std::move(names);
+    assert(std::equal(copy.begin(), copy.end(), moved.begin(), moved.end()));
+    assert(names.empty());  // NOLINT(bugprone-use-after-move)
+
+    names = moved;
+    names.insert("Eve");
+    assert(names.size() == 1001);
+    assert(names.back() == "Eve");
+    assert(moved.size() == 1000);
+
+    names.swap(moved);
+    assert(names.size() == 1000);
+    assert(moved.back() == "Eve");
+}
+
+TEST(UtilBtree, AssignWithoutPropagatingAllocator) {
+    using tree = util::btree<int, std::less<int>, helper::arena_allocator<int>>;
+    int first_live = 0;
+    int second_live = 0;
+    {
+        tree first{std::less<int>(), helper::arena_allocator<int>(first_live)};
+        tree second{std::less<int>(), helper::arena_allocator<int>(second_live)};
+        std::vector<int> expected(5000);
+        std::iota(expected.begin(), expected.end(), 0);
+        second.bulk_load(expected.begin(), expected.end());
+
+        // the nodes of the second arena cannot be freed by the first, so they are moved into new
+        first = std::move(second);
+        helper::expect_equal(first, expected);
+        assert(first_live > 0 && second_live == 0);
+        assert(second.empty());  // NOLINT(bugprone-use-after-move)
+
+        second.insert(7);
+        second = first;
+        helper::expect_equal(second, expected);
+        assert(second_live == first_live);
+
+        // a long range erase rebuilds the tree with the same allocator
+        first.erase(first.begin(), first.find(4000));
+        assert(first.size() == 1000);
+
+        auto third = std::move(first);
+        third = std::move(first);
+        assert(third.empty());
+    }
+    assert(first_live == 0);
+    assert(second_live == 0);
+}
+
+TEST(UtilBtree, RandomOperations) {
+    std::mt19937 gen(7);  // NOLINT
+    std::uniform_int_distribution<int> values(0, 3000);
+    util::btree<int> tree;
+    std::vector<int> expected;
+
+    for (int i = 0; i < 60000; ++i) {
+        const auto value = values(gen);
+        if (gen() % 3 == 0 && !expected.empty()) {
+            const auto erased = expected[gen() % expected.size()];
+            const auto next = tree.erase(tree.find(erased));
+            expected.erase(std::lower_bound(expected.begin(), expected.end(), erased));
+            assert(next == tree.upper_bound(erased) || *next == erased);
+        } else {
+            const auto it = tree.insert(value);
+            expected.insert(std::upper_bound(expected.begin(), expected.end(), value), value);
+            assert(*it == value && std::next(it) == tree.upper_bound(value));
+        }
+
+        if (i % 5000 == 0) {
+            helper::expect_equal(tree, expected);
+        }
+    }
+
+    helper::expect_equal(tree, expected);
+}
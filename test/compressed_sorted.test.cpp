@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/compressed_sorted.hpp"
+
+namespace helper {
+
+template <class T>
+auto dense_values(std::size_t count, std::uint64_t spread, std::uint32_t seed) -> std::vector<T> {
+    std::mt19937_64 gen(seed);
+    std::vector<T> values(count);
+    std::generate(values.begin(), values.end(), [&] { return static_cast<T>(gen() % spread); });
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+template <class T>
+void check_round_trip(const std::vector<T>& values) {
+    const util::compressed_sorted<T> compressed(util::presorted, values.begin(), values.end());
+    ASSERT_EQ(compressed.size(), values.size());
+    ASSERT_EQ(compressed.decode(), values);
+    ASSERT_TRUE(std::equal(compressed.begin(), compressed.end(), values.begin(), values.end()));
+
+    // the queries ascend, so one iterator walks along to the expected positions in linear time
+    auto walker = compressed.begin();
+    std::ptrdiff_t walked = 0;
+    for (std::size_t i = 0; i < values.size(); i += 7) {
+        const auto value = values[i];
+        const auto expected = std::lower_bound(values.begin(), values.end(), value);
+        const auto it = compressed.lower_bound(value);
+        ASSERT_EQ(*it, *expected);
+        const auto position = std::distance(values.begin(), expected);
+        std::advance(walker, position - walked);
+        walked = position;
+        ASSERT_TRUE(it == walker);
+        ASSERT_TRUE(compressed.contains(value));
+    }
+}
+
+}  // namespace helper
+
+TEST(UtilCompressedSorted, CompressedSorted) {
+    //! [compressed_sorted]
+    util::sorted_vector<std::uint64_t> ids;
+    for (std::uint64_t id = 1'000'000; id < 1'010'000; id += 3) {
+        ids.insert(id);
+    }
+
+    const auto compressed = util::compress(ids);
+    assert(compressed.size() == ids.size());
+    assert(compressed.contains(1'000'003));
+    assert(!compressed.contains(1'000'004));
+    assert(*compressed.lower_bound(1'000'004) == 1'000'006);
+    assert(compressed.memory_usage() < ids.size() * sizeof(std::uint64_t) / 8);
+    //! [compressed_sorted]
+}
+
+TEST(UtilCompressedSorted, Empty) {
+    const util::compressed_sorted<std::uint32_t> empty;
+    assert(empty.empty());
+    assert(empty.begin() == empty.end());
+    assert(empty.lower_bound(0) == empty.end());
+    assert(!empty.contains(0));
+    assert(empty.decode().empty());
+}
+
+TEST(UtilCompressedSorted, Unsorted) {
+    const std::vector<std::uint32_t> values = {9, 3, 7, 3, 1};
+    const util::compressed_sorted<std::uint32_t> compressed(values.begin(), values.end());
+    assert(compressed.decode() == std::vector<std::uint32_t>({1, 3, 3, 7, 9}));
+    assert(compressed.lower_bound(10) == compressed.end());
+    assert(compressed.find(4) == compressed.end());
+}
+
+TEST(UtilCompressedSorted, InputIterator) {
+    std::istringstream stream("1 5 8");
+    const util::compressed_sorted<std::uint16_t> compressed(
+        util::presorted, std::istream_iterator<std::uint16_t>(stream),
+        std::istream_iterator<std::uint16_t>());
+    assert(compressed.size() == 3);
+    assert(compressed.contains(5));
+}
+
+TEST(UtilCompressedSorted, RoundTrip) {
+    for (const std::size_t count : {1, 127, 128, 129, 1000, 100'000}) {
+        helper::check_round_trip(helper::dense_values<std::uint64_t>(count, count * 4, 1));
+        helper::check_round_trip(helper::dense_values<std::uint32_t>(count, count * 4, 2));
+        helper::check_round_trip(helper::dense_values<std::uint16_t>(count, 65536, 3));
+        helper::check_round_trip(helper::dense_values<std::uint8_t>(count, 256, 4));
+    }
+}
+
+TEST(UtilCompressedSorted, WideDeltas) {
+    constexpr auto max64 = std::numeric_limits<std::uint64_t>::max();
+    helper::check_round_trip(helper::dense_values<std::uint64_t>(1000, max64, 5));
+    helper::check_round_trip(std::vector<std::uint64_t>{0, max64 / 2, max64 - 1, max64});
+
+    constexpr auto max32 = std::numeric_limits<std::uint32_t>::max();
+    helper::check_round_trip(helper::dense_values<std::uint32_t>(1000, max32, 6));
+    helper::check_round_trip(std::vector<std::uint32_t>(300, 42));  // only zero differences
+}
+
+TEST(UtilCompressedSorted, DecodeBlock) {
+    const auto values = helper::dense_values<std::uint32_t>(300, 10'000, 7);
+    const util::compressed_sorted<std::uint32_t> compressed(util::presorted, values.begin(),
+                                                            values.end());
+    std::vector<std::uint32_t> block(util::compressed_sorted<std::uint32_t>::block_size);
+    assert(compressed.decode_block(2, block.data()) == 44);
+    assert(std::equal(block.begin(), block.begin() + 44, values.begin() + 256));
+}
+
+TEST(UtilCompressedSorted, Absent) {
+    std::vector<std::uint32_t> values;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        values.push_back(i * 10);
+    }
+    const util::compressed_sorted<std::uint32_t> compressed(util::presorted, values.begin(),
+                                                            values.end());
+    for (std::uint32_t query = 0; query < 10'005; ++query) {
+        const auto it = compressed.lower_bound(query);
+        if (query > 9990) {
+            ASSERT_EQ(it, compressed.end());
+        } else {
+            ASSERT_EQ(*it, (query + 9) / 10 * 10);
+        }
+        ASSERT_EQ(compressed.contains(query), query % 10 == 0 && query <= 9990);
+    }
+}
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/concurrent_sorted.hpp"
+
+TEST(UtilConcurrentSorted, ConcurrentSorted) {
+    //! [concurrent_sorted]
+    util::concurrent_sorted_vector<int> routes(util::sorted_vector<int>{30, 10, 20});
+
+    const auto before = routes.read();
+    routes.insert(15);
+    const std::vector<int> batch = {5, 25};
+    routes.insert(batch.begin(), batch.end());
+
+    assert(before->size() == 3);  // a snapshot does not change
+    const auto after = routes.read();
+    assert(after->size() == 6);
+    assert(after->at(1) == 10);
+    //! [concurrent_sorted]
+}
+
+TEST(UtilConcurrentSorted, Readers) {
+    util::concurrent_sorted_vector<int> numbers;
+    assert(numbers.size() == 0);
+    assert(!numbers.contains(1));
+    numbers.insert(1);
+    assert(numbers.size() == 1);
+    assert(numbers.contains(1));
+}
+
+TEST(UtilConcurrentSorted, Writers) {
+    util::concurrent_sorted_vector<int> numbers;
+    const std::vector<int> batch = {3, 1, 2, 2};
+    numbers.insert(batch.begin(), batch.end());
+    assert(numbers.size() == 4);
+
+    assert(numbers.erase(2) == 2);
+    assert(numbers.erase(7) == 0);
+    assert(numbers.size() == 2);
+
+    numbers.update([](util::sorted_vector<int>& next) { next.insert(0); });
+    assert(numbers.read()->front() == 0);
+
+    numbers.assign(util::sorted_vector<int>{9});
+    assert(numbers.read()->front() == 9);
+}
+
+TEST(UtilConcurrentSorted, SkipListBackend) {
+    util::concurrent_sorted<util::skip_list<int>> numbers;
+    const std::vector<int> batch = {4, 2, 3};
+    numbers.insert(batch.begin(), batch.end());
+    numbers.insert(1);
+    assert(numbers.read()->at(0) == 1);
+    assert(numbers.read()->at(3) == 4);
+}
+
+TEST(UtilConcurrentSorted, SnapshotMove) {
+    util::concurrent_sorted_vector<int> numbers(util::sorted_vector<int>{1});
+    auto first = numbers.read();
+    auto second = std::move(first);
+    numbers.insert(2);
+    assert(second->size() == 1);
+    second = numbers.read();
+    assert(second->size() == 2);
+}
+
+TEST(UtilConcurrentSorted, ManySnapshots) {
+    util::concurrent_sorted_vector<int> numbers;
+    std::vector<util::concurrent_sorted_vector<int>::snapshot> snapshots;
+    for (std::size_t i = 0; i < 256; ++i) {
+        snapshots.push_back(numbers.read());
+        numbers.insert(static_cast<int>(i));
+    }
+    for (std::size_t i = 0; i < snapshots.size(); ++i) {
+        assert(snapshots[i]->size() == i);
+    }
+}
+
+TEST(UtilConcurrentSorted, ConcurrentReadersAndWriter) {
+    util::concurrent_sorted_vector<int> numbers;
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            std::size_t last_size = 0;
+            while (!done) {
+                const auto snapshot = numbers.read();
+                // the writer inserts 0, 1, 2, ... so every version is a prefix of the numbers
+                const auto size = snapshot->size();
+                if (size < last_size ||
+                    (size > 0 && snapshot->back() != static_cast<int>(size) - 1)) {
+                    consistent = false;
+                }
+                last_size = size;
+            }
+        });
+    }
+
+    for (int i = 0; i < 2000; ++i) {
+        numbers.insert(i);
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    assert(consistent);
+    assert(numbers.size() == 2000);
+}
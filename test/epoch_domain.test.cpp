@@ -0,0 +1,77 @@
+#include <atomic>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/epoch_domain.hpp"
+
+namespace helper {
+
+struct counted {
+    static std::atomic<int> alive;  // NOLINT
+
+    int value;
+
+    explicit counted(int value) : value(value) { ++alive; }
+    counted(const counted&) = delete;
+    auto operator=(const counted&) -> counted& = delete;
+    ~counted() { --alive; }
+};
+
+std::atomic<int> counted::alive{0};  // NOLINT
+
+}  // namespace helper
+
+TEST(UtilEpochDomain, ReadLock) {
+    //! [epoch_domain_read_lock]
+    util::epoch_domain domain;
+    std::atomic<helper::counted*> current{new helper::counted(1)};
+
+    {
+        const util::epoch_domain::read_lock lock(domain);
+        const auto* loaded = current.load();
+
+        // a writer replaces the object, which is not reclaimed while the reader holds its lock
+        domain.retire(current.exchange(new helper::counted(2)));
+        domain.reclaim();
+        assert(loaded->value == 1);
+        assert(domain.retired_count() == 1);
+    }
+
+    domain.reclaim();
+    assert(domain.retired_count() == 0);
+    //! [epoch_domain_read_lock]
+
+    delete current.load();
+    assert(helper::counted::alive == 0);
+}
+
+TEST(UtilEpochDomain, LaterReadLocksDoNotDelay) {
+    util::epoch_domain domain;
+    domain.retire(new helper::counted(1));
+
+    // a read lock taken after the object was retired cannot have seen it
+    const util::epoch_domain::read_lock lock(domain);
+    domain.reclaim();
+    assert(domain.retired_count() == 0);
+    assert(helper::counted::alive == 0);
+}
+
+TEST(UtilEpochDomain, NestedAndMoved) {
+    util::epoch_domain domain;
+    util::epoch_domain::read_lock outer(domain);
+    domain.retire(new helper::counted(1));
+    {
+        const util::epoch_domain::read_lock inner(domain);
+    }
+    domain.reclaim();
+    assert(domain.retired_count() == 1);
+
+    auto moved = std::move(outer);
+    domain.reclaim();
+    assert(domain.retired_count() == 1);
+
+    moved = util::epoch_domain::read_lock(domain);
+    domain.reclaim();
+    assert(domain.retired_count() == 0);
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/frozen_sorted.hpp"
+
+TEST(UtilFrozenSorted, CtorDefault) {
+    const util::frozen_sorted<int> empty;
+    assert(empty.empty());
+    assert(empty.size() == 0);
+    assert(empty.lower_bound(1) == nullptr);
+    assert(!empty.contains(1));
+}
+
+TEST(UtilFrozenSorted, CtorSorted) {
+    //! [frozen_sorted_ctor_sorted]
+    const util::sorted_vector<int> numbers = {3, 1, 2};
+    const util::frozen_sorted<int> frozen(numbers);
+    assert(frozen.size() == 3);
+    assert(frozen.contains(2));
+    //! [frozen_sorted_ctor_sorted]
+}
+
+TEST(UtilFrozenSorted, CtorIter) {
+    //! [frozen_sorted_ctor_iter]
+    const std::vector<std::string> names = {"Chris", "Dora", "Eve"};
+    const util::frozen_sorted<std::string> frozen(names.begin(), names.end());
+    assert(frozen.contains("Dora"));
+    assert(!frozen.contains("Bob"));
+    //! [frozen_sorted_ctor_iter]
+}
+
+TEST(UtilFrozenSorted, Freeze) {
+    //! [frozen_sorted_freeze]
+    const util::sorted_vector<double> doubles = {2.5, 0.5, 1.5};
+    const auto frozen = util::freeze(doubles);
+    assert(*frozen.find(1.5) == 1.5);
+    //! [frozen_sorted_freeze]
+}
+
+TEST(UtilFrozenSorted, LowerBound) {
+    //! [frozen_sorted_lower_bound]
+    const util::sorted_vector<int> numbers = {10, 20, 30};
+    const auto frozen = util::freeze(numbers);
+    assert(*frozen.lower_bound(5) == 10);
+    assert(*frozen.lower_bound(20) == 20);
+    assert(*frozen.lower_bound(21) == 30);
+    assert(frozen.lower_bound(31) == nullptr);
+    //! [frozen_sorted_lower_bound]
+}
+
+TEST(UtilFrozenSorted, LowerBoundMatchesStd) {
+    std::mt19937 gen(42);  // NOLINT
+    std::uniform_int_distribution<int> dist(0, 5000);
+
+    for (std::size_t size : {1, 2, 3, 7, 8, 15, 16, 17, 100, 1023, 1024, 1025, 4000}) {
+        std::vector<int> values(size);
+        std::generate(values.begin(), values.end(), [&] { return dist(gen); });
+        std::sort(values.begin(), values.end());
+        const util::frozen_sorted<int> frozen(values.begin(), values.end());
+
+        for (int key = -1; key <= 5001; ++key) {
+            const auto expected = std::lower_bound(values.begin(), values.end(), key);
+            const auto* const found = frozen.lower_bound(key);
+            if (expected == values.end()) {
+                EXPECT_EQ(found, nullptr);
+            } else {
+                ASSERT_NE(found, nullptr);
+                EXPECT_EQ(*found, *expected);
+            }
+        }
+    }
+}
+
+TEST(UtilFrozenSorted, Find) {
+    //! [frozen_sorted_find]
+    const util::sorted_vector<int> numbers = {1, 3, 5};
+    const auto frozen = util::freeze(numbers);
+    assert(*frozen.find(3) == 3);
+    assert(frozen.find(4) == nullptr);
+    //! [frozen_sorted_find]
+}
+
+TEST(UtilFrozenSorted, Compare) {
+    const util::sorted<std::vector<int>, std::greater<int>> numbers = {1, 3, 5};
+    const auto frozen = util::freeze(numbers);
+    assert(*frozen.lower_bound(4) == 3);
+    assert(frozen.lower_bound(0) == nullptr);
+    assert(frozen.contains(5));
+}
@@ -0,0 +1,161 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/hazard_pointer.hpp"
+#include "util/scoped.hpp"
+
+namespace helper {
+
+struct counted {
+    static std::atomic<int> alive;  // NOLINT
+
+    int value;
+    int checksum;
+
+    explicit counted(int value) : value(value), checksum(~value) { ++alive; }
+    counted(const counted&) = delete;
+    auto operator=(const counted&) -> counted& = delete;
+    ~counted() {
+        checksum = 0;
+        --alive;
+    }
+};
+
+std::atomic<int> counted::alive{0};  // NOLINT
+
+}  // namespace helper
+
+TEST(UtilHazardPointer, Protect) {
+    //! [hazard_pointer_protect]
+    util::hazard_domain domain;
+    std::atomic<helper::counted*> current{new helper::counted(1)};
+
+    util::hazard_pointer hazard(domain);
+    const auto* loaded = hazard.protect(current);
+
+    // a writer replaces the object, which is not reclaimed while it is protected
+    domain.retire(current.exchange(new helper::counted(2)));
+    domain.reclaim();
+    assert(loaded->value == 1);
+    assert(domain.retired_count() == 1);
+
+    hazard.reset_protection();
+    domain.reclaim();
+    assert(domain.retired_count() == 0);
+    //! [hazard_pointer_protect]
+
+    delete current.load();
+    assert(helper::counted::alive == 0);
+}
+
+TEST(UtilHazardPointer, TryProtect) {
+    util::hazard_domain domain;
+    helper::counted first(1);
+    helper::counted second(2);
+    std::atomic<helper::counted*> current{&first};
+
+    util::hazard_pointer hazard(domain);
+    auto* expected = &second;
+    assert(!hazard.try_protect(expected, current));
+    assert(expected == &first);
+    assert(hazard.try_protect(expected, current));
+}
+
+TEST(UtilHazardPointer, RetireWithDeleter) {
+    //! [hazard_pointer_retire_with_deleter]
+    util::hazard_domain domain;
+    util::scoped<helper::counted> owner(new helper::counted(1));
+    int reclaimed = 0;
+    domain.retire(owner.release(), [&reclaimed](helper::counted* ptr) {
+        ++reclaimed;
+        delete ptr;
+    });
+    domain.reclaim();
+    assert(reclaimed == 1);
+    //! [hazard_pointer_retire_with_deleter]
+
+    // retiring in batches reclaims without explicit calls
+    for (std::size_t i = 0; i < 10 * util::hazard_domain::min_batch; ++i) {
+        domain.retire(new helper::counted(static_cast<int>(i)));
+    }
+    assert(domain.retired_count() < util::hazard_domain::min_batch);
+    assert(helper::counted::alive < static_cast<int>(util::hazard_domain::min_batch));
+}
+
+TEST(UtilHazardPointer, DomainReclaimsOnDestruction) {
+    {
+        util::hazard_domain domain;
+        for (int i = 0; i < 10; ++i) {
+            domain.retire(new helper::counted(i));
+        }
+        assert(helper::counted::alive == 10);
+    }
+    assert(helper::counted::alive == 0);
+}
+
+TEST(UtilHazardPointer, Stress) {
+    // a lock-free stack whose popped nodes are retired while other threads traverse it
+    struct node {
+        helper::counted payload;
+        std::atomic<node*> next{nullptr};
+        std::atomic<bool> popped{false};
+
+        explicit node(int value) : payload(value) {}
+    };
+
+    std::atomic<node*> head{nullptr};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < 2; ++r) {
+        threads.emplace_back([&] {
+            util::hazard_pointer current;
+            util::hazard_pointer next;
+            while (!done) {
+                auto* visited = current.protect(head);
+                while (visited) {
+                    ASSERT_EQ(visited->payload.checksum, ~visited->payload.value);
+                    auto* following = next.protect(visited->next);
+                    // only a node still on the stack guarantees its successor was not popped yet
+                    if (visited->popped) {
+                        break;
+                    }
+                    current.swap(next);
+                    visited = following;
+                }
+                current.reset_protection();
+                next.reset_protection();
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        util::hazard_pointer hazard;
+        for (int i = 0; i < 20000; ++i) {
+            auto* pushed = new node(i);
+            pushed->next = head.load();
+            head = pushed;
+
+            if (i % 2 == 0) {
+                auto* popped = hazard.protect(head);
+                head = popped->next.load();
+                popped->popped = true;
+                hazard.reset_protection();
+                util::hazard_domain::global().retire(popped);
+            }
+        }
+        done = true;
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    while (auto* remaining = head.load()) {
+        head = remaining->next.load();
+        delete remaining;
+    }
+    util::hazard_domain::global().reclaim();
+    assert(helper::counted::alive == 0);
+}
@@ -0,0 +1,177 @@
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/inline_poly.hpp"
+
+namespace helper {
+struct shape {
+    shape() = default;
+    shape(const shape&) = default;
+    shape(shape&&) = default;
+    auto operator=(const shape&) -> shape& = default;
+    auto operator=(shape&&) -> shape& = default;
+    virtual ~shape() = default;
+
+    virtual auto area() const -> int = 0;
+};
+
+struct square : shape {
+    explicit square(int side) : side(side) {}
+
+    auto area() const -> int override { return side * side; }
+
+    int side;
+};
+
+struct rectangle : shape {
+    rectangle(int width, int height) : width(width), height(height) {}
+
+    auto area() const -> int override { return width * height; }
+
+    int width;
+    int height;
+};
+
+// counts its live instances, without a virtual destructor in its base
+struct counted_base {
+    virtual auto name() const -> std::string = 0;
+
+protected:
+    ~counted_base() = default;
+};
+
+struct counted : counted_base {
+    explicit counted(int& alive) : alive(&alive) { ++alive; }
+    counted(counted&& other) noexcept : alive(other.alive) { ++*alive; }
+    counted(const counted&) = delete;
+    auto operator=(const counted&) -> counted& = delete;
+    auto operator=(counted&&) -> counted& = delete;
+    ~counted() { --*alive; }
+
+    auto name() const -> std::string override { return "counted"; }
+
+    int* alive;
+};
+
+struct large : shape {
+    auto area() const -> int override { return static_cast<int>(cells.size()); }
+
+    std::array<int, 64> cells{};
+};
+
+// may throw when moved, so it is never stored inline
+struct throwing_move : shape {
+    throwing_move() = default;
+    throwing_move(throwing_move&&) noexcept(false) {}
+
+    auto area() const -> int override { return 1; }
+};
+
+struct failing : shape {
+    failing() { throw std::runtime_error("construction failed"); }
+
+    auto area() const -> int override { return 0; }
+};
+}  // namespace helper
+
+TEST(UtilInlinePoly, Ctor) {
+    // clang-format off
+//! [inline_poly_ctor]
+util::inline_poly<helper::shape, 16> shape(std::in_place_type<helper::rectangle>, 2, 3);
+assert(shape->area() == 6);
+shape = helper::square(4);
+assert(shape->area() == 16);
+//! [inline_poly_ctor]
+    // clang-format on
+
+    const util::inline_poly<helper::shape, 16> empty;
+    assert(!empty);
+    assert(empty.get() == nullptr);
+    const util::inline_poly<helper::shape, 16> null = nullptr;
+    assert(!null);
+}
+
+TEST(UtilInlinePoly, StoredInline) {
+    using holder = util::inline_poly<helper::shape, 16>;
+    static_assert(holder::fits<helper::square>, "fits into the storage");
+    static_assert(!holder::fits<helper::large>, "is larger than the storage");
+    static_assert(!holder::fits<helper::throwing_move>, "may throw when moved");
+
+    holder shape(helper::square(3));
+    const auto* address = reinterpret_cast<const char*>(shape.get());
+    const auto* begin = reinterpret_cast<const char*>(&shape);
+    assert(address >= begin && address < begin + sizeof(shape));
+    assert((*shape).area() == 9);
+}
+
+TEST(UtilInlinePoly, Move) {
+    int alive = 0;
+    {
+        util::inline_poly<helper::counted_base, 16> first(std::in_place_type<helper::counted>,
+                                                          alive);
+        assert(alive == 1);
+
+        auto second = std::move(first);
+        assert(!first);
+        assert(second->name() == "counted");
+        assert(alive == 1);
+
+        util::inline_poly<helper::counted_base, 16> third(std::in_place_type<helper::counted>,
+                                                          alive);
+        assert(alive == 2);
+        third = std::move(second);
+        assert(alive == 1);
+        assert(!second);
+
+        first.swap(third);
+        assert(first && !third);
+        assert(alive == 1);
+    }
+    assert(alive == 0);
+}
+
+TEST(UtilInlinePoly, Emplace) {
+    int alive = 0;
+    util::inline_poly<helper::counted_base, 16> object;
+    auto& first = object.emplace<helper::counted>(alive);
+    assert(object.get() == &first);
+    object.emplace<helper::counted>(alive);
+    assert(alive == 1);
+    object.reset();
+    assert(alive == 0);
+    assert(!object);
+
+    util::inline_poly<helper::shape, 16> shape(helper::square(2));
+    try {
+        shape.emplace<helper::failing>();
+        assert(false);
+    } catch (const std::runtime_error&) {
+        assert(!shape);
+    }
+}
+
+TEST(UtilInlinePoly, HeapFallback) {
+    //! [inline_poly_heap_fallback]
+    using holder = util::inline_poly<helper::shape, 16, alignof(std::max_align_t), true>;
+    holder shape(helper::large{});
+    assert(shape->area() == 64);
+    //! [inline_poly_heap_fallback]
+
+    const auto* address = reinterpret_cast<const char*>(shape.get());
+    const auto* begin = reinterpret_cast<const char*>(&shape);
+    assert(address < begin || address >= begin + sizeof(shape));
+
+    auto moved = std::move(shape);
+    assert(!shape);
+    assert(moved.get() == reinterpret_cast<const helper::shape*>(address));
+
+    moved = helper::throwing_move();
+    assert(moved->area() == 1);
+    moved = helper::square(5);
+    assert(moved->area() == 25);
+}
@@ -0,0 +1,103 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/intrusive.hpp"
+
+namespace helper {
+
+struct node : util::intrusive_base<node> {
+    int value = 0;
+    util::intrusive<node> left;
+    util::intrusive<node> right;
+
+    explicit node(int value) : value(value) {}
+
+    // hands out a handle to itself, sharing the counter with all other handles
+    auto self() -> util::intrusive<node> { return this; }
+};
+
+class dtor_flag : public util::intrusive_base<dtor_flag, util::atomic_count> {
+    bool* flag = nullptr;
+
+public:
+    explicit dtor_flag(bool* flag) : flag(flag) {}
+    dtor_flag(const dtor_flag&) = delete;
+    auto operator=(const dtor_flag&) -> dtor_flag& = delete;
+    ~dtor_flag() { *flag = true; }
+};
+
+}  // namespace helper
+
+TEST(UtilIntrusive, CtorDefault) {
+    const util::intrusive<helper::node> empty;
+    assert(!empty);
+    assert(empty.use_count() == 0);
+    static_assert(sizeof(empty) == sizeof(helper::node*), "a handle is one pointer wide");
+}
+
+TEST(UtilIntrusive, MakeIntrusive) {
+    //! [intrusive_make_intrusive]
+    auto root = util::make_intrusive<helper::node>(1);
+    root->left = util::make_intrusive<helper::node>(2);
+    root->right = util::make_intrusive<helper::node>(3);
+    assert(root->left->value + root->right->value == 5);
+    assert(root.use_count() == 1);
+    //! [intrusive_make_intrusive]
+}
+
+TEST(UtilIntrusive, FromThis) {
+    //! [intrusive_from_this]
+    auto root = util::make_intrusive<helper::node>(1);
+    auto self = root->self();
+    assert(self.get() == root.get());
+    assert(root.use_count() == 2);
+    //! [intrusive_from_this]
+
+    self.reset();
+    assert(root.use_count() == 1);
+}
+
+TEST(UtilIntrusive, CopyAndMove) {
+    auto first = util::make_intrusive<helper::node>(1);
+    auto second = first;
+    assert(first.use_count() == 2);
+
+    second = second;  // NOLINT(clang-diagnostic-self-assign-overloaded)
+    assert(first.use_count() == 2);
+
+    auto moved = std::move(second);
+    assert(!second);  // NOLINT(bugprone-use-after-move)
+    assert(moved.use_count() == 2);
+
+    moved = util::make_intrusive<helper::node>(2);
+    assert(first.use_count() == 1);
+    assert(moved->value == 2);
+
+    // copying an object creates a new object without owners
+    const helper::node copy(*first);
+    assert(copy.use_count() == 0);
+}
+
+TEST(UtilIntrusive, Dtor) {
+    bool deleted = false;
+    {
+        const util::intrusive<helper::dtor_flag> object(new helper::dtor_flag(&deleted));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([object] {
+                for (int i = 0; i < 10000; ++i) {
+                    const auto copy = object;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(object.use_count() == 1);
+        assert(!deleted);
+    }
+    assert(deleted);
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/learned_sorted.hpp"
+
+namespace helper {
+
+template <class T>
+void expect_lower_bounds(const std::vector<T>& values, const std::vector<T>& queries,
+                         std::size_t epsilon = util::learned_sorted<T>::default_epsilon) {
+    const util::learned_sorted<T> learned(values.begin(), values.end(), epsilon);
+    const auto* const first = values.data();
+    const auto* const last = first + values.size();
+    for (const auto query : queries) {
+        const auto expected = std::lower_bound(first, last, query) - first;
+        ASSERT_EQ(learned.lower_bound(query) - learned.begin(), expected) << query;
+        ASSERT_EQ(util::interpolation_lower_bound(first, last, query) - first, expected) << query;
+    }
+}
+
+}  // namespace helper
+
+TEST(UtilLearnedSorted, CtorDefault) {
+    const util::learned_sorted<int> empty;
+    assert(empty.empty());
+    assert(empty.size() == 0);
+    assert(empty.segment_count() == 0);
+    assert(empty.lower_bound(1) == empty.end());
+    assert(!empty.contains(1));
+}
+
+TEST(UtilLearnedSorted, Learn) {
+    //! [learned_sorted]
+    const util::sorted_vector<std::uint32_t> timestamps = {1000, 1010, 1020, 1030, 1040, 1050};
+    const auto learned = util::learn(timestamps);
+    assert(learned.segment_count() == 1);
+    assert(*learned.lower_bound(1015) == 1020);
+    assert(learned.rank(1041) == 5);
+    assert(learned.contains(1030));
+    assert(learned.find(1031) == learned.end());
+    //! [learned_sorted]
+}
+
+TEST(UtilLearnedSorted, InterpolationLowerBound) {
+    //! [interpolation_lower_bound]
+    std::vector<int> ids(1000);
+    for (int i = 0; i < 1000; ++i) {
+        ids[i] = i * 3;
+    }
+    const auto* const found = util::interpolation_lower_bound(ids.data(), ids.data() + 1000, 1500);
+    assert(*found == 1500);
+    //! [interpolation_lower_bound]
+}
+
+TEST(UtilLearnedSorted, Uniform) {
+    std::mt19937 gen(42);  // NOLINT
+    std::vector<std::uint32_t> values(100000);
+    std::generate(values.begin(), values.end(), gen);
+    std::sort(values.begin(), values.end());
+
+    std::vector<std::uint32_t> queries(values.begin(), values.begin() + 1000);
+    for (int i = 0; i < 10000; ++i) {
+        queries.push_back(gen());
+    }
+    queries.push_back(0);
+    queries.push_back(std::numeric_limits<std::uint32_t>::max());
+    helper::expect_lower_bounds(values, queries);
+
+    // uniform keys need far fewer segments than elements
+    const util::learned_sorted<std::uint32_t> learned(values.begin(), values.end());
+    assert(learned.segment_count() < values.size() / 100);
+}
+
+TEST(UtilLearnedSorted, Skewed) {
+    std::mt19937 gen(7);  // NOLINT
+    std::lognormal_distribution<double> lognormal(0.0, 2.0);
+    std::vector<std::uint64_t> values(50000);
+    std::generate(values.begin(), values.end(),
+                  [&] { return static_cast<std::uint64_t>(lognormal(gen) * 1e6); });
+    std::sort(values.begin(), values.end());
+
+    std::vector<std::uint64_t> queries(values.begin(), values.end());
+    for (int i = 0; i < 10000; ++i) {
+        queries.push_back(static_cast<std::uint64_t>(lognormal(gen) * 1e6));
+    }
+    helper::expect_lower_bounds(values, queries);
+    helper::expect_lower_bounds(values, queries, 1);
+    helper::expect_lower_bounds(values, queries, 256);
+}
+
+TEST(UtilLearnedSorted, Duplicates) {
+    // long runs of equal keys do not fit a line and have to be found by the fallback search
+    std::vector<int> values;
+    for (int i = -50; i < 50; ++i) {
+        values.insert(values.end(), i == 0 ? 5000 : i * i % 7 + 1, i * 10);
+    }
+    std::vector<int> queries;
+    for (int i = -600; i <= 600; ++i) {
+        queries.push_back(i);
+    }
+    helper::expect_lower_bounds(values, queries);
+    helper::expect_lower_bounds(values, queries, 0);
+}
+
+TEST(UtilLearnedSorted, ExtremeValues) {
+    using limits = std::numeric_limits<std::int64_t>;
+    const std::vector<std::int64_t> values = {limits::min(), limits::min() + 1, -1, 0, 1,
+                                              limits::max() - 1, limits::max()};
+    helper::expect_lower_bounds(values, values);
+    helper::expect_lower_bounds(values, {limits::min() + 2, -2, 2, limits::max() - 2});
+
+    std::vector<double> doubles;
+    for (int i = 0; i < 1000; ++i) {
+        doubles.push_back(std::pow(1.02, i) - 100);
+    }
+    std::vector<double> double_queries(doubles);
+    double_queries.push_back(-std::numeric_limits<double>::infinity());
+    double_queries.push_back(std::numeric_limits<double>::infinity());
+    double_queries.push_back(0.5);
+    helper::expect_lower_bounds(doubles, double_queries);
+}
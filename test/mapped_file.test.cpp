@@ -0,0 +1,87 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/mapped_file.hpp"
+
+namespace helper {
+
+auto temp_path(const std::string& name) -> std::string {
+    return testing::TempDir() + "util_mapped_file_" + name;
+}
+
+auto read_file(const std::string& path) -> std::string {
+    std::ifstream file(path);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+}  // namespace helper
+
+TEST(UtilMappedFile, ReadOnly) {
+    const auto path = helper::temp_path("read_only");
+    std::ofstream(path) << "one\ntwo\nthree\n";
+
+    //! [mapped_file]
+    util::mapped_file::options options;
+    options.hint = util::mapped_file::advice::sequential;
+    options.populate = true;
+    const util::mapped_file log(path, options);
+    assert(!log.writable());
+    assert(std::count(log.data(), log.data() + log.size(), '\n') == 3);
+    //! [mapped_file]
+
+    log.advise(util::mapped_file::advice::random);
+    log.advise(util::mapped_file::advice::willneed, 5, 3);
+    EXPECT_THROW(util::mapped_file(helper::temp_path("missing")), std::system_error);
+    ::unlink(path.c_str());
+}
+
+TEST(UtilMappedFile, ReadWrite) {
+    const auto path = helper::temp_path("read_write");
+
+    //! [mapped_file_create]
+    {
+        auto journal = util::mapped_file::create(path, 4096);
+        assert(journal.writable());
+        std::memcpy(journal.data(), "entry", 5);
+        journal.sync();
+    }
+    //! [mapped_file_create]
+    assert(helper::read_file(path).compare(0, 6, std::string("entry\0", 6)) == 0);
+
+    util::mapped_file::options options;
+    options.mode = util::mapped_file::access::read_write;
+    options.huge_pages = true;
+    util::mapped_file again(path, options);
+    again.data()[0] = 'E';
+    again.reset();
+    assert(again.empty());
+    assert(helper::read_file(path)[0] == 'E');
+    ::unlink(path.c_str());
+}
+
+TEST(UtilMappedFile, EmptyAndMoved) {
+    const auto path = helper::temp_path("empty");
+    std::ofstream{path};
+
+    const util::mapped_file empty(path);
+    assert(empty.empty());
+    assert(empty.data() == nullptr);
+
+    std::ofstream(path) << "content";
+    util::mapped_file first(path);
+    util::mapped_file second(std::move(first));
+    assert(first.empty());
+    assert(second.size() == 7);
+    first = std::move(second);
+    assert(std::string(first.data(), first.size()) == "content");
+    ::unlink(path.c_str());
+}
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/mapped_sorted.hpp"
+
+namespace helper {
+
+struct record {
+    std::uint64_t key;
+    double value;
+};
+
+struct record_less {
+    auto operator()(const record& lhs, const record& rhs) const -> bool {
+        return lhs.key < rhs.key;
+    }
+};
+
+// has padding bytes behind flag, which copies of a record need not preserve
+struct padded_record {
+    std::uint32_t key;
+    std::uint8_t flag;
+};
+
+struct padded_less {
+    auto operator()(const padded_record& lhs, const padded_record& rhs) const -> bool {
+        return lhs.key < rhs.key;
+    }
+};
+
+auto temp_path(const std::string& name) -> std::string {
+    return testing::TempDir() + "util_mapped_sorted_" + name;
+}
+
+}  // namespace helper
+
+TEST(UtilMappedSorted, MappedSorted) {
+    const auto path = helper::temp_path("numbers");
+
+    //! [mapped_sorted]
+    const util::sorted_vector<std::uint32_t> numbers = {30, 10, 20};
+    util::save_mapped(numbers, path);
+
+    const util::mapped_sorted<std::uint32_t> mapped(path);
+    assert(mapped.size() == 3);
+    assert(mapped[0] == 10);
+    assert(mapped.contains(20));
+    assert(mapped.rank(25) == 2);
+    //! [mapped_sorted]
+
+    assert(mapped.verify());
+    assert(!mapped.contains(15));
+    assert(*mapped.lower_bound(15) == 20);
+    assert(*mapped.upper_bound(20) == 30);
+    assert(mapped.find(40) == mapped.end());
+    EXPECT_THROW(mapped.at(3), std::out_of_range);
+}
+
+TEST(UtilMappedSorted, Records) {
+    const auto path = helper::temp_path("records");
+
+    util::sorted<std::vector<helper::record>, helper::record_less> records;
+    for (std::uint64_t key = 0; key < 10'000; ++key) {
+        records.insert(helper::record{(key * 7919) % 10'000, static_cast<double>(key)});
+    }
+    util::save_mapped(records, path);
+
+    const util::mapped_sorted<helper::record, helper::record_less> mapped(path);
+    assert(mapped.size() == 10'000);
+    assert(mapped.verify());
+    for (std::uint64_t key = 0; key < 10'000; key += 97) {
+        const auto* const found = mapped.find(helper::record{key, 0});
+        ASSERT_NE(found, mapped.end());
+        ASSERT_EQ(found->key, key);
+    }
+}
+
+TEST(UtilMappedSorted, SkipListBackend) {
+    const auto path = helper::temp_path("list");
+
+    util::sorted_list<std::uint64_t> numbers;
+    for (std::uint64_t i = 10'000; i-- > 0;) {
+        numbers.insert(i);
+    }
+    util::save_mapped(numbers, path);
+
+    const util::mapped_sorted<std::uint64_t> mapped(path);
+    assert(mapped.size() == 10'000);
+    assert(std::equal(mapped.begin(), mapped.end(), numbers.begin(), numbers.end()));
+    assert(mapped.verify());
+
+    // the checksum is computed over the copies written, including their padding
+    const auto padded_path = helper::temp_path("padded");
+    util::sorted<util::skip_list<helper::padded_record, helper::padded_less>, helper::padded_less>
+        records;
+    for (std::uint32_t key = 0; key < 5000; ++key) {
+        records.insert(helper::padded_record{(key * 7919) % 5000, 1});
+    }
+    util::save_mapped(records, padded_path);
+
+    const util::mapped_sorted<helper::padded_record, helper::padded_less> padded(padded_path);
+    assert(padded.size() == 5000);
+    assert(padded.verify());
+    assert(padded.find(helper::padded_record{4321, 0})->flag == 1);
+}
+
+TEST(UtilMappedSorted, Empty) {
+    const auto path = helper::temp_path("empty");
+    util::save_mapped(util::sorted_vector<int>(), path);
+
+    const util::mapped_sorted<int> mapped(path);
+    assert(mapped.empty());
+    assert(mapped.begin() == mapped.end());
+    assert(!mapped.contains(1));
+    assert(mapped.verify());
+}
+
+TEST(UtilMappedSorted, Move) {
+    const auto path = helper::temp_path("move");
+    util::save_mapped(util::sorted_vector<int>{1, 2}, path);
+
+    util::mapped_sorted<int> mapped(path);
+    util::mapped_sorted<int> moved(std::move(mapped));
+    assert(moved.size() == 2);
+    assert(mapped.empty());  // NOLINT
+
+    util::save_mapped(util::sorted_vector<int>{3}, path);
+    mapped = util::mapped_sorted<int>(path);
+    assert(mapped.size() == 1);
+    assert(moved.size() == 2);  // the replaced file stays mapped
+}
+
+TEST(UtilMappedSorted, ConcurrentSaves) {
+    const auto path = helper::temp_path("concurrent");
+
+    // every writer renames its own complete file over the path, so the last one wins entirely
+    std::vector<std::thread> writers;
+    for (std::uint32_t writer = 0; writer < 4; ++writer) {
+        writers.emplace_back([&path, writer] {
+            for (std::uint32_t round = 0; round < 20; ++round) {
+                util::sorted_vector<std::uint32_t> numbers(
+                    util::presorted, std::vector<std::uint32_t>(1000 + writer, writer));
+                util::save_mapped(numbers, path);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    const util::mapped_sorted<std::uint32_t> mapped(path);
+    assert(mapped.verify());
+    assert(mapped.size() == 1000 + mapped[0]);
+
+    // no temporary file is left next to the path
+    const auto name = std::filesystem::path(path).filename().string();
+    for (const auto& entry :
+         std::filesystem::directory_iterator(std::filesystem::path(path).parent_path())) {
+        const auto other = entry.path().filename().string();
+        assert(other == name || other.rfind(name + ".", 0) != 0);
+    }
+}
+
+TEST(UtilMappedSorted, Corrupted) {
+    const auto path = helper::temp_path("corrupted");
+    util::save_mapped(util::sorted_vector<std::uint32_t>{1, 2, 3}, path);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(64);
+        file.put('\x7f');
+    }
+
+    const util::mapped_sorted<std::uint32_t> mapped(path);
+    assert(!mapped.verify());
+}
+
+TEST(UtilMappedSorted, InvalidFiles) {
+    const auto path = helper::temp_path("invalid");
+    util::save_mapped(util::sorted_vector<std::uint32_t>{1, 2, 3}, path);
+
+    EXPECT_THROW(util::mapped_sorted<std::uint64_t>{path}, util::exception);
+    EXPECT_THROW(util::mapped_sorted<int>{helper::temp_path("missing")}, std::system_error);
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.put('\0');
+    }
+    EXPECT_THROW(util::mapped_sorted<std::uint32_t>{path}, util::exception);
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "not a sorted file at all, but long enough to hold a header of 64 bytes....";
+    }
+    EXPECT_THROW(util::mapped_sorted<std::uint32_t>{path}, util::exception);
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/merge.hpp"
+
+namespace helper {
+
+using entry = std::pair<int, int>;  // a key and the index of its run
+
+struct key_less {
+    auto operator()(const entry& lhs, const entry& rhs) const -> bool {
+        return lhs.first < rhs.first;
+    }
+};
+
+}  // namespace helper
+
+TEST(UtilMerge, LoserTree) {
+    //! [loser_tree]
+    const std::vector<int> odd = {1, 3, 5};
+    const std::vector<int> even = {2, 4};
+    util::loser_tree<std::vector<int>::const_iterator> tree(
+        {{odd.begin(), odd.end()}, {even.begin(), even.end()}});
+
+    std::vector<int> merged;
+    for (; !tree.empty(); tree.pop()) {
+        merged.push_back(tree.top());
+    }
+    assert(merged == std::vector<int>({1, 2, 3, 4, 5}));
+    //! [loser_tree]
+}
+
+TEST(UtilMerge, LoserTreeTopRun) {
+    const std::vector<int> first = {2};
+    const std::vector<int> second = {1};
+    util::loser_tree<std::vector<int>::const_iterator> tree(
+        {{first.begin(), first.end()}, {second.begin(), second.end()}});
+    assert(tree.top_run() == 1);
+    tree.pop();
+    assert(tree.top_run() == 0);
+}
+
+TEST(UtilMerge, LoserTreeEmpty) {
+    const util::loser_tree<std::vector<int>::const_iterator> none({});
+    assert(none.empty());
+
+    const std::vector<int> empty;
+    const util::loser_tree<std::vector<int>::const_iterator> empty_runs(
+        {{empty.begin(), empty.end()}, {empty.begin(), empty.end()}});
+    assert(empty_runs.empty());
+}
+
+TEST(UtilMerge, Merge) {
+    //! [merge]
+    const std::vector<util::sorted_vector<int>> runs = {{5, 1, 3}, {2, 3}, {4}};
+    const auto merged = util::merge(runs);
+    assert(merged.size() == 6);
+    assert(merged[2] == 3);
+    assert(merged[3] == 3);
+
+    const auto unique = util::merge(runs, util::duplicates::remove);
+    assert(unique.size() == 5);
+    //! [merge]
+}
+
+TEST(UtilMerge, MergeMatchesSort) {
+    std::mt19937 gen(3);  // NOLINT
+    for (std::size_t run_count : {1, 2, 3, 5, 8, 13, 40}) {
+        std::vector<util::sorted_vector<int>> runs;
+        std::vector<int> all;
+        for (std::size_t i = 0; i < run_count; ++i) {
+            std::vector<int> run(gen() % 200);
+            std::generate(run.begin(), run.end(), [&] { return static_cast<int>(gen() % 500); });
+            all.insert(all.end(), run.begin(), run.end());
+            std::sort(run.begin(), run.end());
+            runs.emplace_back(util::presorted, run.begin(), run.end());
+        }
+        std::sort(all.begin(), all.end());
+
+        const auto merged = util::merge(runs);
+        EXPECT_TRUE(std::equal(merged.begin(), merged.end(), all.begin(), all.end()));
+
+        all.erase(std::unique(all.begin(), all.end()), all.end());
+        const auto unique = util::merge(runs, util::duplicates::remove);
+        EXPECT_TRUE(std::equal(unique.begin(), unique.end(), all.begin(), all.end()));
+    }
+}
+
+TEST(UtilMerge, MergeIsStable) {
+    std::mt19937 gen(5);  // NOLINT
+    std::vector<util::sorted<std::vector<helper::entry>, helper::key_less>> runs(11);
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        std::vector<helper::entry> run;
+        for (int j = 0; j < 100; ++j) {
+            run.emplace_back(static_cast<int>(gen() % 20), static_cast<int>(i) * 1000 + j);
+        }
+        std::stable_sort(run.begin(), run.end(), helper::key_less());
+        runs[i] = decltype(runs)::value_type(util::presorted, run.begin(), run.end());
+    }
+
+    const auto merged = util::merge(runs);
+    assert(merged.size() == 1100);
+    for (std::size_t i = 1; i < merged.size(); ++i) {
+        const auto& before = merged[i - 1];
+        const auto& after = merged[i];
+        ASSERT_TRUE(before.first < after.first ||
+                    (before.first == after.first && before.second < after.second));
+    }
+
+    const auto unique = util::merge(runs, util::duplicates::remove);
+    assert(unique.size() == 20);
+    for (const auto& first : unique) {
+        const auto expected = std::find_if(merged.begin(), merged.end(), [&](const auto& e) {
+            return e.first == first.first;
+        });
+        assert(first == *expected);
+    }
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/parallel_sort.hpp"
+
+namespace helper {
+
+using entry = std::pair<int, int>;  // a key and its position in the input
+
+struct key_less {
+    auto operator()(const entry& lhs, const entry& rhs) const -> bool {
+        return lhs.first < rhs.first;
+    }
+};
+
+struct no_default {
+    explicit no_default(int value) : value(value) {}
+    int value;
+
+    auto operator<(const no_default& other) const -> bool {
+        return value < other.value;
+    }
+};
+
+auto random_numbers(std::size_t count, unsigned modulo) -> std::vector<int> {
+    std::mt19937 gen(7);  // NOLINT
+    std::vector<int> numbers(count);
+    std::generate(numbers.begin(), numbers.end(), [&] { return static_cast<int>(gen() % modulo); });
+    return numbers;
+}
+
+}  // namespace helper
+
+TEST(UtilParallelSort, ParallelSort) {
+    //! [parallel_sort]
+    std::vector<int> numbers = helper::random_numbers(1'000'000, 1'000'000);
+    util::parallel_sort(util::parallel, numbers.begin(), numbers.end());
+    assert(std::is_sorted(numbers.begin(), numbers.end()));
+
+    util::thread_pool pool(4);
+    util::parallel_sort(util::parallel_t(pool), numbers.begin(), numbers.end(), std::greater<>());
+    assert(std::is_sorted(numbers.begin(), numbers.end(), std::greater<>()));
+    //! [parallel_sort]
+}
+
+TEST(UtilParallelSort, ThreadCounts) {
+    const auto input = helper::random_numbers(300'000, 1000);
+    auto expected = input;
+    std::sort(expected.begin(), expected.end());
+
+    for (std::size_t threads = 1; threads <= 9; ++threads) {
+        auto numbers = input;
+        util::parallel_sort(util::parallel_t(threads), numbers.begin(), numbers.end());
+        ASSERT_EQ(numbers, expected) << threads << " threads";
+    }
+}
+
+TEST(UtilParallelSort, SmallRanges) {
+    for (std::size_t size : {0, 1, 2, 100, 40'000}) {
+        auto numbers = helper::random_numbers(size, 100);
+        util::parallel_sort(util::parallel_t(8), numbers.begin(), numbers.end());
+        assert(std::is_sorted(numbers.begin(), numbers.end()));
+    }
+}
+
+TEST(UtilParallelSort, Stable) {
+    const auto keys = helper::random_numbers(200'000, 50);
+    std::vector<helper::entry> entries;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        entries.emplace_back(keys[i], static_cast<int>(i));
+    }
+    auto expected = entries;
+    std::stable_sort(expected.begin(), expected.end(), helper::key_less());
+
+    util::parallel_sort(util::parallel_t(5), entries.begin(), entries.end(), helper::key_less());
+    assert(entries == expected);
+}
+
+TEST(UtilParallelSort, NotDefaultConstructible) {
+    std::vector<helper::no_default> values;
+    for (const auto number : helper::random_numbers(100'000, 100'000)) {
+        values.emplace_back(number);
+    }
+    util::parallel_sort(util::parallel_t(4), values.begin(), values.end());
+    assert(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(UtilParallelSort, Exception) {
+    auto numbers = helper::random_numbers(100'000, 100'000);
+    const auto throwing = [](int lhs, int rhs) {
+        if (lhs == rhs) {
+            throw std::runtime_error("equal");
+        }
+        return lhs < rhs;
+    };
+    numbers.push_back(numbers.front());
+    EXPECT_THROW(
+        util::parallel_sort(util::parallel_t(4), numbers.begin(), numbers.end(), throwing),
+        std::runtime_error);
+}
+
+TEST(UtilParallelSort, MakeSorted) {
+    //! [make_sorted]
+    std::vector<int> unsorted(100'000);
+    std::generate(unsorted.begin(), unsorted.end(),
+                  [n = 0]() mutable { return n++ * 7919 % 100'000; });
+    const auto numbers = util::make_sorted<util::sorted_vector<int>>(util::parallel, unsorted);
+    assert(numbers.size() == 100'000);
+    assert(numbers.at(4242) == 4242);
+
+    const auto two_threads = util::make_sorted<util::sorted_vector<int>>(
+        util::parallel_t(2), unsorted.begin(), unsorted.end());
+    assert(two_threads.back() == 99'999);
+    //! [make_sorted]
+
+    const auto list = util::make_sorted<util::sorted_list<int>>(util::parallel_t(3), unsorted);
+    assert(std::equal(list.begin(), list.end(), numbers.begin(), numbers.end()));
+
+    const auto descending =
+        util::make_sorted<util::sorted<std::vector<int>, std::greater<>>>(util::parallel, unsorted);
+    assert(descending.front() == 99'999);
+}
@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/pool_allocator.hpp"
+
+namespace helper {
+
+struct message {
+    std::uint64_t id;
+    std::string text;
+
+    message(std::uint64_t id, std::string text) : id(id), text(std::move(text)) {}
+};
+
+struct alignas(64) aligned_message {
+    int id = 0;
+};
+
+}  // namespace helper
+
+TEST(UtilPoolAllocator, MakePooledShared) {
+    //! [pool_allocator_make_pooled_shared]
+    auto message = util::make_pooled_shared<helper::message>(1, "hello");
+    assert(message->text == "hello");
+    assert(message.use_count() == 1);
+    //! [pool_allocator_make_pooled_shared]
+
+    util::weak<helper::message> observer(message);
+    message = nullptr;
+    assert(observer.expired());
+}
+
+TEST(UtilPoolAllocator, ReusesBlocks) {
+    util::pool_allocator<helper::message> allocator;
+    auto* first = allocator.allocate(1);
+    allocator.deallocate(first, 1);
+    auto* second = allocator.allocate(1);
+    assert(first == second);
+    allocator.deallocate(second, 1);
+
+    // a block freed by another thread goes back to the pool of the thread which allocated it
+    auto* block = allocator.allocate(1);
+    std::thread([&] {
+        allocator.deallocate(block, 1);
+        auto* other = allocator.allocate(1);
+        ASSERT_NE(other, block);
+        allocator.deallocate(other, 1);
+    }).join();
+
+    std::vector<helper::message*> drained;
+    while (drained.size() < 100000 && (drained.empty() || drained.back() != block)) {
+        drained.push_back(allocator.allocate(1));
+    }
+    assert(drained.back() == block);
+    for (auto* ptr : drained) {
+        allocator.deallocate(ptr, 1);
+    }
+}
+
+TEST(UtilPoolAllocator, Alignment) {
+    util::pool_allocator<helper::aligned_message> allocator;
+    std::vector<helper::aligned_message*> messages;
+    for (int i = 0; i < 100; ++i) {
+        messages.push_back(allocator.allocate(1));
+        assert(reinterpret_cast<std::uintptr_t>(messages.back()) % 64 == 0);
+    }
+    for (auto* message : messages) {
+        allocator.deallocate(message, 1);
+    }
+
+    // arrays are not pooled
+    std::vector<int, util::pool_allocator<int>> numbers(1000, 7);
+    assert(numbers[999] == 7);
+}
+
+TEST(UtilPoolAllocator, CrossThread) {
+    // producers create messages which consumers release, i.e. all blocks travel between threads
+    using pooled = util::shared<helper::message, util::atomic_count>;
+    std::mutex mutex;
+    std::vector<pooled> queue;
+    std::atomic<int> producing{2};
+    std::atomic<std::uint64_t> consumed{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 2; ++p) {
+        threads.emplace_back([&, p] {
+            for (std::uint64_t i = 0; i < 20000; ++i) {
+                auto message =
+                    util::make_pooled_shared<helper::message, util::atomic_count>(i, "message");
+                const std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(std::move(message));
+            }
+            --producing;
+        });
+    }
+    for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&] {
+            while (true) {
+                std::vector<pooled> batch;
+                {
+                    const std::lock_guard<std::mutex> lock(mutex);
+                    batch.swap(queue);
+                }
+                for (const auto& message : batch) {
+                    ASSERT_EQ(message->text, "message");
+                }
+                consumed += batch.size();
+                if (batch.empty() && producing == 0) {
+                    const std::lock_guard<std::mutex> lock(mutex);
+                    if (queue.empty()) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(consumed == 40000);
+}
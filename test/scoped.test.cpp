@@ -1,3 +1,7 @@
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+
 #include "gtest/gtest.h"
 #include "test.hpp"
 #include "util/scoped.hpp"
@@ -35,3 +39,58 @@ TEST(UtilScoped, Deref) {
     const util::scoped six(new double(6.0));
     assert(*six == 6.0);
 }
+
+TEST(UtilScoped, Move) {
+    bool destroyed = false;
+    util::scoped first(new helper::dtor_notifier(destroyed));
+    util::scoped second(std::move(first));
+    assert(!first);
+    assert(second);
+
+    util::scoped<helper::dtor_notifier> third;
+    third = std::move(second);
+    assert(!destroyed);
+    third.reset();
+    assert(destroyed);
+}
+
+TEST(UtilScoped, Deleter) {
+    //! [scoped_deleter]
+    struct pool_delete {
+        void operator()(int* ptr) const { delete ptr; }  // e.g. return the block to its pool
+    };
+    const util::scoped<int, pool_delete> pooled(new int(42));
+    static_assert(sizeof(pooled) == sizeof(int*), "empty deleters take no space");
+    //! [scoped_deleter]
+
+    int released = 0;
+    {
+        const auto release = [&released](int* ptr) {
+            ++released;
+            delete ptr;
+        };
+        util::scoped number(new int(7), release);
+        assert(*number == 7);
+        number.reset(new int(8));
+        assert(released == 1);
+    }
+    assert(released == 2);
+
+    { const util::scoped<std::FILE, int (*)(std::FILE*)> file(nullptr, &std::fclose); }
+
+    // a function pointer deleter would be null, so it has to be passed explicitly
+    using function_scoped = util::scoped<int, void (*)(int*)>;
+    static_assert(!std::is_default_constructible<function_scoped>::value, "no null deleter");
+    static_assert(!std::is_constructible<function_scoped, int*>::value, "no null deleter");
+    static_assert(std::is_constructible<function_scoped, int*, void (*)(int*)>::value,
+                  "with a deleter");
+}
+
+TEST(UtilScoped, Array) {
+    //! [scoped_array]
+    util::scoped<int[]> numbers(new int[3]{1, 2, 3});
+    numbers[1] = 5;
+    assert(numbers[0] + numbers[1] + numbers[2] == 9);
+    //! [scoped_array]
+    static_assert(sizeof(numbers) == sizeof(int*), "the default deleter takes no space");
+}
@@ -0,0 +1,64 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/scoped_fd.hpp"
+
+namespace helper {
+
+auto temp_path(const std::string& name) -> std::string {
+    return testing::TempDir() + "util_scoped_fd_" + name;
+}
+
+auto is_open(int fd) -> bool {
+    return ::fcntl(fd, F_GETFD) != -1;
+}
+
+}  // namespace helper
+
+TEST(UtilScopedFd, Open) {
+    const auto path = helper::temp_path("open");
+    std::ofstream(path) << "hello";
+
+    //! [scoped_fd]
+    int fd = -1;
+    {
+        const auto file = util::scoped_fd::open(path, O_RDONLY);
+        fd = file.get();
+        assert(file.size() == 5);
+    }
+    assert(!helper::is_open(fd));  // closed when leaving the scope
+    //! [scoped_fd]
+
+    EXPECT_THROW(util::scoped_fd::open(helper::temp_path("missing"), O_RDONLY), std::system_error);
+    ::unlink(path.c_str());
+}
+
+TEST(UtilScopedFd, Ownership) {
+    const util::scoped_fd empty;
+    assert(!empty);
+    assert(!util::scoped_fd(-5));
+
+    util::scoped_fd first(::open("/dev/null", O_RDONLY));
+    const auto fd = first.get();
+    util::scoped_fd second(std::move(first));
+    assert(!first);
+    assert(second.get() == fd);
+
+    util::scoped_fd third;
+    third.swap(second);
+    assert(third.get() == fd);
+
+    const auto released = third.release();
+    assert(!third);
+    assert(helper::is_open(released));
+    third.reset(released);
+    third = util::scoped_fd();
+    assert(!helper::is_open(released));
+}
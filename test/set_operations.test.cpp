@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/set_operations.hpp"
+
+namespace helper {
+
+auto random_ids(std::size_t count, std::uint32_t max, bool unique) -> std::vector<std::uint32_t> {
+    std::mt19937 gen(static_cast<std::uint32_t>(count * 31 + max));  // NOLINT
+    std::uniform_int_distribution<std::uint32_t> dist(0, max);
+    std::vector<std::uint32_t> ids(count);
+    std::generate(ids.begin(), ids.end(), [&] { return dist(gen); });
+    std::sort(ids.begin(), ids.end());
+    if (unique) {
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+    return ids;
+}
+
+template <class Sorted>
+auto to_vector(const Sorted& elements) -> std::vector<std::uint32_t> {
+    return std::vector<std::uint32_t>(elements.begin(), elements.end());
+}
+
+// all combinations of skewed and balanced sizes with and without duplicates
+template <class Check>
+void for_all_inputs(Check check) {
+    for (const bool unique : {true, false}) {
+        for (const std::size_t lhs_count : {0, 1, 5, 100, 3000}) {
+            for (const std::size_t rhs_count : {0, 1, 7, 100, 3000}) {
+                const auto lhs = random_ids(lhs_count, 4000, unique);
+                const auto rhs = random_ids(rhs_count, 4000, unique);
+                check(lhs, rhs);
+            }
+        }
+    }
+}
+
+}  // namespace helper
+
+TEST(UtilSetOperations, Intersection) {
+    //! [set_intersection]
+    const util::sorted_vector<std::uint32_t> lhs = {1, 3, 5, 7};
+    const util::sorted_vector<std::uint32_t> rhs = {3, 4, 5};
+    const auto common = util::set_intersection(lhs, rhs);
+    assert(common.size() == 2);
+    assert(common[0] == 3);
+    assert(common[1] == 5);
+    //! [set_intersection]
+}
+
+TEST(UtilSetOperations, IntersectionMatchesStd) {
+    helper::for_all_inputs([](const auto& lhs, const auto& rhs) {
+        std::vector<std::uint32_t> expected;
+        std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                              std::back_inserter(expected));
+
+        const util::sorted_vector<std::uint32_t> sorted_lhs(util::presorted, lhs.begin(),
+                                                            lhs.end());
+        const util::sorted_vector<std::uint32_t> sorted_rhs(util::presorted, rhs.begin(),
+                                                            rhs.end());
+        EXPECT_EQ(helper::to_vector(util::set_intersection(sorted_lhs, sorted_rhs)), expected);
+
+        const util::sorted_list<std::uint32_t> list_lhs(util::presorted, lhs.begin(), lhs.end());
+        EXPECT_EQ(helper::to_vector(util::set_intersection(list_lhs, sorted_rhs)), expected);
+    });
+}
+
+TEST(UtilSetOperations, Union) {
+    //! [set_union]
+    const util::sorted_vector<int> lhs = {1, 3, 5};
+    const util::sorted_vector<int> rhs = {2, 3, 4};
+    const auto all = util::set_union(lhs, rhs);
+    assert(all.size() == 5);
+    assert(all[1] == 2);
+    assert(all[4] == 5);
+    //! [set_union]
+}
+
+TEST(UtilSetOperations, UnionMatchesStd) {
+    helper::for_all_inputs([](const auto& lhs, const auto& rhs) {
+        std::vector<std::uint32_t> expected;
+        std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                       std::back_inserter(expected));
+
+        const util::sorted_vector<std::uint32_t> sorted_lhs(util::presorted, lhs.begin(),
+                                                            lhs.end());
+        const util::sorted_vector<std::uint32_t> sorted_rhs(util::presorted, rhs.begin(),
+                                                            rhs.end());
+        EXPECT_EQ(helper::to_vector(util::set_union(sorted_lhs, sorted_rhs)), expected);
+    });
+}
+
+TEST(UtilSetOperations, Difference) {
+    //! [set_difference]
+    const util::sorted_vector<int> lhs = {1, 3, 5};
+    const util::sorted_vector<int> rhs = {3, 4};
+    const auto only_lhs = util::set_difference(lhs, rhs);
+    assert(only_lhs.size() == 2);
+    assert(only_lhs[0] == 1);
+    assert(only_lhs[1] == 5);
+    //! [set_difference]
+}
+
+TEST(UtilSetOperations, DifferenceMatchesStd) {
+    helper::for_all_inputs([](const auto& lhs, const auto& rhs) {
+        std::vector<std::uint32_t> expected;
+        std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                            std::back_inserter(expected));
+
+        const util::sorted_vector<std::uint32_t> sorted_lhs(util::presorted, lhs.begin(),
+                                                            lhs.end());
+        const util::sorted_vector<std::uint32_t> sorted_rhs(util::presorted, rhs.begin(),
+                                                            rhs.end());
+        EXPECT_EQ(helper::to_vector(util::set_difference(sorted_lhs, sorted_rhs)), expected);
+    });
+}
+
+TEST(UtilSetOperations, Compare) {
+    const util::sorted<std::vector<int>, std::greater<int>> lhs = {1, 3, 5, 7};
+    const util::sorted<std::vector<int>, std::greater<int>> rhs = {7, 5, 2};
+    const auto common = util::set_intersection(lhs, rhs);
+    assert(common.size() == 2);
+    assert(common[0] == 7);
+    assert(common[1] == 5);
+}
@@ -1,9 +1,41 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "test.hpp"
 #include "util/shared.hpp"
 
+namespace helper {
+
+// atomic since the threaded tests of this binary allocate from several threads at once
+std::atomic<std::size_t> allocations{0};  // NOLINT
+
+}  // namespace helper
+
+// counts all allocations of this test binary
+auto operator new(std::size_t size) -> void* {
+    helper::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size)) {  // NOLINT
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);  // NOLINT
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+    std::free(ptr);  // NOLINT
+}
+
 TEST(UtilShared, CtorDefault) {
     //! [shared_ctor_default]
     util::shared<std::string> name;
@@ -47,4 +79,271 @@ TEST(UtilShared, MakeShared) {
     //! [shared_make_shared]
     auto name = util::make_shared<std::string>("Chris");
     //! [shared_make_shared]
-}
\ No newline at end of file
+}
+TEST(UtilShared, Assign) {
+    auto name = util::make_shared<std::string>("Chris");
+    auto other = util::make_shared<std::string>("Dora");
+    other = name;
+    assert(name.use_count() == 2);
+    assert(*other == "Chris");
+
+    auto moved = std::move(other);
+    assert(!other);  // NOLINT(bugprone-use-after-move)
+    assert(moved.use_count() == 2);
+
+    moved = util::make_shared<std::string>("Eve");
+    assert(name.use_count() == 1);
+}
+
+TEST(UtilShared, AtomicCount) {
+    //! [shared_atomic_count]
+    auto config = util::make_shared<std::string, util::atomic_count>("verbose");
+    std::thread worker([copy = config] { assert(*copy == "verbose"); });
+    worker.join();
+    assert(config.use_count() == 1);
+    //! [shared_atomic_count]
+
+    class counted {
+        int* destroyed;
+
+    public:
+        explicit counted(int* destroyed) : destroyed(destroyed) {}
+        counted(const counted&) = delete;
+        auto operator=(const counted&) -> counted& = delete;
+        ~counted() { ++*destroyed; }
+    };
+
+    int destroyed = 0;
+    {
+        const util::shared<counted, util::atomic_count> object(new counted(&destroyed));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&object] {
+                for (int i = 0; i < 10000; ++i) {
+                    const auto copy = object;
+                    const auto another = copy;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(object.use_count() == 1);
+        assert(destroyed == 0);
+    }
+    assert(destroyed == 1);
+}
+
+TEST(UtilShared, BiasedCount) {
+    //! [shared_biased_count]
+    auto config = util::make_shared<std::string, util::biased_count>("verbose");
+    const auto local_copy = config;  // counted without atomic instructions
+    std::thread worker([copy = config] { assert(*copy == "verbose"); });
+    worker.join();
+    assert(config.use_count() == 2);
+    //! [shared_biased_count]
+
+    util::weak<std::string, util::biased_count> observer(config);
+    config = nullptr;
+    assert(observer.lock());
+}
+
+TEST(UtilShared, BiasedCountHandOver) {
+    class counted {
+        std::atomic<int>* destroyed;
+
+    public:
+        explicit counted(std::atomic<int>* destroyed) : destroyed(destroyed) {}
+        counted(const counted&) = delete;
+        auto operator=(const counted&) -> counted& = delete;
+        ~counted() { ++*destroyed; }
+    };
+
+    // the last reference is released by another thread, the owner merges its queued counter
+    std::atomic<int> destroyed{0};
+    util::shared<counted, util::biased_count> handed(new counted(&destroyed));
+    std::thread([object = std::move(handed)]() mutable { object = nullptr; }).join();
+    assert(destroyed == 0);
+    util::biased_count::collect();
+    assert(destroyed == 1);
+
+    // once the owner exited, the thread releasing the last reference merges the counter
+    util::shared<counted, util::biased_count> orphan;
+    std::thread([&orphan, &destroyed] {
+        orphan = util::shared<counted, util::biased_count>(new counted(&destroyed));
+    }).join();
+    assert(orphan.use_count() == 1);
+    orphan = nullptr;
+    assert(destroyed == 2);
+
+    // copies are made and released by the owner and other threads at the same time
+    {
+        util::shared<counted, util::biased_count> object(new counted(&destroyed));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([copy = object] {
+                for (int i = 0; i < 10000; ++i) {
+                    const auto another = copy;
+                }
+            });
+        }
+        for (int i = 0; i < 10000; ++i) {
+            const auto copy = object;
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(object.use_count() == 1);
+    }
+    util::biased_count::collect();
+    assert(destroyed == 3);
+}
+
+TEST(UtilShared, Allocations) {
+    const auto before = helper::allocations.load();
+    {
+        const util::shared<int> empty;
+        const util::shared<int> null(nullptr);
+        const util::shared<int> copy(empty);
+        assert(empty.use_count() == 0);
+        assert(copy.use_count() == 0);
+    }
+    assert(helper::allocations == before);
+
+    // object and counter in one block
+    auto number = util::make_shared<int>(42);
+    assert(helper::allocations == before + 1);
+    const auto copy = number;
+    assert(helper::allocations == before + 1);
+    assert(*copy == 42);
+
+    // the object itself and a separate counter
+    const util::shared<int> separate(new int(42));
+    assert(helper::allocations == before + 3);
+}
+
+TEST(UtilShared, Weak) {
+    //! [shared_weak]
+    auto config = util::make_shared<std::string>("verbose");
+    util::weak<std::string> observer(config);
+    assert(!observer.expired());
+    assert(*observer.lock() == "verbose");
+    assert(config.use_count() == 1);
+
+    config = nullptr;
+    assert(observer.expired());
+    assert(!observer.lock());
+    //! [shared_weak]
+
+    const util::weak<std::string> empty;
+    assert(empty.expired());
+    assert(!empty.lock());
+}
+
+TEST(UtilShared, WeakDoesNotKeepAlive) {
+    class dtor_flag {  // NOLINT
+        bool* flag = nullptr;
+
+    public:
+        dtor_flag(bool* flag) : flag(flag) {}
+        ~dtor_flag() { *flag = true; }
+    };
+
+    bool deleted = false;
+    util::weak<dtor_flag> observer;
+    {
+        const auto owner = util::make_shared<dtor_flag>(&deleted);
+        observer = owner;
+        auto copy = observer;
+        assert(copy.use_count() == 1);
+    }
+    assert(deleted);
+    assert(observer.expired());
+
+    deleted = false;
+    util::shared<dtor_flag> owner(new dtor_flag(&deleted));
+    observer = owner;
+    owner = util::shared<dtor_flag>();
+    assert(deleted);
+    observer.reset();
+    assert(observer.use_count() == 0);
+}
+
+TEST(UtilShared, WeakLockConcurrently) {
+    // owners are released while other threads lock, every lock either fails or keeps the object
+    for (int round = 0; round < 100; ++round) {
+        auto owner = util::make_shared<std::string, util::atomic_count>("cached");
+        const util::weak<std::string, util::atomic_count> observer(owner);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; ++t) {
+            threads.emplace_back([observer] {
+                for (int i = 0; i < 100; ++i) {
+                    if (const auto locked = observer.lock()) {
+                        ASSERT_EQ(*locked, "cached");
+                    }
+                }
+            });
+        }
+        owner = nullptr;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(observer.expired());
+    }
+}
+
+TEST(UtilShared, Deleter) {
+    //! [shared_deleter]
+    int released = 0;
+    {
+        static int arena[4] = {};  // NOLINT
+        const util::shared<int> slot(&arena[2], [&released](int* /*ptr*/) { ++released; });
+        const auto copy = slot;
+    }
+    assert(released == 1);
+    //! [shared_deleter]
+
+    // a nullpointer is never passed to the deleter
+    { const util::shared<std::FILE> file(nullptr, &std::fclose); }
+
+    // empty deleters take no space in the control block
+    const auto empty = [](int* ptr) { delete ptr; };
+    using block = util::detail::control_block<util::local_count>;
+    static_assert(sizeof(util::detail::pointer_block<int, util::local_count, decltype(empty)>) ==
+                      sizeof(block) + sizeof(int*),
+                  "empty deleters take no space");
+    static_assert(sizeof(util::detail::pointer_block<int, util::local_count, void (*)(int*)>) ==
+                      sizeof(block) + 2 * sizeof(int*),
+                  "other deleters are stored");
+
+    const auto before = helper::allocations.load();
+    { const util::shared<int> number(new int(42), empty); }
+    assert(helper::allocations == before + 2);
+}
+
+TEST(UtilShared, Aliasing) {
+    //! [shared_aliasing]
+    auto buffer = util::make_shared<std::array<char, 4096>>();
+    util::shared<char> second_half(buffer, buffer->data() + 2048);
+    assert(buffer.use_count() == 2);
+
+    buffer = nullptr;
+    *second_half = 'x';
+    assert(second_half.use_count() == 1);
+    //! [shared_aliasing]
+
+    struct pair {
+        int first = 1;
+        int second = 2;
+    };
+    auto owner = util::make_shared<pair>();
+    const util::weak<int> observer(util::shared<int>(owner, &owner->second));
+    assert(*observer.lock() == 2);
+
+    util::shared<int> second(std::move(owner), &owner->second);
+    assert(!owner);  // NOLINT(bugprone-use-after-move)
+    assert(second.use_count() == 1);
+    second = nullptr;
+    assert(observer.expired());
+}
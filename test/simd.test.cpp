@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/simd.hpp"
+
+namespace helper {
+
+template <class T>
+auto random_sorted(std::size_t count) -> std::vector<T> {
+    std::mt19937_64 gen(count);  // NOLINT
+    std::uniform_int_distribution<std::uint64_t> dist(0, 4 * count);
+    std::vector<T> values(count);
+    std::generate(values.begin(), values.end(), [&] { return static_cast<T>(dist(gen)); });
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+template <class T, class Search>
+void expect_lower_bound(Search search) {
+    for (std::size_t count : {0, 1, 2, 3, 7, 8, 9, 63, 64, 65, 100, 1000, 4097}) {
+        const auto values = random_sorted<T>(count);
+        const auto* const first = values.data();
+        const auto* const last = first + values.size();
+
+        for (std::uint64_t key = 0; key <= 4 * count + 1; ++key) {
+            const auto value = static_cast<T>(key);
+            ASSERT_EQ(search(first, last, value), std::lower_bound(first, last, value));
+        }
+    }
+}
+
+}  // namespace helper
+
+TEST(UtilSimd, LowerBound) {
+    //! [simd_lower_bound]
+    const std::vector<std::uint32_t> ids = {2, 4, 8, 16};
+    const auto* const found = util::simd_lower_bound(ids.data(), ids.data() + ids.size(), 5U);
+    assert(*found == 8);
+    //! [simd_lower_bound]
+}
+
+TEST(UtilSimd, LowerBoundMatchesStd) {
+    const auto search = [](const auto* first, const auto* last, auto value) {
+        return util::simd_lower_bound(first, last, value);
+    };
+    helper::expect_lower_bound<std::uint32_t>(search);
+    helper::expect_lower_bound<std::uint64_t>(search);
+    helper::expect_lower_bound<float>(search);
+}
+
+TEST(UtilSimd, LowerBoundUnsignedRange) {
+    const std::vector<std::uint32_t> values = {1, 0x7fffffffU, 0x80000000U, 0xffffffffU};
+    for (const auto value : values) {
+        EXPECT_EQ(*util::simd_lower_bound(values.data(), values.data() + values.size(), value),
+                  value);
+    }
+
+    const std::vector<std::uint64_t> wide = {1, 0x7fffffffffffffffULL, 0x8000000000000000ULL};
+    const auto* const first = wide.data();
+    const auto* const last = first + wide.size();
+    EXPECT_EQ(*util::simd_lower_bound(first, last, std::uint64_t{2}), wide[1]);
+    EXPECT_EQ(*util::simd_lower_bound(first, last, std::uint64_t{wide[1] + 1}), wide[2]);
+}
+
+#ifdef UTIL_SIMD_X86
+TEST(UtilSimd, CountLessInstructionSets) {
+    const auto values = helper::random_sorted<std::uint32_t>(1000);
+    const auto wide = helper::random_sorted<std::uint64_t>(1000);
+    const auto floats = helper::random_sorted<float>(1000);
+
+    for (std::uint32_t key = 0; key < 4001; key += 7) {
+        const auto expected = util::detail::count_less_scalar(values.data(), values.size(), key);
+        const auto expected_wide =
+            util::detail::count_less_scalar(wide.data(), wide.size(), std::uint64_t{key});
+        const auto expected_floats =
+            util::detail::count_less_scalar(floats.data(), floats.size(), float(key));
+
+        if (util::simd_support() >= util::simd_level::sse42) {
+            EXPECT_EQ(util::detail::count_less_sse42(values.data(), values.size(), key), expected);
+            EXPECT_EQ(util::detail::count_less_sse42(wide.data(), wide.size(), std::uint64_t{key}),
+                      expected_wide);
+            EXPECT_EQ(util::detail::count_less_sse42(floats.data(), floats.size(), float(key)),
+                      expected_floats);
+        }
+        if (util::simd_support() >= util::simd_level::avx2) {
+            EXPECT_EQ(util::detail::count_less_avx2(values.data(), values.size(), key), expected);
+            EXPECT_EQ(util::detail::count_less_avx2(wide.data(), wide.size(), std::uint64_t{key}),
+                      expected_wide);
+            EXPECT_EQ(util::detail::count_less_avx2(floats.data(), floats.size(), float(key)),
+                      expected_floats);
+        }
+    }
+}
+#endif
+
+#ifdef UTIL_SIMD_X86
+TEST(UtilSimd, PrefixSumInstructionSets) {
+    for (const std::size_t count : {0, 1, 3, 4, 5, 128, 131}) {
+        std::vector<std::uint32_t> values(count);
+        std::vector<std::uint64_t> wide(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<std::uint32_t>(i * 3 + 1);
+            wide[i] = 0x100000000ULL * i + 7;
+        }
+        auto expected = values;
+        auto expected_wide = wide;
+        util::detail::prefix_sum_scalar(expected.data(), count);
+        util::detail::prefix_sum_scalar(expected_wide.data(), count);
+
+        if (util::simd_support() >= util::simd_level::sse42) {
+            util::detail::prefix_sum_sse42(values.data(), count);
+            util::detail::prefix_sum_sse42(wide.data(), count);
+            EXPECT_EQ(values, expected);
+            EXPECT_EQ(wide, expected_wide);
+        }
+    }
+}
+#endif
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/skip_list.hpp"
+
+namespace helper {
+
+template <class T, class Compare>
+void expect_equal(const util::skip_list<T, Compare>& list, const std::vector<T>& expected) {
+    ASSERT_EQ(list.size(), expected.size());
+    ASSERT_TRUE(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(list[i], expected[i]);
+    }
+}
+
+struct entry {
+    int key;
+    int id;
+};
+
+inline auto operator==(const entry& lhs, const entry& rhs) -> bool {
+    return lhs.key == rhs.key && lhs.id == rhs.id;
+}
+
+struct key_less {
+    auto operator()(const entry& lhs, const entry& rhs) const -> bool { return lhs.key < rhs.key; }
+};
+
+// counts the live allocations of its arena and never propagates, like a polymorphic allocator
+template <class T>
+struct arena_allocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using is_always_equal = std::false_type;
+
+    explicit arena_allocator(int& live) noexcept : live(&live) {}
+    template <class U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : live(other.live) {}
+
+    auto allocate(std::size_t n) -> T* {
+        ++*live;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        --*live;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    int* live;
+};
+
+template <class T, class U>
+auto operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) -> bool {
+    return lhs.live == rhs.live;
+}
+
+template <class T, class U>
+auto operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) -> bool {
+    return !(lhs == rhs);
+}
+
+}  // namespace helper
+
+TEST(UtilSkipList, CtorDefault) {
+    const util::skip_list<int> empty;
+    assert(empty.empty());
+    assert(empty.size() == 0);
+    assert(empty.begin() == empty.end());
+}
+
+TEST(UtilSkipList, Insert) {
+    //! [skip_list_insert]
+    util::skip_list<std::string> names;
+    names.insert("Dora");
+    names.insert("Chris");
+    auto it = names.insert("Eve");
+    assert(*it == "Eve");
+    assert(names.front() == "Chris");
+    assert(names.back() == "Eve");
+    assert(names.size() == 3);
+    //! [skip_list_insert]
+}
+
+TEST(UtilSkipList, InsertKeepsEquivalentOrder) {
+    using pair = std::pair<int, int>;
+    struct first_less {
+        auto operator()(const pair& lhs, const pair& rhs) const -> bool {
+            return lhs.first < rhs.first;
+        }
+    };
+    util::skip_list<pair, first_less> pairs;
+    pairs.insert({1, 0});
+    pairs.insert({0, 0});
+    pairs.insert({1, 1});
+    pairs.insert({1, 2});
+
+    assert(pairs[1] == pair(1, 0));
+    assert(pairs[2] == pair(1, 1));
+    assert(pairs[3] == pair(1, 2));
+}
+
+TEST(UtilSkipList, OperatorSquareBrackets) {
+    //! [skip_list_operator_square_brackets]
+    util::skip_list<int> numbers;
+    for (int i = 100; i > 0; --i) {
+        numbers.insert(i);
+    }
+    assert(numbers[0] == 1);
+    assert(numbers[41] == 42);
+    assert(numbers[99] == 100);
+    //! [skip_list_operator_square_brackets]
+
+    try {
+        numbers.at(100);
+    } catch (const std::out_of_range& x) {
+        assert(true);
+    }
+}
+
+TEST(UtilSkipList, LowerBound) {
+    //! [skip_list_lower_bound]
+    util::skip_list<int> numbers;
+    numbers.insert(30);
+    numbers.insert(10);
+    numbers.insert(20);
+    assert(*numbers.lower_bound(15) == 20);
+    assert(*numbers.upper_bound(20) == 30);
+    assert(numbers.lower_bound(31) == numbers.end());
+    assert(numbers.find(25) == numbers.end());
+    //! [skip_list_lower_bound]
+}
+
+TEST(UtilSkipList, IndexOf) {
+    //! [skip_list_index_of]
+    util::skip_list<int> numbers;
+    numbers.insert(3);
+    numbers.insert(1);
+    numbers.insert(2);
+    assert(numbers.index_of(numbers.find(3)) == 2);
+    assert(numbers.index_of(numbers.end()) == 3);
+    //! [skip_list_index_of]
+}
+
+TEST(UtilSkipList, Rank) {
+    //! [skip_list_rank]
+    util::skip_list<int> numbers;
+    for (const auto number : {5, 1, 3, 3, 9}) {
+        numbers.insert(number);
+    }
+    assert(numbers.rank(0) == 0);
+    assert(numbers.rank(3) == 1);
+    assert(numbers.rank(4) == 3);
+    assert(numbers.rank(10) == 5);
+    //! [skip_list_rank]
+
+    util::skip_list<int> many;
+    for (int i = 999; i >= 0; --i) {
+        many.insert(i * 2);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(many.rank(i * 2), static_cast<std::size_t>(i));
+        ASSERT_EQ(many.rank(i * 2 + 1), static_cast<std::size_t>(i + 1));
+        ASSERT_EQ(many.index_of(many.lower_bound(i * 2)), many.rank(i * 2));
+    }
+}
+
+TEST(UtilSkipList, Erase) {
+    //! [skip_list_erase]
+    util::skip_list<int> numbers;
+    numbers.insert(1);
+    numbers.insert(2);
+    numbers.insert(3);
+    auto next = numbers.erase(numbers.find(2));
+    assert(*next == 3);
+    assert(numbers.size() == 2);
+    assert(numbers[1] == 3);
+    //! [skip_list_erase]
+
+    numbers.erase(numbers.begin(), numbers.end());
+    assert(numbers.empty());
+}
+
+TEST(UtilSkipList, EraseWithinEquivalentRun) {
+    util::skip_list<helper::entry, helper::key_less> entries;
+    std::vector<helper::entry> expected;
+    for (int id = 0; id < 5000; ++id) {
+        const helper::entry e{id < 100 ? 0 : id < 4900 ? 1 : 2, id};
+        entries.insert(e);
+        expected.push_back(e);
+    }
+
+    // erase from the middle of the run of equal keys, the position is found by node identity
+    for (std::size_t erased = 0; erased < 200; ++erased) {
+        const auto middle = static_cast<std::ptrdiff_t>(expected.size() / 2);
+        auto it = entries.begin();
+        std::advance(it, middle);
+        ASSERT_EQ(entries.index_of(it), static_cast<std::size_t>(middle));
+        const auto next = entries.erase(it);
+        expected.erase(expected.begin() + middle);
+        ASSERT_TRUE(*next == expected[static_cast<std::size_t>(middle)]);
+    }
+    helper::expect_equal(entries, expected);
+    ASSERT_EQ(entries.index_of(entries.find(helper::entry{2, 0})), expected.size() - 100);
+}
+
+TEST(UtilSkipList, Iterate) {
+    util::skip_list<int> numbers;
+    numbers.insert(2);
+    numbers.insert(1);
+    numbers.insert(3);
+
+    std::vector<int> backwards(numbers.size());
+    std::reverse_copy(numbers.begin(), numbers.end(), backwards.begin());
+    assert(backwards == std::vector<int>({3, 2, 1}));
+}
+
+TEST(UtilSkipList, CopyAndMove) {
+    util::skip_list<std::string> names;
+    names.insert("Dora");
+    names.insert("Chris");
+
+    const auto copy = names;
+    helper::expect_equal(copy, {"Chris", "Dora"});
+
+    auto moved = std::move(names);
+    helper::expect_equal(moved, {"Chris", "Dora"});
+    assert(names.empty());  // NOLINT(bugprone-use-after-move)
+
+    names = moved;
+    names.insert("Eve");
+    helper::expect_equal(names, {"Chris", "Dora", "Eve"});
+    helper::expect_equal(moved, {"Chris", "Dora"});
+}
+
+TEST(UtilSkipList, AssignWithoutPropagatingAllocator) {
+    using list = util::skip_list<int, std::less<int>, helper::arena_allocator<int>>;
+    int first_live = 0;
+    int second_live = 0;
+    {
+        list first{std::less<int>(), helper::arena_allocator<int>(first_live)};
+        list second{std::less<int>(), helper::arena_allocator<int>(second_live)};
+        for (int i = 0; i < 100; ++i) {
+            second.insert(i);
+        }
+
+        // the nodes of the second arena cannot be freed by the first, so they are moved into new
+        first = std::move(second);
+        assert(first.size() == 100 && first[42] == 42);
+        assert(first_live == 100 && second_live == 0);
+
+        second.insert(7);
+        second = first;
+        assert(second.size() == 100 && second_live == 100);
+        assert(first_live == 100);
+
+        auto third = std::move(first);
+        assert(third.size() == 100 && first_live == 100);
+        third = std::move(first);
+        assert(third.empty());
+    }
+    assert(first_live == 0);
+    assert(second_live == 0);
+}
+
+TEST(UtilSkipList, RandomOperations) {
+    std::mt19937 gen(7);  // NOLINT
+    std::uniform_int_distribution<int> values(0, 300);
+    util::skip_list<int> list;
+    std::vector<int> expected;
+
+    for (int i = 0; i < 3000; ++i) {
+        const auto value = values(gen);
+        if (gen() % 3 == 0 && !expected.empty()) {
+            const auto erased = expected[gen() % expected.size()];
+            const auto next = list.erase(list.find(erased));
+            expected.erase(std::lower_bound(expected.begin(), expected.end(), erased));
+            assert(next == list.upper_bound(erased) || *next == erased);
+        } else {
+            list.insert(value);
+            expected.insert(std::upper_bound(expected.begin(), expected.end(), value), value);
+        }
+
+        if (i % 500 == 0) {
+            helper::expect_equal(list, expected);
+        }
+    }
+
+    helper::expect_equal(list, expected);
+}
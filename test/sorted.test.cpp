@@ -1,7 +1,15 @@
+#include <algorithm>
+#include <cstdint>
+#include <forward_list>
+#include <functional>
+#include <list>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "test.hpp"
+#include "util/btree.hpp"
 #include "util/sorted.hpp"
 
 TEST(UtilSorted, CtorDefault) {
@@ -253,4 +261,179 @@ TEST(UtilSorted, Insert) {
     assert(list.at(1) == 1);
     assert(list.at(2) == 2);
     assert(list.at(3) == 3);
-}
\ No newline at end of file
+}
+
+TEST(UtilSorted, LowerBound) {
+    //! [sorted_lower_bound]
+    const util::sorted_vector<int> numbers = {10, 20, 30};
+    assert(*numbers.lower_bound(15) == 20);
+    assert(*numbers.lower_bound(20) == 20);
+    assert(numbers.lower_bound(31) == numbers.end());
+    //! [sorted_lower_bound]
+
+    const util::sorted_list<int> list = {10, 20, 30};
+    assert(*list.lower_bound(15) == 20);
+    assert(list.lower_bound(31) == list.end());
+}
+
+TEST(UtilSorted, LowerBoundSimd) {
+    std::vector<std::uint32_t> values(5000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<std::uint32_t>((i * 7919) % 10007);  // NOLINT
+    }
+    const util::sorted_vector<std::uint32_t> ids(values);
+    const util::sorted_vector<float> floats(values);
+    std::sort(values.begin(), values.end());
+
+    for (std::uint32_t key = 0; key < 10010; ++key) {
+        const auto expected = std::lower_bound(values.begin(), values.end(), key) - values.begin();
+        ASSERT_EQ(ids.lower_bound(key) - ids.begin(), expected);
+        ASSERT_EQ(floats.lower_bound(float(key)) - floats.begin(), expected);
+    }
+}
+
+TEST(UtilSorted, UpperBound) {
+    //! [sorted_upper_bound]
+    const util::sorted_vector<int> numbers = {10, 20, 20, 30};
+    assert(*numbers.upper_bound(20) == 30);
+    assert(numbers.upper_bound(30) == numbers.end());
+    //! [sorted_upper_bound]
+}
+
+TEST(UtilSorted, Find) {
+    //! [sorted_find]
+    const util::sorted_vector<std::uint64_t> ids = {7, 3, 5};
+    assert(*ids.find(5) == 5);
+    assert(ids.find(4) == ids.end());
+    assert(ids.contains(7));
+    //! [sorted_find]
+
+    const util::sorted_forward_list<int> fwd_list = {3, 1, 2};
+    assert(*fwd_list.find(2) == 2);
+    assert(!fwd_list.contains(4));
+
+    // an ordered container has to keep the order find searches in
+    const util::sorted<util::skip_list<int, std::greater<int>>, std::greater<int>> descending = {
+        1, 3};
+    assert(descending.front() == 3);
+    assert(descending.find(2) == descending.end());
+    static_assert(!util::detail::orders_by<util::skip_list<int>, std::greater<int>>::value,
+                  "a skip list ordered by std::less does not order by std::greater");
+    static_assert(!util::detail::orders_by<util::btree<int>, std::greater<int>>::value,
+                  "a btree ordered by std::less does not order by std::greater");
+    static_assert(util::detail::orders_by<std::vector<int>, std::greater<int>>::value,
+                  "a sequence container is ordered by the sorted container");
+}
+
+TEST(UtilSorted, Erase) {
+    //! [sorted_erase]
+    util::sorted_vector<int> numbers = {3, 1, 2};
+    auto it = numbers.erase(numbers.find(2));
+    assert(*it == 3);
+    assert(numbers.size() == 2);
+    //! [sorted_erase]
+
+    util::sorted_forward_list<int> fwd_list = {3, 1, 2};
+    auto fwd_it = fwd_list.erase(fwd_list.find(2));
+    assert(*fwd_it == 3);
+    assert(fwd_list.size() == 2);
+
+    util::sorted<std::forward_list<int>> std_fwd_list = {3, 1, 2};
+    std_fwd_list.erase(std_fwd_list.find(2));
+    assert(std_fwd_list.size() == 2);
+    assert(std_fwd_list[1] == 3);
+}
+
+TEST(UtilSorted, InsertStdContainers) {
+    util::sorted<std::forward_list<int>> fwd_list;
+    const int two = 2;
+    fwd_list.insert(two);
+    fwd_list.insert(1);
+    fwd_list.insert(3);
+    assert(fwd_list[0] == 1);
+    assert(fwd_list[1] == 2);
+    assert(fwd_list[2] == 3);
+
+    util::sorted<std::list<int>> list = {3, 1};
+    list.insert(two);
+    assert(list[1] == 2);
+
+    util::sorted_vector<int> vector = {3, 1};
+    vector.insert(two);
+    assert(vector[1] == 2);
+
+    util::sorted_btree<int> btree = {3, 1};
+    btree.insert(two);
+    assert(btree[1] == 2);
+    btree.erase(btree.find(1));
+    assert(btree.front() == 2);
+}
+
+TEST(UtilSorted, CtorPresorted) {
+    //! [sorted_ctor_presorted]
+    const std::vector<int> ascending = {1, 2, 3};
+    const util::sorted_vector<int> numbers(util::presorted, ascending.begin(), ascending.end());
+    assert(numbers.at(2) == 3);
+    //! [sorted_ctor_presorted]
+
+    const util::sorted_vector<int> moved(util::presorted, std::vector<int>{4, 5});
+    assert(moved.size() == 2);
+
+    const util::sorted_list<int> list(util::presorted, ascending.begin(), ascending.end());
+    assert(list.at(1) == 2);
+
+    const util::sorted_btree<int> btree(util::presorted, ascending.begin(), ascending.end());
+    assert(btree.at(1) == 2);
+
+#ifdef UTIL_ASSERT
+    const std::vector<int> descending = {3, 2, 1};
+    try {
+        const util::sorted_vector<int> unsorted(util::presorted, descending.begin(),
+                                                descending.end());
+    } catch (const util::assertion& a) {
+        assert(true);
+    }
+#endif
+}
+
+TEST(UtilSorted, Rank) {
+    //! [sorted_rank]
+    const util::sorted_vector<int> latencies = {12, 7, 30, 7, 18, 25};
+    assert(latencies.rank(7) == 0);
+    assert(latencies.rank(18) == 3);
+    assert(latencies.select(3) == 18);
+    assert(latencies.select(latencies.size() * 90 / 100) == 30);
+    assert(latencies.count_range(7, 19) == 4);
+    //! [sorted_rank]
+
+    assert(latencies.count_range(19, 7) == 0);
+    assert(latencies.count_range(100, 200) == 0);
+    EXPECT_THROW(latencies.select(6), std::out_of_range);
+}
+
+TEST(UtilSorted, RankBackends) {
+    std::vector<int> input;
+    for (int i = 0; i < 500; ++i) {
+        input.push_back(i * 37 % 250);  // every value twice
+    }
+    const util::sorted_vector<int> vector(input);
+    const util::sorted_list<int> list(input);
+    const util::sorted<std::list<int>> std_list(input);
+    const util::sorted<std::forward_list<int>> std_forward_list(input);
+    const util::sorted_btree<int> btree(input);
+
+    for (int value = -1; value <= 250; ++value) {
+        const auto expected = static_cast<std::size_t>(std::max(value, 0) * 2);
+        ASSERT_EQ(vector.rank(value), expected);
+        ASSERT_EQ(list.rank(value), expected);
+        ASSERT_EQ(std_list.rank(value), expected);
+        ASSERT_EQ(std_forward_list.rank(value), expected);
+        ASSERT_EQ(btree.rank(value), expected);
+        ASSERT_EQ(list.count_range(value, value + 10), vector.count_range(value, value + 10));
+    }
+    for (std::size_t pos = 0; pos < input.size(); ++pos) {
+        ASSERT_EQ(list.select(pos), vector.select(pos));
+        ASSERT_EQ(std_list.select(pos), vector.select(pos));
+        ASSERT_EQ(btree.select(pos), vector.select(pos));
+    }
+}
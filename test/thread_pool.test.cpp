@@ -0,0 +1,57 @@
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test.hpp"
+#include "util/thread_pool.hpp"
+
+TEST(UtilThreadPool, Submit) {
+    //! [thread_pool]
+    util::thread_pool pool(4);
+    auto answer = pool.submit([] { return 42; });
+    assert(answer.get() == 42);
+    //! [thread_pool]
+
+    assert(pool.size() == 4);
+}
+
+TEST(UtilThreadPool, SubmitMany) {
+    util::thread_pool pool(3);
+    std::atomic<int> sum{0};
+    std::vector<std::future<void>> tasks;
+    for (int i = 1; i <= 1000; ++i) {
+        tasks.push_back(pool.submit([&sum, i] { sum += i; }));
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+    assert(sum == 500500);
+}
+
+TEST(UtilThreadPool, Exception) {
+    util::thread_pool pool(1);
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+
+    // the worker survives the exception
+    assert(pool.submit([] { return 1; }).get() == 1);
+}
+
+TEST(UtilThreadPool, DestructorRunsQueuedTasks) {
+    std::atomic<int> count{0};
+    {
+        util::thread_pool pool(1);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&count] { ++count; });
+        }
+    }
+    assert(count == 100);
+}
+
+TEST(UtilThreadPool, ZeroThreads) {
+    util::thread_pool pool(0);
+    assert(pool.size() == 1);
+    assert(pool.submit([] { return 2; }).get() == 2);
+}